@@ -1,20 +1,41 @@
 #ifndef CT_EXTENSIONS_DATA_TABLE_HPP
 #define CT_EXTENSIONS_DATA_TABLE_HPP
+#include "datatable/Aggregate.hpp"
+#include "datatable/BitDataTableStorage.hpp"
+#include "datatable/ChunkedDataTableStorage.hpp"
 #include "datatable/DataTableArrayIterator.hpp"
 #include "datatable/DataTableBase.hpp"
 #include "datatable/DataTableStorage.hpp"
+#include "datatable/Filter.hpp"
+#include "datatable/IvfIndex.hpp"
+#include "datatable/Join.hpp"
+#include "datatable/NullableDataTableStorage.hpp"
+#include "datatable/PackedDataTableStorage.hpp"
+#include "datatable/QuantizedDataTableStorage.hpp"
+#include "datatable/RaggedDataTableStorage.hpp"
+#include "datatable/SecondaryIndex.hpp"
+#include "datatable/Similarity.hpp"
+#include "datatable/Sort.hpp"
+#include "datatable/StringDataTableStorage.hpp"
+#include "datatable/XorDataTableStorage.hpp"
 
 #include <ct/reflect.hpp>
 #include <ct/reflect_traits.hpp>
 #include <ct/type_traits.hpp>
 #include <ct/types/TArrayView.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace ct {
 namespace ext {
+template <class TABLE, class U, class K> class GroupBy;
+
 template <class U,
           template <class...> class STORAGE_POLICY = DefaultStoragePolicy>
 struct DataTable : DataTableBase<U, STORAGE_POLICY,
@@ -29,17 +50,68 @@ struct DataTable : DataTableBase<U, STORAGE_POLICY,
   using Super = DataTableBase<U, STORAGE_POLICY,
                               typename ct::GlobMemberObjects<U>::types>;
   using Storage = typename Super::Storage;
+  template <class T>
+  using StorageType = typename Storage::template StorageType<T>;
 
   DataTable() = default;
-  template <class A> DataTable(const std::vector<U, A> &vec) {
-    reserve(vec.size());
-    for (const auto &val : vec) {
-      push_back(val);
-    }
-  }
+  template <class A> DataTable(const std::vector<U, A> &vec) { append(vec); }
 
   void push_back(const U &data);
 
+  // Bulk insert, each column is grown once and then filled from the array of
+  // structs in a single pass
+  void append(const U *rows, const size_t n);
+
+  template <class A> void append(const std::vector<U, A> &rows);
+
+  // Bulk export of rows [start, start + n) into an array of structs, the
+  // inverse of append. Array members are set to views into the table.
+  void copyTo(U *rows, const size_t n, const size_t start = 0);
+
+  template <class A> void copyTo(std::vector<U, A> &rows);
+
+  // Copies rows idx[0], ..., idx[n - 1] into out one column at a time, copyTo
+  // for an index list such as a selection, topN or join result
+  void gather(const uint32_t *idx, const size_t n, U *out);
+
+  // New table holding rows idx[0], ..., idx[n - 1], built column by column
+  DataTable gather(const uint32_t *idx, const size_t n);
+
+  DataTable gather(const std::vector<uint32_t> &rows);
+
+  // Assigns rows[i] to row idx[i] one column at a time, every column must
+  // support assign, append only columns such as XorCompressed do not
+  void scatter(const uint32_t *idx, const size_t n, const U *rows);
+
+  void assign(size_t idx, const U &row);
+
+  // Removes row idx from every column, the later rows move down by one
+  void erase(size_t idx);
+
+  // Removes row idx in O(1) per column by moving the last row into its place,
+  // the order of the rows is not kept. Ragged and string columns move the
+  // later values when the lengths differ, append only columns such as
+  // XorCompressed are not supported.
+  void swapRemove(size_t idx);
+
+  // Marks row idx as deleted without moving any data, row ids stay stable
+  // until compact(). Filters, aggregates, groupBy, join, topK and printTable
+  // skip tombstoned rows, row access and copyTo still see them. permute and
+  // sortBy move the tombstones with their rows.
+  void tombstone(size_t idx);
+
+  bool isTombstone(size_t idx) const override;
+
+  size_t numTombstones() const;
+
+  // Bitmap of the rows without a tombstone, usable as a RowSelection
+  BitVector liveRows() const;
+
+  // Drops the tombstoned rows in one pass over each column, the remaining
+  // rows move down in order. Not synchronized: it may run on a background
+  // thread while no other thread uses the table.
+  void compact();
+
   template <class T> T &access(T U::*mem_ptr, const size_t idx);
 
   template <class T> const T &access(T U::*mem_ptr, const size_t idx) const;
@@ -50,6 +122,49 @@ struct DataTable : DataTableBase<U, STORAGE_POLICY,
   template <class T>
   TArrayView<const T> access(TArrayView<T> U::*mem_ptr, const size_t idx) const;
 
+  template <class T>
+  TArrayView<T> access(RaggedView<T> U::*mem_ptr, const size_t idx);
+
+  template <class T>
+  TArrayView<const T> access(RaggedView<T> U::*mem_ptr, const size_t idx) const;
+
+  // Null rows are returned as an empty Nullable, use storage(mem_ptr).assign to
+  // modify a row
+  template <class T>
+  Nullable<T> access(Nullable<T> U::*mem_ptr, const size_t idx);
+
+  template <class T>
+  Nullable<T> access(Nullable<T> U::*mem_ptr, const size_t idx) const;
+
+  // Decodes a single row, use storage(mem_ptr).assign to modify a row
+  template <class T> T access(Packed<T> U::*mem_ptr, const size_t idx);
+
+  template <class T> T access(Packed<T> U::*mem_ptr, const size_t idx) const;
+
+  // Sealed rows are decoded from the start of their segment, prefer
+  // storage(mem_ptr).decode or its iterators for scans
+  template <class T> T access(XorCompressed<T> U::*mem_ptr, const size_t idx);
+
+  template <class T>
+  T access(XorCompressed<T> U::*mem_ptr, const size_t idx) const;
+
+  // Rows are returned as a decoding view, use storage(mem_ptr).assign to
+  // modify a row
+  template <class Q>
+  QuantizedRow<Q> access(Quantized<Q> U::*mem_ptr, const size_t idx);
+
+  template <class Q>
+  QuantizedRow<Q> access(Quantized<Q> U::*mem_ptr, const size_t idx) const;
+
+  // Bool columns are bit packed, rows are returned as a proxy reference
+  BitReference access(bool U::*mem_ptr, const size_t idx);
+
+  bool access(bool U::*mem_ptr, const size_t idx) const;
+
+  // Only contiguous up to the end of the first chunk for paged storage
+  // policies, use forEachChunk to visit a whole column. Columns whose storage
+  // packs or encodes the values, e.g. bool, Packed or XorCompressed members,
+  // have no pointer range and are read through storage(mem_ptr).
   template <class T> T *begin(T U::*mem_ptr);
 
   template <class T> const T *begin(T U::*mem_ptr) const;
@@ -58,6 +173,180 @@ struct DataTable : DataTableBase<U, STORAGE_POLICY,
 
   template <class T> const T *end(T U::*mem_ptr) const;
 
+  template <class T> ElementView<T> view(T U::*mem_ptr);
+
+  template <class T> ElementView<const T> view(T U::*mem_ptr) const;
+
+  // Calls fn(chunk, first_row) for every contiguous block of the column, chunk
+  // is a tensor of the rows in the block. The default storage is one block.
+  template <class T, class F> void forEachChunk(T U::*mem_ptr, F &&fn);
+
+  template <class T, class F> void forEachChunk(T U::*mem_ptr, F &&fn) const;
+
+  // Calls fn(member_name, field_offset, storage) for every column in
+  // declaration order
+  template <class F> void forEachColumn(F &&fn);
+
+  template <class F> void forEachColumn(F &&fn) const;
+
+  // The k rows of an embedding column most similar to query, best first.
+  // query holds one float per element of a row.
+  template <class T>
+  std::vector<SearchResult> topK(T U::*mem_ptr, const float *query, size_t k,
+                                 Metric metric = Metric::Dot,
+                                 size_t num_threads = 1) const;
+
+  // Bitmap of the rows of a scalar column where value op rhs, use
+  // toSelection for the row indices
+  template <class T>
+  BitVector where(T U::*mem_ptr, CompareOp op,
+                  const typename StorageType<T>::T &rhs) const;
+
+  // Rows where lo <= value <= hi
+  template <class T>
+  BitVector whereBetween(T U::*mem_ptr, const typename StorageType<T>::T &lo,
+                         const typename StorageType<T>::T &hi) const;
+
+  // Rows whose value is one of values
+  template <class T>
+  BitVector whereIn(T U::*mem_ptr,
+                    std::vector<typename StorageType<T>::T> values) const;
+
+  // Aggregates over the rows of a scalar column, restricted to a bitmap or
+  // selection vector if given. num_threads > 1 splits the rows into contiguous
+  // ranges. Floating point sums are pairwise and compensated.
+  template <class T>
+  SumType<typename StorageType<T>::T>
+  sum(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+      size_t num_threads = 1) const;
+
+  template <class T>
+  double mean(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+              size_t num_threads = 1) const;
+
+  // Population variance
+  template <class T>
+  double variance(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+                  size_t num_threads = 1) const;
+
+  // NaNs are ignored
+  template <class T>
+  typename StorageType<T>::T min(T U::*mem_ptr,
+                                 const RowSelection &rows = RowSelection(),
+                                 size_t num_threads = 1) const;
+
+  template <class T>
+  typename StorageType<T>::T max(T U::*mem_ptr,
+                                 const RowSelection &rows = RowSelection(),
+                                 size_t num_threads = 1) const;
+
+  // First row holding the minimum, size() if no row is selected
+  template <class T>
+  size_t argmin(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+                size_t num_threads = 1) const;
+
+  template <class T>
+  size_t argmax(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+                size_t num_threads = 1) const;
+
+  // Rows of the n largest values of a scalar column, largest first, or of the
+  // n smallest with SortOrder::Ascending. Only the key column is read, see
+  // ext::topN.
+  template <class T>
+  std::vector<uint32_t> topN(T U::*mem_ptr, size_t n,
+                             SortOrder order = SortOrder::Descending,
+                             const RowSelection &rows = RowSelection(),
+                             size_t num_threads = 1) const;
+
+  // Element wise reductions of an array column, e.g. the mean embedding
+  template <class T>
+  std::vector<double> sumPerDimension(T U::*mem_ptr,
+                                      const RowSelection &rows = RowSelection(),
+                                      size_t num_threads = 1) const;
+
+  template <class T>
+  std::vector<double>
+  meanPerDimension(T U::*mem_ptr, const RowSelection &rows = RowSelection(),
+                   size_t num_threads = 1) const;
+
+  // Groups the rows by a scalar key column, see GroupBy::aggregate
+  template <class K>
+  GroupBy<DataTable, U, K> groupBy(K U::*mem_ptr,
+                                   size_t num_threads = 1) const;
+
+  // Hash join of the rows whose key equals right_key in right, right is the
+  // build side. Returns the matching row pairs, see hashJoin.
+  template <class K, class B, template <class...> class P>
+  JoinResult join(K U::*key, const DataTable<B, P> &right, K B::*right_key,
+                  JoinType type = JoinType::Inner,
+                  size_t num_threads = 1) const;
+
+  // Materialized join with one row combine(left_row, right_row) per matching
+  // pair, right_row points to the right row or is nullptr for a left row
+  // without a match.
+  template <class R, class K, class B, template <class...> class P, class F>
+  DataTable<R> join(K U::*key, DataTable<B, P> &right, K B::*right_key,
+                    F &&combine, JoinType type = JoinType::Inner,
+                    size_t num_threads = 1);
+
+  // Row order that sorts the table ascending by keys, the first key first and
+  // ties broken by the following keys. The sort is stable, integer and
+  // floating point keys are radix sorted and NaNs sort last, other keys are
+  // merge sorted with operator<. Row i of the sorted table is row order[i].
+  template <class... T> std::vector<uint32_t> sortOrder(T U::*... keys);
+
+  template <class... T>
+  std::vector<uint32_t> sortOrder(size_t num_threads, T U::*... keys);
+
+  // Reorders the rows of every column, row i becomes row order[i]
+  void permute(const std::vector<uint32_t> &order);
+
+  // Sorts the rows in place, see sortOrder
+  template <class... T> void sortBy(T U::*... keys);
+
+  template <class... T> void sortBy(size_t num_threads, T U::*... keys);
+
+  // Declares an equality index on a scalar column, find(mem_ptr, key) is then
+  // one hash lookup. Declared indexes are kept current by push_back, append,
+  // assign, scatter, erase, swapRemove, compact and permute; keys written
+  // through access or storage(mem_ptr) are not seen, call reindex() after
+  // them. Tables without declared indexes pay nothing.
+  template <class T> void createHashIndex(T U::*mem_ptr);
+
+  // Declares a range index on a scalar column for range(mem_ptr, lo, hi)
+  template <class T> void createSortedIndex(T U::*mem_ptr);
+
+  // Declares an IvfIndex on an embedding column, trained on the rows present
+  // now or on the first rows appended to an empty table. Mutations keep it
+  // current, reindex, compact and permute retrain it.
+  template <class T>
+  void createIvfIndex(T U::*mem_ptr, size_t num_lists = 64,
+                      Metric metric = Metric::L2);
+
+  // Drops the indexes declared on a column
+  template <class T> void dropIndex(T U::*mem_ptr);
+
+  // Rebuilds every declared index from its column
+  void reindex();
+
+  // Rows holding key in ascending order, through a hash or sorted index
+  // declared on the column. Throws std::runtime_error without one.
+  template <class T>
+  SelectionVector find(T U::*mem_ptr,
+                       const typename StorageType<T>::T &key) const;
+
+  // The k best rows through the IvfIndex declared on the column, see
+  // IvfIndex::search. Throws std::runtime_error without one.
+  template <class T>
+  std::vector<SearchResult> search(T U::*mem_ptr, const float *query,
+                                   size_t k, size_t nprobe = 8) const;
+
+  // Rows with lo <= key <= hi in ascending order, through a sorted index
+  // declared on the column. Throws std::runtime_error without one.
+  template <class T>
+  SelectionVector range(T U::*mem_ptr, const typename StorageType<T>::T &lo,
+                        const typename StorageType<T>::T &hi) const;
+
   U access(const size_t idx);
 
   void reserve(const size_t size);
@@ -72,11 +361,37 @@ struct DataTable : DataTableBase<U, STORAGE_POLICY,
   // :/
   U operator[](size_t idx);
 
-  template <class T> const DataTableStorage<T> &storage(T U::*mem_ptr) const;
+  template <class T> const StorageType<T> &storage(T U::*mem_ptr) const;
 
-  template <class T> DataTableStorage<T> &storage(T U::*mem_ptr);
+  template <class T> StorageType<T> &storage(T U::*mem_ptr);
 
   size_t size() const override;
+
+private:
+  template <class T> static void assertDenseRows() {
+    static_assert(HasDenseRows<StorageType<T>>::value,
+                  "begin, end and view need a column stored as an array of "
+                  "the member type, read packed or encoded columns through "
+                  "storage(mem_ptr)");
+  }
+
+  // rows without the tombstoned rows, scratch backs the returned selection
+  RowSelection liveSelection(const RowSelection &rows,
+                             BitVector &scratch) const;
+
+  BitVector liveOnly(BitVector bits) const;
+
+  SelectionVector liveOnly(SelectionVector rows) const;
+
+  // Drops the tombstoned rows of results and keeps the best k, results hold
+  // up to k + numTombstones() rows
+  std::vector<SearchResult> liveOnly(std::vector<SearchResult> results,
+                                     size_t k) const;
+
+  // Tombstone bit of each row, rows past its size have none
+  BitVector m_tombstones;
+  size_t m_num_tombstones = 0;
+  detail::TableIndexes<DataTable> m_indexes;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -86,6 +401,218 @@ struct DataTable : DataTableBase<U, STORAGE_POLICY,
 template <class U, template <class...> class STORAGE_POLICY>
 void DataTable<U, STORAGE_POLICY>::push_back(const U &data) {
   this->push(data, ct::Reflect<U>::end());
+  m_indexes.sync(*this);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::append(const U *rows, const size_t n) {
+  if (n == 0) {
+    return;
+  }
+  this->appendImpl(rows, n, ct::Reflect<U>::end());
+  m_indexes.sync(*this);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class A>
+void DataTable<U, STORAGE_POLICY>::append(const std::vector<U, A> &rows) {
+  append(rows.data(), rows.size());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::copyTo(U *rows, const size_t n,
+                                          const size_t start) {
+  assert(start + n <= size());
+  if (n == 0) {
+    return;
+  }
+  this->copyToImpl(rows, n, start, ct::Reflect<U>::end());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class A>
+void DataTable<U, STORAGE_POLICY>::copyTo(std::vector<U, A> &rows) {
+  rows.resize(size());
+  copyTo(rows.data(), rows.size());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::gather(const uint32_t *idx, const size_t n,
+                                          U *out) {
+  if (n == 0) {
+    return;
+  }
+  this->gatherImpl(idx, n, out, ct::Reflect<U>::end());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+DataTable<U, STORAGE_POLICY>
+DataTable<U, STORAGE_POLICY>::gather(const uint32_t *idx, const size_t n) {
+  DataTable out;
+  if (n != 0) {
+    out.appendRowsImpl(*this, idx, n, ct::Reflect<U>::end());
+  }
+  return out;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+DataTable<U, STORAGE_POLICY>
+DataTable<U, STORAGE_POLICY>::gather(const std::vector<uint32_t> &rows) {
+  return gather(rows.data(), rows.size());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::scatter(const uint32_t *idx, const size_t n,
+                                           const U *rows) {
+  static_assert(!Super::has_append_only_column,
+                "scatter and assign overwrite rows in place, which append "
+                "only columns such as XorCompressed do not support");
+  if (n == 0) {
+    return;
+  }
+  this->scatterImpl(idx, n, rows, ct::Reflect<U>::end());
+  for (size_t i = 0; i < n; ++i) {
+    m_indexes.update(*this, idx[i]);
+  }
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::assign(size_t idx, const U &row) {
+  const uint32_t row_idx = static_cast<uint32_t>(idx);
+  scatter(&row_idx, 1, &row);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::erase(size_t idx) {
+  assert(idx < size());
+  if (isTombstone(idx)) {
+    --m_num_tombstones;
+  }
+  if (idx < m_tombstones.size()) {
+    m_tombstones.erase(idx);
+  }
+  this->eraseImpl(static_cast<uint32_t>(idx), ct::Reflect<U>::end());
+  m_indexes.erase(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::swapRemove(size_t idx) {
+  static_assert(!Super::has_append_only_column,
+                "swapRemove moves the last row into place, which append only "
+                "columns such as XorCompressed do not support");
+  assert(idx < size());
+  const size_t last = size() - 1;
+  if (m_num_tombstones != 0) {
+    // The last row's tombstone moves with it, the removed row's goes away
+    const bool last_dead = isTombstone(last);
+    if (isTombstone(idx)) {
+      m_tombstones.set(idx, false);
+      --m_num_tombstones;
+    }
+    if (last_dead && idx != last) {
+      m_tombstones.set(idx, true);
+    }
+    m_tombstones.resize(std::min(m_tombstones.size(), last));
+  }
+  this->swapRemoveImpl(static_cast<uint32_t>(idx), ct::Reflect<U>::end());
+  m_indexes.swapRemove(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::tombstone(size_t idx) {
+  assert(idx < size());
+  if (m_tombstones.size() <= idx) {
+    m_tombstones.resize(size());
+  }
+  if (!m_tombstones.test(idx)) {
+    m_tombstones.set(idx, true);
+    ++m_num_tombstones;
+  }
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+bool DataTable<U, STORAGE_POLICY>::isTombstone(size_t idx) const {
+  return idx < m_tombstones.size() && m_tombstones.test(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+size_t DataTable<U, STORAGE_POLICY>::numTombstones() const {
+  return m_num_tombstones;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+BitVector DataTable<U, STORAGE_POLICY>::liveRows() const {
+  BitVector live(size(), true);
+  if (m_num_tombstones != 0) {
+    BitVector dead = m_tombstones;
+    dead.resize(size());
+    live.andNot(dead);
+  }
+  return live;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::compact() {
+  if (m_num_tombstones == 0) {
+    return;
+  }
+  const SelectionVector keep = toSelection(liveRows());
+  this->keepRowsImpl(keep.data(), keep.size(), ct::Reflect<U>::end());
+  m_tombstones.clear();
+  m_num_tombstones = 0;
+  m_indexes.rebuild(*this);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+RowSelection
+DataTable<U, STORAGE_POLICY>::liveSelection(const RowSelection &rows,
+                                            BitVector &scratch) const {
+  if (m_num_tombstones == 0) {
+    return rows;
+  }
+  scratch = liveRows();
+  if (!rows.all()) {
+    BitVector selected(size());
+    rows.forEachRun(size(), 0, rows.numUnits(size()),
+                    [&selected](size_t begin, size_t end) {
+                      for (size_t row = begin; row < end; ++row) {
+                        selected.set(row, true);
+                      }
+                    });
+    scratch &= selected;
+  }
+  return RowSelection(scratch);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+SelectionVector
+DataTable<U, STORAGE_POLICY>::liveOnly(SelectionVector rows) const {
+  if (m_num_tombstones != 0) {
+    const auto dead = [this](uint32_t row) { return isTombstone(row); };
+    rows.erase(std::remove_if(rows.begin(), rows.end(), dead), rows.end());
+  }
+  return rows;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+std::vector<SearchResult>
+DataTable<U, STORAGE_POLICY>::liveOnly(std::vector<SearchResult> results,
+                                       size_t k) const {
+  const auto dead = [this](const SearchResult &result) {
+    return isTombstone(result.row);
+  };
+  results.erase(std::remove_if(results.begin(), results.end(), dead),
+                results.end());
+  results.resize(std::min(results.size(), k));
+  return results;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+BitVector DataTable<U, STORAGE_POLICY>::liveOnly(BitVector bits) const {
+  if (m_num_tombstones != 0) {
+    bits &= liveRows();
+  }
+  return bits;
 }
 
 template <class U, template <class...> class STORAGE_POLICY>
@@ -122,9 +649,95 @@ DataTable<U, STORAGE_POLICY>::access(TArrayView<T> U::*mem_ptr,
   return TArrayView<const T>(ptrCast<const T>(tensor.data()), num_elements);
 }
 
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+TArrayView<T> DataTable<U, STORAGE_POLICY>::access(RaggedView<T> U::*mem_ptr,
+                                                   const size_t idx) {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+TArrayView<const T>
+DataTable<U, STORAGE_POLICY>::access(RaggedView<T> U::*mem_ptr,
+                                     const size_t idx) const {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+Nullable<T> DataTable<U, STORAGE_POLICY>::access(Nullable<T> U::*mem_ptr,
+                                                 const size_t idx) {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+Nullable<T> DataTable<U, STORAGE_POLICY>::access(Nullable<T> U::*mem_ptr,
+                                                 const size_t idx) const {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+T DataTable<U, STORAGE_POLICY>::access(Packed<T> U::*mem_ptr,
+                                       const size_t idx) {
+  return storage(mem_ptr).get(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+T DataTable<U, STORAGE_POLICY>::access(Packed<T> U::*mem_ptr,
+                                       const size_t idx) const {
+  return storage(mem_ptr).get(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+T DataTable<U, STORAGE_POLICY>::access(XorCompressed<T> U::*mem_ptr,
+                                       const size_t idx) {
+  return storage(mem_ptr).get(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+T DataTable<U, STORAGE_POLICY>::access(XorCompressed<T> U::*mem_ptr,
+                                       const size_t idx) const {
+  return storage(mem_ptr).get(idx);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class Q>
+QuantizedRow<Q>
+DataTable<U, STORAGE_POLICY>::access(Quantized<Q> U::*mem_ptr,
+                                     const size_t idx) {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class Q>
+QuantizedRow<Q>
+DataTable<U, STORAGE_POLICY>::access(Quantized<Q> U::*mem_ptr,
+                                     const size_t idx) const {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+BitReference DataTable<U, STORAGE_POLICY>::access(bool U::*mem_ptr,
+                                                  const size_t idx) {
+  return storage(mem_ptr)[idx];
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+bool DataTable<U, STORAGE_POLICY>::access(bool U::*mem_ptr,
+                                          const size_t idx) const {
+  return storage(mem_ptr)[idx];
+}
+
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
 T *DataTable<U, STORAGE_POLICY>::begin(T U::*mem_ptr) {
+  assertDenseRows<T>();
   auto p = this->ptr(memberOffset(mem_ptr), 0, Reflect<U>::end());
   return ptrCast<T>(p.data());
 }
@@ -132,6 +745,7 @@ T *DataTable<U, STORAGE_POLICY>::begin(T U::*mem_ptr) {
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
 const T *DataTable<U, STORAGE_POLICY>::begin(T U::*mem_ptr) const {
+  assertDenseRows<T>();
   auto p = this->ptr(memberOffset(mem_ptr), 0, Reflect<U>::end());
   return ptrCast<const T>(p.data());
 }
@@ -139,6 +753,7 @@ const T *DataTable<U, STORAGE_POLICY>::begin(T U::*mem_ptr) const {
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
 T *DataTable<U, STORAGE_POLICY>::end(T U::*mem_ptr) {
+  assertDenseRows<T>();
   auto p = this->ptr(memberOffset(mem_ptr), Storage::template get<0>().size(),
                      Reflect<U>::end());
   return static_cast<T *>(p.data());
@@ -147,11 +762,393 @@ T *DataTable<U, STORAGE_POLICY>::end(T U::*mem_ptr) {
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
 const T *DataTable<U, STORAGE_POLICY>::end(T U::*mem_ptr) const {
+  assertDenseRows<T>();
   auto p = this->ptr(memberOffset(mem_ptr), Storage::template get<0>().size(),
                      Reflect<U>::end());
   return static_cast<const T *>(p.data());
 }
 
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+ElementView<T> DataTable<U, STORAGE_POLICY>::view(T U::*mem_ptr) {
+  return {begin(mem_ptr), end(mem_ptr)};
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+ElementView<const T> DataTable<U, STORAGE_POLICY>::view(T U::*mem_ptr) const {
+  return {begin(mem_ptr), end(mem_ptr)};
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T, class F>
+void DataTable<U, STORAGE_POLICY>::forEachChunk(T U::*mem_ptr, F &&fn) {
+  storage(mem_ptr).forEachChunk(std::forward<F>(fn));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T, class F>
+void DataTable<U, STORAGE_POLICY>::forEachChunk(T U::*mem_ptr,
+                                                F &&fn) const {
+  storage(mem_ptr).forEachChunk(std::forward<F>(fn));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class F>
+void DataTable<U, STORAGE_POLICY>::forEachColumn(F &&fn) {
+  this->forEachColumnImpl(fn, Reflect<U>::end());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class F>
+void DataTable<U, STORAGE_POLICY>::forEachColumn(F &&fn) const {
+  this->forEachColumnImpl(fn, Reflect<U>::end());
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+std::vector<SearchResult>
+DataTable<U, STORAGE_POLICY>::topK(T U::*mem_ptr, const float *query, size_t k,
+                                   Metric metric, size_t num_threads) const {
+  if (m_num_tombstones == 0) {
+    return ext::topK(storage(mem_ptr), query, k, metric, num_threads);
+  }
+  return liveOnly(ext::topK(storage(mem_ptr), query, k + m_num_tombstones,
+                            metric, num_threads),
+                  k);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+BitVector DataTable<U, STORAGE_POLICY>::where(
+    T U::*mem_ptr, CompareOp op, const typename StorageType<T>::T &rhs) const {
+  return liveOnly(ext::where(storage(mem_ptr), op, rhs));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+BitVector DataTable<U, STORAGE_POLICY>::whereBetween(
+    T U::*mem_ptr, const typename StorageType<T>::T &lo,
+    const typename StorageType<T>::T &hi) const {
+  return liveOnly(ext::whereBetween(storage(mem_ptr), lo, hi));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+BitVector DataTable<U, STORAGE_POLICY>::whereIn(
+    T U::*mem_ptr, std::vector<typename StorageType<T>::T> values) const {
+  return liveOnly(ext::whereIn(storage(mem_ptr), std::move(values)));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+auto DataTable<U, STORAGE_POLICY>::sum(T U::*mem_ptr,
+                                       const RowSelection &rows,
+                                       size_t num_threads) const
+    -> SumType<typename StorageType<T>::T> {
+  BitVector scratch;
+  return ext::sum(storage(mem_ptr), liveSelection(rows, scratch),
+                  num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+double DataTable<U, STORAGE_POLICY>::mean(T U::*mem_ptr,
+                                          const RowSelection &rows,
+                                          size_t num_threads) const {
+  BitVector scratch;
+  return ext::mean(storage(mem_ptr), liveSelection(rows, scratch),
+                   num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+double DataTable<U, STORAGE_POLICY>::variance(T U::*mem_ptr,
+                                              const RowSelection &rows,
+                                              size_t num_threads) const {
+  BitVector scratch;
+  return ext::variance(storage(mem_ptr), liveSelection(rows, scratch),
+                       num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+auto DataTable<U, STORAGE_POLICY>::min(T U::*mem_ptr,
+                                       const RowSelection &rows,
+                                       size_t num_threads) const
+    -> typename StorageType<T>::T {
+  BitVector scratch;
+  return ext::minimum(storage(mem_ptr), liveSelection(rows, scratch),
+                      num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+auto DataTable<U, STORAGE_POLICY>::max(T U::*mem_ptr,
+                                       const RowSelection &rows,
+                                       size_t num_threads) const
+    -> typename StorageType<T>::T {
+  BitVector scratch;
+  return ext::maximum(storage(mem_ptr), liveSelection(rows, scratch),
+                      num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+size_t DataTable<U, STORAGE_POLICY>::argmin(T U::*mem_ptr,
+                                            const RowSelection &rows,
+                                            size_t num_threads) const {
+  BitVector scratch;
+  return ext::argmin(storage(mem_ptr), liveSelection(rows, scratch),
+                     num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+size_t DataTable<U, STORAGE_POLICY>::argmax(T U::*mem_ptr,
+                                            const RowSelection &rows,
+                                            size_t num_threads) const {
+  BitVector scratch;
+  return ext::argmax(storage(mem_ptr), liveSelection(rows, scratch),
+                     num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+std::vector<uint32_t>
+DataTable<U, STORAGE_POLICY>::topN(T U::*mem_ptr, size_t n, SortOrder order,
+                                   const RowSelection &rows,
+                                   size_t num_threads) const {
+  BitVector scratch;
+  return ext::topN(storage(mem_ptr), n, order, liveSelection(rows, scratch),
+                   num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+std::vector<double>
+DataTable<U, STORAGE_POLICY>::sumPerDimension(T U::*mem_ptr,
+                                              const RowSelection &rows,
+                                              size_t num_threads) const {
+  BitVector scratch;
+  return ext::sumPerDimension(storage(mem_ptr), liveSelection(rows, scratch),
+                              num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+std::vector<double>
+DataTable<U, STORAGE_POLICY>::meanPerDimension(T U::*mem_ptr,
+                                               const RowSelection &rows,
+                                               size_t num_threads) const {
+  BitVector scratch;
+  return ext::meanPerDimension(storage(mem_ptr), liveSelection(rows, scratch),
+                               num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class K>
+GroupBy<DataTable<U, STORAGE_POLICY>, U, K>
+DataTable<U, STORAGE_POLICY>::groupBy(K U::*mem_ptr,
+                                      size_t num_threads) const {
+  return GroupBy<DataTable, U, K>(*this, mem_ptr, num_threads);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class K, class B, template <class...> class P>
+JoinResult DataTable<U, STORAGE_POLICY>::join(K U::*key,
+                                              const DataTable<B, P> &right,
+                                              K B::*right_key, JoinType type,
+                                              size_t num_threads) const {
+  JoinResult pairs =
+      hashJoin(storage(key), right.storage(right_key), type, num_threads);
+  if (m_num_tombstones == 0 && right.numTombstones() == 0) {
+    return pairs;
+  }
+  // The pairs of a left row are next to each other. A live left row whose
+  // matches are all tombstoned is unmatched in a left join.
+  JoinResult live;
+  size_t begin = 0;
+  while (begin < pairs.size()) {
+    const uint32_t left = pairs.left[begin];
+    size_t end = begin;
+    while (end < pairs.size() && pairs.left[end] == left) {
+      ++end;
+    }
+    if (!isTombstone(left)) {
+      const size_t num_live = live.size();
+      for (size_t i = begin; i < end; ++i) {
+        const uint32_t row = pairs.right[i];
+        if (row != JoinResult::NO_MATCH && !right.isTombstone(row)) {
+          live.left.push_back(left);
+          live.right.push_back(row);
+        }
+      }
+      if (type == JoinType::Left && live.size() == num_live) {
+        live.left.push_back(left);
+        live.right.push_back(JoinResult::NO_MATCH);
+      }
+    }
+    begin = end;
+  }
+  return live;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class R, class K, class B, template <class...> class P, class F>
+DataTable<R> DataTable<U, STORAGE_POLICY>::join(K U::*key,
+                                                DataTable<B, P> &right,
+                                                K B::*right_key, F &&combine,
+                                                JoinType type,
+                                                size_t num_threads) {
+  const JoinResult pairs = join(key, right, right_key, type, num_threads);
+  std::vector<U> left_rows(pairs.size());
+  gather(pairs.left.data(), pairs.size(), left_rows.data());
+  // Right rows are gathered for the matched pairs only
+  std::vector<uint32_t> matched;
+  matched.reserve(pairs.size());
+  for (uint32_t row : pairs.right) {
+    if (row != JoinResult::NO_MATCH) {
+      matched.push_back(row);
+    }
+  }
+  std::vector<B> right_rows(matched.size());
+  right.gather(matched.data(), matched.size(), right_rows.data());
+  std::vector<R> rows;
+  rows.reserve(pairs.size());
+  size_t next_match = 0;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    const B *right_row = pairs.right[i] == JoinResult::NO_MATCH
+                             ? nullptr
+                             : &right_rows[next_match++];
+    rows.push_back(combine(left_rows[i], right_row));
+  }
+  return DataTable<R>(rows);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class... T>
+std::vector<uint32_t> DataTable<U, STORAGE_POLICY>::sortOrder(T U::*... keys) {
+  return sortOrder(1, keys...);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class... T>
+std::vector<uint32_t>
+DataTable<U, STORAGE_POLICY>::sortOrder(size_t num_threads, T U::*... keys) {
+  static_assert(sizeof...(T) > 0, "Sort by at least one column");
+  std::vector<uint32_t> order(size());
+  std::iota(order.begin(), order.end(), 0);
+  detail::sortOrder(*this, order, std::max<size_t>(1, num_threads), keys...);
+  return order;
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::permute(const std::vector<uint32_t> &order) {
+  assert(order.size() == size());
+  const auto start_idx = ct::Reflect<U>::end();
+  this->permuteImpl(order, start_idx);
+  if (m_num_tombstones != 0) {
+    BitVector tombstones(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      tombstones.set(i, isTombstone(order[i]));
+    }
+    m_tombstones = std::move(tombstones);
+  }
+  m_indexes.rebuild(*this);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class... T>
+void DataTable<U, STORAGE_POLICY>::sortBy(T U::*... keys) {
+  sortBy(1, keys...);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class... T>
+void DataTable<U, STORAGE_POLICY>::sortBy(size_t num_threads, T U::*... keys) {
+  permute(sortOrder(num_threads, keys...));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+void DataTable<U, STORAGE_POLICY>::createHashIndex(T U::*mem_ptr) {
+  static_assert(StorageType<T>::data_dim == 0, "Index a scalar column");
+  m_indexes.template add<HashIndex<typename StorageType<T>::T>>(*this,
+                                                                mem_ptr);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+void DataTable<U, STORAGE_POLICY>::createSortedIndex(T U::*mem_ptr) {
+  static_assert(StorageType<T>::data_dim == 0, "Index a scalar column");
+  m_indexes.template add<SortedIndex<typename StorageType<T>::T>>(*this,
+                                                                  mem_ptr);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+void DataTable<U, STORAGE_POLICY>::createIvfIndex(T U::*mem_ptr,
+                                                  size_t num_lists,
+                                                  Metric metric) {
+  static_assert(StorageType<T>::data_dim == 1, "Index an embedding column");
+  m_indexes.template add<IvfIndex>(*this, mem_ptr, IvfIndex(num_lists, metric));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+void DataTable<U, STORAGE_POLICY>::dropIndex(T U::*mem_ptr) {
+  m_indexes.remove(memberOffset(mem_ptr));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+void DataTable<U, STORAGE_POLICY>::reindex() {
+  m_indexes.rebuild(*this);
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+SelectionVector DataTable<U, STORAGE_POLICY>::find(
+    T U::*mem_ptr, const typename StorageType<T>::T &key) const {
+  using K = typename StorageType<T>::T;
+  if (const HashIndex<K> *index =
+          m_indexes.template get<HashIndex<K>>(mem_ptr)) {
+    return liveOnly(index->find(key));
+  }
+  if (const SortedIndex<K> *index =
+          m_indexes.template get<SortedIndex<K>>(mem_ptr)) {
+    return liveOnly(index->find(key));
+  }
+  throw std::runtime_error("find needs an index declared on the column");
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+SelectionVector DataTable<U, STORAGE_POLICY>::range(
+    T U::*mem_ptr, const typename StorageType<T>::T &lo,
+    const typename StorageType<T>::T &hi) const {
+  using K = typename StorageType<T>::T;
+  const SortedIndex<K> *index = m_indexes.template get<SortedIndex<K>>(mem_ptr);
+  if (index == nullptr) {
+    throw std::runtime_error(
+        "range needs a sorted index declared on the column");
+  }
+  return liveOnly(index->range(lo, hi));
+}
+
+template <class U, template <class...> class STORAGE_POLICY>
+template <class T>
+std::vector<SearchResult>
+DataTable<U, STORAGE_POLICY>::search(T U::*mem_ptr, const float *query,
+                                     size_t k, size_t nprobe) const {
+  const IvfIndex *index = m_indexes.template get<IvfIndex>(mem_ptr);
+  if (index == nullptr) {
+    throw std::runtime_error(
+        "search needs an ivf index declared on the column");
+  }
+  return liveOnly(index->search(query, k + m_num_tombstones, nprobe), k);
+}
+
 template <class U, template <class...> class STORAGE_POLICY>
 U DataTable<U, STORAGE_POLICY>::access(const size_t idx) {
   U out;
@@ -181,22 +1178,23 @@ U DataTable<U, STORAGE_POLICY>::operator[](size_t idx) {
 
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
-const DataTableStorage<T> &
-DataTable<U, STORAGE_POLICY>::storage(T U::*mem_ptr) const {
-  const void *out = this->template storageImpl<DataTableStorage<T>>(
+auto DataTable<U, STORAGE_POLICY>::storage(T U::*mem_ptr) const
+    -> const StorageType<T> & {
+  const void *out = this->template storageImpl<StorageType<T>>(
       memberOffset(mem_ptr), Reflect<U>::end());
   assert(out != nullptr);
-  return *static_cast<const DataTableStorage<T> *>(out);
+  return *static_cast<const StorageType<T> *>(out);
 }
 
 template <class U, template <class...> class STORAGE_POLICY>
 template <class T>
-DataTableStorage<T> &DataTable<U, STORAGE_POLICY>::storage(T U::*mem_ptr) {
+auto DataTable<U, STORAGE_POLICY>::storage(T U::*mem_ptr)
+    -> StorageType<T> & {
   const auto offset = memberOffset(mem_ptr);
   const auto idx = Reflect<U>::end();
-  void *out = this->template storageImpl<DataTableStorage<T>>(offset, idx);
+  void *out = this->template storageImpl<StorageType<T>>(offset, idx);
   assert(out != nullptr);
-  auto typed = static_cast<DataTableStorage<T> *>(out);
+  auto typed = static_cast<StorageType<T> *>(out);
   return *typed;
 }
 
@@ -206,6 +1204,7 @@ size_t DataTable<U, STORAGE_POLICY>::size() const {
 }
 } // namespace ext
 } // namespace ct
+#include "datatable/GroupBy.hpp"
 #include "datatable/print.hpp"
 
 #endif // CT_EXTENSIONS_DATA_TABLE_HPP
@@ -0,0 +1,666 @@
+#ifndef CT_EXT_AGGREGATE_HPP
+#define CT_EXT_AGGREGATE_HPP
+#include "DataTableStorage.hpp"
+#include "Filter.hpp"
+#include "ZoneMap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        // Result type of sum(): double for floating point columns, 64 bit integers otherwise
+        template <class T>
+        using SumType = typename std::conditional<
+            std::is_floating_point<T>::value,
+            double,
+            typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type>::type;
+
+        namespace detail
+        {
+            // Contiguous rows [first, first + rows) of a column, stride values apart
+            template <class T>
+            struct ColumnBlock
+            {
+                const T* data;
+                size_t rows;
+                size_t stride;
+                size_t first;
+            };
+
+            template <class T>
+            ColumnBlock<T> columnBlock(mt::Tensor<const T, 1> chunk, size_t first, size_t& dim)
+            {
+                dim = 1;
+                return ColumnBlock<T>{chunk.data(), chunk.getShape()[0], 1, first};
+            }
+
+            template <class T>
+            ColumnBlock<T> columnBlock(mt::Tensor<const T, 2> chunk, size_t first, size_t& dim)
+            {
+                const mt::Shape<2> shape = chunk.getShape();
+                dim = shape[1];
+                return ColumnBlock<T>{chunk.data(), shape[0], shape.getStride(0), first};
+            }
+
+            template <class STORAGE>
+            std::vector<ColumnBlock<typename STORAGE::T>> columnBlocks(const STORAGE& storage, size_t& dim)
+            {
+                using T = typename STORAGE::T;
+                static_assert(STORAGE::data_dim <= 1, "Aggregates need a scalar or 1d array column");
+                std::vector<ColumnBlock<T>> blocks;
+                dim = 0;
+                storage.forEachChunk([&blocks, &dim](mt::Tensor<const T, STORAGE::storage_dim> chunk, size_t first) {
+                    blocks.push_back(columnBlock(chunk, first, dim));
+                });
+                return blocks;
+            }
+
+            // Contiguous copy of a scalar column
+            template <class STORAGE>
+            std::vector<typename STORAGE::T> columnValues(const STORAGE& storage)
+            {
+                static_assert(STORAGE::data_dim == 0, "Expected a scalar column");
+                size_t dim = 0;
+                std::vector<typename STORAGE::T> values;
+                values.reserve(storage.size());
+                for (const ColumnBlock<typename STORAGE::T>& block : columnBlocks(storage, dim))
+                {
+                    values.insert(values.end(), block.data, block.data + block.rows);
+                }
+                return values;
+            }
+
+            // Calls fn(span) for the contiguous pieces of rows [begin, end), each span lies within one block
+            template <class T, class F>
+            void forEachSpan(const std::vector<ColumnBlock<T>>& blocks, size_t begin, size_t end, F&& fn)
+            {
+                auto block = std::upper_bound(blocks.begin(),
+                                              blocks.end(),
+                                              begin,
+                                              [](size_t row, const ColumnBlock<T>& b) { return row < b.first; });
+                assert(block != blocks.begin());
+                --block;
+                while (begin < end)
+                {
+                    const size_t stop = std::min(end, block->first + block->rows);
+                    const T* data = block->data + (begin - block->first) * block->stride;
+                    fn(ColumnBlock<T>{data, stop - begin, block->stride, begin});
+                    begin = stop;
+                    ++block;
+                }
+            }
+
+            // forEachSpan over every run of selected rows within units [first, last) of the selection
+            template <class T, class F>
+            void forEachSelectedSpan(const std::vector<ColumnBlock<T>>& blocks, const RowSelection& rows,
+                                     size_t num_rows, size_t first, size_t last, F&& fn)
+            {
+                rows.forEachRun(num_rows, first, last, [&blocks, &fn](size_t begin, size_t end) {
+                    forEachSpan(blocks, begin, end, fn);
+                });
+            }
+
+            // Splits the units of rows into num_threads contiguous ranges, scan(first, last, acc) folds one range and
+            // the partial results are merged in order
+            template <class ACC, class SCAN>
+            ACC reduceRows(const RowSelection& rows, size_t num_rows, size_t num_threads, const ACC& init,
+                           const SCAN& scan)
+            {
+                const size_t num_units = rows.numUnits(num_rows);
+                num_threads = std::max<size_t>(1, std::min(num_threads, num_units));
+                std::vector<ACC> partials(num_threads, init);
+                if (num_threads == 1)
+                {
+                    scan(size_t(0), num_units, partials[0]);
+                    return partials[0];
+                }
+                std::vector<std::thread> threads;
+                threads.reserve(num_threads);
+                for (size_t t = 0; t < num_threads; ++t)
+                {
+                    const size_t first = num_units * t / num_threads;
+                    const size_t last = num_units * (t + 1) / num_threads;
+                    threads.emplace_back([&scan, &partials, first, last, t]() { scan(first, last, partials[t]); });
+                }
+                for (std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+                for (size_t t = 1; t < num_threads; ++t)
+                {
+                    partials[0].merge(partials[t]);
+                }
+                return partials[0];
+            }
+
+            // Runs fn(task) for tasks [0, num_tasks), task t on thread t % num_threads
+            template <class F>
+            void parallelFor(size_t num_tasks, size_t num_threads, const F& fn)
+            {
+                num_threads = std::max<size_t>(1, std::min(num_threads, num_tasks));
+                if (num_threads == 1)
+                {
+                    for (size_t task = 0; task < num_tasks; ++task)
+                    {
+                        fn(task);
+                    }
+                    return;
+                }
+                std::vector<std::thread> threads;
+                threads.reserve(num_threads);
+                for (size_t t = 0; t < num_threads; ++t)
+                {
+                    threads.emplace_back([&fn, t, num_tasks, num_threads]() {
+                        for (size_t task = t; task < num_tasks; task += num_threads)
+                        {
+                            fn(task);
+                        }
+                    });
+                }
+                for (std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+            }
+
+            // Neumaier's variant of Kahan summation, used to add up the pairwise sums of separate runs
+            struct CompensatedSum
+            {
+                double sum = 0.0;
+                double compensation = 0.0;
+
+                void add(double value)
+                {
+                    const double t = sum + value;
+                    if (std::abs(sum) >= std::abs(value))
+                    {
+                        compensation += (sum - t) + value;
+                    }
+                    else
+                    {
+                        compensation += (value - t) + sum;
+                    }
+                    sum = t;
+                }
+
+                void merge(const CompensatedSum& other)
+                {
+                    add(other.sum);
+                    add(other.compensation);
+                }
+
+                double value() const { return sum + compensation; }
+            };
+
+            template <class S>
+            struct IntegerSum
+            {
+                S sum = 0;
+
+                void add(S value) { sum += value; }
+
+                void merge(const IntegerSum& other) { sum += other.sum; }
+
+                S value() const { return sum; }
+            };
+
+            template <class T>
+            using SumAccumulator = typename std::
+                conditional<std::is_floating_point<T>::value, CompensatedSum, IntegerSum<SumType<T>>>::type;
+
+            // Four independent accumulators so consecutive adds do not wait on each other
+            template <class T>
+            double leafSum(const T* values, size_t n)
+            {
+                double acc[4] = {0.0, 0.0, 0.0, 0.0};
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    acc[0] += static_cast<double>(values[i]);
+                    acc[1] += static_cast<double>(values[i + 1]);
+                    acc[2] += static_cast<double>(values[i + 2]);
+                    acc[3] += static_cast<double>(values[i + 3]);
+                }
+                for (; i < n; ++i)
+                {
+                    acc[0] += static_cast<double>(values[i]);
+                }
+                return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            }
+
+#if defined(__AVX2__)
+            // Float lanes are widened to double before they are added, so a leaf adds no float rounding
+            inline double leafSum(const float* values, size_t n)
+            {
+                __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16)
+                {
+                    const __m256 lo = _mm256_loadu_ps(values + i);
+                    const __m256 hi = _mm256_loadu_ps(values + i + 8);
+                    acc[0] = _mm256_add_pd(acc[0], _mm256_cvtps_pd(_mm256_castps256_ps128(lo)));
+                    acc[1] = _mm256_add_pd(acc[1], _mm256_cvtps_pd(_mm256_extractf128_ps(lo, 1)));
+                    acc[2] = _mm256_add_pd(acc[2], _mm256_cvtps_pd(_mm256_castps256_ps128(hi)));
+                    acc[3] = _mm256_add_pd(acc[3], _mm256_cvtps_pd(_mm256_extractf128_ps(hi, 1)));
+                }
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3])));
+                return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + leafSum<float>(values + i, n - i);
+            }
+
+            inline double leafSum(const double* values, size_t n)
+            {
+                __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                    {
+                        acc[j] = _mm256_add_pd(acc[j], _mm256_loadu_pd(values + i + j * 4));
+                    }
+                }
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3])));
+                return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + leafSum<double>(values + i, n - i);
+            }
+#endif // __AVX2__
+
+            // Pairwise summation, the rounding error grows with log(n) instead of n
+            template <class T>
+            double pairwiseSum(const T* values, size_t n)
+            {
+                if (n <= 256)
+                {
+                    return leafSum(values, n);
+                }
+                const size_t half = (n / 2 + 31) & ~size_t(31);
+                return pairwiseSum(values, half) + pairwiseSum(values + half, n - half);
+            }
+
+            template <class T>
+            void addSpan(CompensatedSum& acc, const T* values, size_t n)
+            {
+                acc.add(pairwiseSum(values, n));
+            }
+
+            template <class S, class T>
+            void addSpan(IntegerSum<S>& acc, const T* values, size_t n)
+            {
+                S sum = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    sum += static_cast<S>(values[i]);
+                }
+                acc.add(sum);
+            }
+
+            template <class T>
+            double squaredDeviationSum(const T* values, size_t n, double mean)
+            {
+                if (n > 256)
+                {
+                    const size_t half = n / 2;
+                    return squaredDeviationSum(values, half, mean) + squaredDeviationSum(values + half, n - half, mean);
+                }
+                double acc[4] = {0.0, 0.0, 0.0, 0.0};
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const double diff = static_cast<double>(values[i]) - mean;
+                    acc[i % 4] += diff * diff;
+                }
+                return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            }
+
+            struct MinOp
+            {
+                template <class T>
+                static bool better(const T& a, const T& b)
+                {
+                    return a < b;
+                }
+
+                template <class T>
+                static const T& zoneBound(const ZoneMap<T>& zones, size_t block)
+                {
+                    return zones.min(block);
+                }
+
+                template <class T>
+                static T identity()
+                {
+                    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                                : std::numeric_limits<T>::max();
+                }
+            };
+
+            struct MaxOp
+            {
+                template <class T>
+                static bool better(const T& a, const T& b)
+                {
+                    return a > b;
+                }
+
+                template <class T>
+                static const T& zoneBound(const ZoneMap<T>& zones, size_t block)
+                {
+                    return zones.max(block);
+                }
+
+                template <class T>
+                static T identity()
+                {
+                    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                                : std::numeric_limits<T>::lowest();
+                }
+            };
+
+            // Best value of a span, NaNs never compare better so they are skipped
+            template <class OP, class T>
+            T spanExtremum(const T* values, size_t n)
+            {
+                T best[4] = {OP::template identity<T>(),
+                             OP::template identity<T>(),
+                             OP::template identity<T>(),
+                             OP::template identity<T>()};
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (OP::better(values[i], best[i % 4]))
+                    {
+                        best[i % 4] = values[i];
+                    }
+                }
+                for (size_t j = 1; j < 4; ++j)
+                {
+                    if (OP::better(best[j], best[0]))
+                    {
+                        best[0] = best[j];
+                    }
+                }
+                return best[0];
+            }
+
+#if defined(__AVX2__)
+            // minps/maxps return the second operand when either is NaN, the accumulator goes second so NaNs are
+            // skipped as in the scalar loop
+            inline __m256 extremum8(MinOp, __m256 values, __m256 acc) { return _mm256_min_ps(values, acc); }
+            inline __m256 extremum8(MaxOp, __m256 values, __m256 acc) { return _mm256_max_ps(values, acc); }
+            inline __m256i extremum8(MinOp, __m256i values, __m256i acc) { return _mm256_min_epi32(values, acc); }
+            inline __m256i extremum8(MaxOp, __m256i values, __m256i acc) { return _mm256_max_epi32(values, acc); }
+
+            template <class OP>
+            float spanExtremum(const float* values, size_t n)
+            {
+                __m256 acc = _mm256_set1_ps(OP::template identity<float>());
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    acc = extremum8(OP(), _mm256_loadu_ps(values + i), acc);
+                }
+                alignas(32) float lanes[9];
+                _mm256_store_ps(lanes, acc);
+                lanes[8] = spanExtremum<OP, float>(values + i, n - i);
+                return spanExtremum<OP, float>(lanes, 9);
+            }
+
+            template <class OP>
+            int32_t spanExtremum(const int32_t* values, size_t n)
+            {
+                __m256i acc = _mm256_set1_epi32(OP::template identity<int32_t>());
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    acc = extremum8(OP(), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), acc);
+                }
+                alignas(32) int32_t lanes[9];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+                lanes[8] = spanExtremum<OP, int32_t>(values + i, n - i);
+                return spanExtremum<OP, int32_t>(lanes, 9);
+            }
+#endif // __AVX2__
+
+            template <class OP, class T>
+            struct ExtremumAccumulator
+            {
+                T value = OP::template identity<T>();
+                // Sentinel until a row is found
+                size_t row = std::numeric_limits<size_t>::max();
+
+                // The row is only searched for when the span improves on the current best, the earliest row wins ties
+                void addSpan(const T* values, size_t n, size_t first_row)
+                {
+                    const T best = spanExtremum<OP>(values, n);
+                    if (row != std::numeric_limits<size_t>::max() && !OP::better(best, value))
+                    {
+                        return;
+                    }
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        if (values[i] == best)
+                        {
+                            value = best;
+                            row = first_row + i;
+                            return;
+                        }
+                    }
+                }
+
+                // addSpan for each zone map block of the span whose bound could improve on the current best
+                void addSpan(const T* values, size_t n, size_t first_row, const ZoneMap<T>& zones)
+                {
+                    const size_t BLOCK_ROWS = ZoneMap<T>::BLOCK_ROWS;
+                    const size_t last_row = first_row + n;
+                    for (size_t begin = first_row; begin < last_row;)
+                    {
+                        const size_t block = begin / BLOCK_ROWS;
+                        const size_t end = std::min(last_row, (block + 1) * BLOCK_ROWS);
+                        if (row == std::numeric_limits<size_t>::max() || OP::better(OP::zoneBound(zones, block), value))
+                        {
+                            addSpan(values + (begin - first_row), end - begin, begin);
+                        }
+                        begin = end;
+                    }
+                }
+
+                void merge(const ExtremumAccumulator& other)
+                {
+                    if (other.row == std::numeric_limits<size_t>::max())
+                    {
+                        return;
+                    }
+                    if (row == std::numeric_limits<size_t>::max() || OP::better(other.value, value) ||
+                        (other.value == value && other.row < row))
+                    {
+                        value = other.value;
+                        row = other.row;
+                    }
+                }
+            };
+
+            template <class OP, class STORAGE>
+            ExtremumAccumulator<OP, typename STORAGE::T>
+            extremum(const STORAGE& storage, const RowSelection& rows, size_t num_threads)
+            {
+                using T = typename STORAGE::T;
+                static_assert(STORAGE::data_dim == 0, "min and max need a scalar column");
+                size_t dim = 0;
+                const std::vector<ColumnBlock<T>> blocks = columnBlocks(storage, dim);
+                const size_t num_rows = storage.size();
+                using Acc = ExtremumAccumulator<OP, T>;
+                const ZoneMap<T>* zones = zoneMapOf(storage);
+                auto scan = [&](size_t first, size_t last, Acc& acc) {
+                    forEachSelectedSpan(blocks, rows, num_rows, first, last, [&acc, zones](const ColumnBlock<T>& span) {
+                        if (zones != nullptr)
+                        {
+                            acc.addSpan(span.data, span.rows, span.first, *zones);
+                        }
+                        else
+                        {
+                            acc.addSpan(span.data, span.rows, span.first);
+                        }
+                    });
+                };
+                return reduceRows(rows, num_rows, num_threads, Acc(), scan);
+            }
+
+            struct DimensionSums
+            {
+                std::vector<double> sums;
+
+                void merge(const DimensionSums& other)
+                {
+                    for (size_t d = 0; d < sums.size(); ++d)
+                    {
+                        sums[d] += other.sums[d];
+                    }
+                }
+            };
+        } // namespace detail
+
+        // Sum of the selected rows of a scalar column. Contiguous runs of rows are summed pairwise with SIMD
+        // accumulators and the runs are combined with compensated summation, num_threads > 1 splits the selection
+        // into contiguous ranges.
+        template <class STORAGE>
+        SumType<typename STORAGE::T>
+        sum(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            using T = typename STORAGE::T;
+            using Span = detail::ColumnBlock<T>;
+            using Acc = detail::SumAccumulator<T>;
+            static_assert(STORAGE::data_dim == 0, "sum needs a scalar column, use sumPerDimension for arrays");
+            size_t dim = 0;
+            const std::vector<Span> blocks = detail::columnBlocks(storage, dim);
+            const size_t num_rows = storage.size();
+            auto scan = [&](size_t first, size_t last, Acc& acc) {
+                detail::forEachSelectedSpan(blocks, rows, num_rows, first, last, [&acc](const Span& span) {
+                    detail::addSpan(acc, span.data, span.rows);
+                });
+            };
+            return detail::reduceRows(rows, num_rows, num_threads, Acc(), scan).value();
+        }
+
+        // NaN if no row is selected
+        template <class STORAGE>
+        double mean(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            const size_t count = rows.count(storage.size());
+            if (count == 0)
+            {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            return static_cast<double>(sum(storage, rows, num_threads)) / static_cast<double>(count);
+        }
+
+        // Population variance, computed in two passes (mean, then squared deviations) to avoid the cancellation of
+        // the sum of squares formula
+        template <class STORAGE>
+        double variance(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            using T = typename STORAGE::T;
+            using Span = detail::ColumnBlock<T>;
+            const double mu = mean(storage, rows, num_threads);
+            if (std::isnan(mu))
+            {
+                return mu;
+            }
+            size_t dim = 0;
+            const std::vector<Span> blocks = detail::columnBlocks(storage, dim);
+            const size_t num_rows = storage.size();
+            using Acc = detail::CompensatedSum;
+            auto scan = [&](size_t first, size_t last, Acc& acc) {
+                detail::forEachSelectedSpan(blocks, rows, num_rows, first, last, [&acc, mu](const Span& span) {
+                    acc.add(detail::squaredDeviationSum(span.data, span.rows, mu));
+                });
+            };
+            const Acc acc = detail::reduceRows(rows, num_rows, num_threads, Acc(), scan);
+            return acc.value() / static_cast<double>(rows.count(num_rows));
+        }
+
+        // Smallest selected value, NaNs are ignored. The identity (infinity or the type's max) if nothing is selected.
+        // With a zone map only the blocks whose minimum beats the best value so far are read.
+        template <class STORAGE>
+        typename STORAGE::T
+        minimum(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            return detail::extremum<detail::MinOp>(storage, rows, num_threads).value;
+        }
+
+        template <class STORAGE>
+        typename STORAGE::T
+        maximum(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            return detail::extremum<detail::MaxOp>(storage, rows, num_threads).value;
+        }
+
+        // First row holding the minimum, storage.size() if nothing is selected
+        template <class STORAGE>
+        size_t argmin(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            const size_t row = detail::extremum<detail::MinOp>(storage, rows, num_threads).row;
+            return row == std::numeric_limits<size_t>::max() ? storage.size() : row;
+        }
+
+        template <class STORAGE>
+        size_t argmax(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            const size_t row = detail::extremum<detail::MaxOp>(storage, rows, num_threads).row;
+            return row == std::numeric_limits<size_t>::max() ? storage.size() : row;
+        }
+
+        // Element wise sum over the selected rows of an array column, one value per element of a row
+        template <class STORAGE>
+        std::vector<double>
+        sumPerDimension(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            using T = typename STORAGE::T;
+            using Span = detail::ColumnBlock<T>;
+            static_assert(STORAGE::data_dim == 1, "sumPerDimension needs a column of 1d arrays");
+            size_t dim = 0;
+            const std::vector<Span> blocks = detail::columnBlocks(storage, dim);
+            const size_t num_rows = storage.size();
+            using Acc = detail::DimensionSums;
+            Acc init;
+            init.sums.assign(dim, 0.0);
+            auto scan = [&](size_t first, size_t last, Acc& acc) {
+                detail::forEachSelectedSpan(blocks, rows, num_rows, first, last, [&](const Span& span) {
+                    for (size_t i = 0; i < span.rows; ++i)
+                    {
+                        const T* row = span.data + i * span.stride;
+                        for (size_t d = 0; d < dim; ++d)
+                        {
+                            acc.sums[d] += static_cast<double>(row[d]);
+                        }
+                    }
+                });
+            };
+            return detail::reduceRows(rows, num_rows, num_threads, init, scan).sums;
+        }
+
+        // Element wise mean, e.g. the centroid of an embedding column. NaNs if no row is selected.
+        template <class STORAGE>
+        std::vector<double>
+        meanPerDimension(const STORAGE& storage, const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            std::vector<double> out = sumPerDimension(storage, rows, num_threads);
+            const double count = static_cast<double>(rows.count(storage.size()));
+            for (double& value : out)
+            {
+                value = count == 0.0 ? std::numeric_limits<double>::quiet_NaN() : value / count;
+            }
+            return out;
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_AGGREGATE_HPP
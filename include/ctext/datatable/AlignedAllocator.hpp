@@ -0,0 +1,101 @@
+#ifndef CT_EXT_ALIGNED_ALLOCATOR_HPP
+#define CT_EXT_ALIGNED_ALLOCATOR_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifndef CT_EXT_SIMD_ALIGNMENT
+// Cache line size and the width of an AVX-512 register
+#define CT_EXT_SIMD_ALIGNMENT 64
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        // Allocates ALIGN aligned blocks and rounds every allocation up to a multiple of ALIGN bytes, thus a vector
+        // kernel can always load a full register at the end of a column without reading unowned memory.
+        template <class T, size_t ALIGN = CT_EXT_SIMD_ALIGNMENT>
+        struct AlignedAllocator
+        {
+            static_assert(ALIGN != 0 && (ALIGN & (ALIGN - 1)) == 0, "Alignment must be a power of two");
+            static_assert(ALIGN >= alignof(void*), "Alignment must be at least pointer alignment");
+
+            using value_type = T;
+            static constexpr const size_t alignment = ALIGN;
+
+            template <class U>
+            struct rebind
+            {
+                using other = AlignedAllocator<U, ALIGN>;
+            };
+
+            AlignedAllocator() = default;
+
+            template <class U>
+            AlignedAllocator(const AlignedAllocator<U, ALIGN>&)
+            {
+            }
+
+            static size_t paddedSize(size_t bytes) { return (bytes + ALIGN - 1) / ALIGN * ALIGN; }
+
+            T* allocate(size_t n)
+            {
+                // Over allocate and stash the original pointer in front of the aligned block
+                const size_t bytes = paddedSize(n * sizeof(T)) + ALIGN + sizeof(void*);
+                void* raw = std::malloc(bytes);
+                if (raw == nullptr)
+                {
+                    throw std::bad_alloc();
+                }
+                const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+                const uintptr_t aligned = (start + ALIGN - 1) & ~static_cast<uintptr_t>(ALIGN - 1);
+                reinterpret_cast<void**>(aligned)[-1] = raw;
+                return reinterpret_cast<T*>(aligned);
+            }
+
+            void deallocate(T* ptr, size_t)
+            {
+                if (ptr != nullptr)
+                {
+                    std::free(reinterpret_cast<void**>(ptr)[-1]);
+                }
+            }
+
+            template <class U>
+            bool operator==(const AlignedAllocator<U, ALIGN>&) const
+            {
+                return true;
+            }
+
+            template <class U>
+            bool operator!=(const AlignedAllocator<U, ALIGN>&) const
+            {
+                return false;
+            }
+        };
+
+        template <class T, size_t ALIGN>
+        constexpr const size_t AlignedAllocator<T, ALIGN>::alignment;
+
+        template <class T, size_t ALIGN = CT_EXT_SIMD_ALIGNMENT>
+        using AlignedVector = std::vector<T, AlignedAllocator<T, ALIGN>>;
+
+        // The byte alignment a column buffer guarantees for its first element, DataTableStorage pads the row stride of
+        // subarray columns to the same boundary
+        template <class BUFFER>
+        struct BufferAlignment
+        {
+            static constexpr const size_t value = alignof(typename BUFFER::value_type);
+        };
+
+        template <class T, size_t ALIGN>
+        struct BufferAlignment<std::vector<T, AlignedAllocator<T, ALIGN>>>
+        {
+            static constexpr const size_t value = ALIGN;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_ALIGNED_ALLOCATOR_HPP
@@ -0,0 +1,113 @@
+#ifndef CT_EXT_BIT_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_BIT_DATA_TABLE_STORAGE_HPP
+#include "BitVector.hpp"
+#include "DataTableStorage.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Assignable reference to one row of a packed bool column
+        class BitReference
+        {
+          public:
+            BitReference(uint64_t* word, uint32_t bit) : m_word(word), m_mask(uint64_t(1) << bit) {}
+
+            operator bool() const { return (*m_word & m_mask) != 0; }
+
+            BitReference& operator=(bool value)
+            {
+                *m_word = value ? (*m_word | m_mask) : (*m_word & ~m_mask);
+                return *this;
+            }
+
+            BitReference& operator=(const BitReference& other) { return *this = static_cast<bool>(other); }
+
+          private:
+            uint64_t* m_word;
+            uint64_t m_mask;
+        };
+
+        // Packs a bool column 64 rows to a word. Rows are not addressable, filters should combine the columns with
+        // the word wise operators of BitVector, ie storage(&U::active).bits() & storage(&U::visible).bits().
+        template <class T_>
+        struct BitDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 0;
+            static constexpr const uint8_t storage_dim = 1;
+
+            using T = bool;
+
+            BitReference operator[](size_t idx) { return BitReference(m_bits.words() + idx / 64, idx % 64); }
+
+            bool operator[](size_t idx) const { return m_bits.test(idx); }
+
+            // The packed words starting with the word that holds row idx
+            mt::Tensor<uint64_t, 1> data(size_t idx = 0)
+            {
+                return mt::Tensor<uint64_t, 1>(m_bits.words() + idx / 64, m_bits.numWords() - idx / 64);
+            }
+
+            mt::Tensor<const uint64_t, 1> data(size_t idx = 0) const
+            {
+                return mt::Tensor<const uint64_t, 1>(m_bits.words() + idx / 64, m_bits.numWords() - idx / 64);
+            }
+
+            size_t size() const { return m_bits.size(); }
+
+            BitVector& bits() { return m_bits; }
+            const BitVector& bits() const { return m_bits; }
+
+            // Number of true rows
+            size_t count() const { return m_bits.count(); }
+
+            void reserve(size_t size) { m_bits.reserve(size); }
+
+            // New rows are false
+            void resize(size_t size) { m_bits.resize(size, false); }
+
+            void clear() { m_bits.clear(); }
+
+            void push_back(bool val) { m_bits.push_back(val); }
+
+            void assign(size_t idx, bool val) { m_bits.set(idx, val); }
+
+            void append(const bool* first, size_t n, size_t stride = sizeof(bool)) { m_bits.append(first, n, stride); }
+
+            void copyTo(bool* first, size_t n, size_t stride = sizeof(bool), size_t start = 0) const
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<bool*>(dst + i * stride) = m_bits.test(start + i);
+                }
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            void erase(uint32_t index) { m_bits.erase(index); }
+
+          private:
+            BitVector m_bits;
+        };
+
+        template <class T_>
+        struct HasDenseRows<BitDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <>
+        struct ColumnStorage<bool, void>
+        {
+            using type = BitDataTableStorage<bool>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_BIT_DATA_TABLE_STORAGE_HPP
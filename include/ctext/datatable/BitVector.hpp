@@ -0,0 +1,265 @@
+#ifndef CT_EXT_BIT_VECTOR_HPP
+#define CT_EXT_BIT_VECTOR_HPP
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        namespace detail
+        {
+            inline uint32_t popcount64(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<uint32_t>(__builtin_popcountll(word));
+#else
+                return static_cast<uint32_t>(std::bitset<64>(word).count());
+#endif
+            }
+
+            // Index of the lowest set bit, word must not be zero
+            inline uint32_t countTrailingZeros64(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+                uint32_t count = 0;
+                while ((word & 1) == 0)
+                {
+                    word >>= 1;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
+            // Number of zero bits above the highest set bit, word must not be zero
+            inline uint32_t countLeadingZeros64(uint64_t word)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<uint32_t>(__builtin_clzll(word));
+#else
+                uint32_t count = 0;
+                while ((word >> 63) == 0)
+                {
+                    word <<= 1;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+        } // namespace detail
+
+        // Bits packed 64 to a word. Bits past size() in the last word are always zero, thus whole word operations
+        // such as popcount and the bitwise operators need no masking.
+        class BitVector
+        {
+          public:
+            BitVector() = default;
+
+            explicit BitVector(size_t size, bool value = false) { resize(size, value); }
+
+            size_t size() const { return m_size; }
+
+            bool empty() const { return m_size == 0; }
+
+            uint64_t* words() { return m_words.data(); }
+            const uint64_t* words() const { return m_words.data(); }
+
+            size_t numWords() const { return m_words.size(); }
+
+            bool test(size_t idx) const { return (m_words[idx / 64] >> (idx % 64)) & 1; }
+
+            void set(size_t idx, bool value)
+            {
+                const uint64_t bit = uint64_t(1) << (idx % 64);
+                m_words[idx / 64] = value ? (m_words[idx / 64] | bit) : (m_words[idx / 64] & ~bit);
+            }
+
+            void reserve(size_t size) { m_words.reserve((size + 63) / 64); }
+
+            // New bits are set to value
+            void resize(size_t size, bool value = false)
+            {
+                const size_t old = m_size;
+                if (value && old % 64 != 0)
+                {
+                    m_words.back() |= ~uint64_t(0) << (old % 64);
+                }
+                m_words.resize((size + 63) / 64, value ? ~uint64_t(0) : 0);
+                m_size = size;
+                clearTail();
+            }
+
+            void push_back(bool value)
+            {
+                if (m_size % 64 == 0)
+                {
+                    m_words.push_back(0);
+                }
+                m_words.back() |= uint64_t(value) << (m_size % 64);
+                ++m_size;
+            }
+
+            // Appends n bools spaced stride bytes apart, packing a full word at a time
+            void append(const bool* first, size_t n, size_t stride = sizeof(bool))
+            {
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                size_t i = 0;
+                for (; i < n && m_size % 64 != 0; ++i)
+                {
+                    push_back(*reinterpret_cast<const bool*>(src + i * stride));
+                }
+                m_words.reserve(m_words.size() + (n - i + 63) / 64);
+                for (; i + 64 <= n; i += 64)
+                {
+                    uint64_t word = 0;
+                    for (uint32_t b = 0; b < 64; ++b)
+                    {
+                        word |= uint64_t(*reinterpret_cast<const bool*>(src + (i + b) * stride)) << b;
+                    }
+                    m_words.push_back(word);
+                    m_size += 64;
+                }
+                for (; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const bool*>(src + i * stride));
+                }
+            }
+
+            void clear()
+            {
+                m_words.clear();
+                m_size = 0;
+            }
+
+            // Removes bit idx, later bits move down by one
+            void erase(size_t idx)
+            {
+                size_t word = idx / 64;
+                const uint64_t low = (uint64_t(1) << (idx % 64)) - 1;
+                const uint64_t w = m_words[word];
+                m_words[word] = (w & low) | ((w >> 1) & ~low);
+                for (; word + 1 < m_words.size(); ++word)
+                {
+                    m_words[word] |= m_words[word + 1] << 63;
+                    m_words[word + 1] >>= 1;
+                }
+                --m_size;
+                m_words.resize((m_size + 63) / 64);
+            }
+
+            // Number of set bits
+            size_t count() const
+            {
+                size_t count = 0;
+                for (uint64_t w : m_words)
+                {
+                    count += detail::popcount64(w);
+                }
+                return count;
+            }
+
+            // Calls fn(idx) for every set bit, zero words are skipped whole
+            template <class F>
+            void forEachSet(F&& fn) const
+            {
+                for (size_t word = 0; word < m_words.size(); ++word)
+                {
+                    uint64_t w = m_words[word];
+                    while (w != 0)
+                    {
+                        fn(word * 64 + detail::countTrailingZeros64(w));
+                        w &= w - 1;
+                    }
+                }
+            }
+
+            BitVector& operator&=(const BitVector& other)
+            {
+                assert(other.size() == size());
+                for (size_t i = 0; i < m_words.size(); ++i)
+                {
+                    m_words[i] &= other.m_words[i];
+                }
+                return *this;
+            }
+
+            BitVector& operator|=(const BitVector& other)
+            {
+                assert(other.size() == size());
+                for (size_t i = 0; i < m_words.size(); ++i)
+                {
+                    m_words[i] |= other.m_words[i];
+                }
+                return *this;
+            }
+
+            BitVector& operator^=(const BitVector& other)
+            {
+                assert(other.size() == size());
+                for (size_t i = 0; i < m_words.size(); ++i)
+                {
+                    m_words[i] ^= other.m_words[i];
+                }
+                return *this;
+            }
+
+            // Clears the bits that are set in other
+            BitVector& andNot(const BitVector& other)
+            {
+                assert(other.size() == size());
+                for (size_t i = 0; i < m_words.size(); ++i)
+                {
+                    m_words[i] &= ~other.m_words[i];
+                }
+                return *this;
+            }
+
+            void flip()
+            {
+                for (uint64_t& w : m_words)
+                {
+                    w = ~w;
+                }
+                clearTail();
+            }
+
+            bool operator==(const BitVector& other) const
+            {
+                return m_size == other.m_size && m_words == other.m_words;
+            }
+
+            bool operator!=(const BitVector& other) const { return !(*this == other); }
+
+          private:
+            void clearTail()
+            {
+                if (m_size % 64 != 0)
+                {
+                    m_words.back() &= (uint64_t(1) << (m_size % 64)) - 1;
+                }
+            }
+
+            std::vector<uint64_t> m_words;
+            size_t m_size = 0;
+        };
+
+        inline BitVector operator&(BitVector lhs, const BitVector& rhs) { return lhs &= rhs; }
+
+        inline BitVector operator|(BitVector lhs, const BitVector& rhs) { return lhs |= rhs; }
+
+        inline BitVector operator^(BitVector lhs, const BitVector& rhs) { return lhs ^= rhs; }
+
+        inline BitVector operator~(BitVector bits)
+        {
+            bits.flip();
+            return bits;
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_BIT_VECTOR_HPP
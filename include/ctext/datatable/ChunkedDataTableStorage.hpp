@@ -0,0 +1,315 @@
+#ifndef CT_EXT_CHUNKED_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_CHUNKED_DATA_TABLE_STORAGE_HPP
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Column storage made of fixed size pages of PAGE_ROWS rows. Growing the column only adds pages, thus rows
+        // never move and pointers and views handed out by access stay valid for the lifetime of the table.
+        // data(idx) only spans to the end of the page containing idx, use forEachChunk to iterate the column as
+        // contiguous blocks.
+        template <class T_, size_t PAGE_ROWS = 4096>
+        struct ChunkedDataTableStorage
+        {
+            static_assert(PAGE_ROWS > 0, "Pages must hold at least one row");
+            static constexpr const uint8_t data_dim = DataDimensionality<T_>::value;
+            static constexpr const uint8_t storage_dim = data_dim + 1;
+            static constexpr const size_t page_rows = PAGE_ROWS;
+
+            using T = typename DataDimensionality<T_>::DType;
+            using Page = AlignedVector<T>;
+
+            ChunkedDataTableStorage() { m_shape.calculateStride(); }
+
+            auto operator[](size_t idx) -> decltype(std::declval<mt::Tensor<T, storage_dim>>()[0])
+            {
+                return data(idx)[0];
+            }
+
+            auto operator[](size_t idx) const -> decltype(std::declval<mt::Tensor<const T, storage_dim>>()[0])
+            {
+                return data(idx)[0];
+            }
+
+            mt::Tensor<T, storage_dim> data(size_t idx = 0)
+            {
+                return mt::Tensor<T, storage_dim>(chunkPtr(idx), chunkShape(idx));
+            }
+
+            mt::Tensor<const T, storage_dim> data(size_t idx = 0) const
+            {
+                return mt::Tensor<const T, storage_dim>(chunkPtr(idx), chunkShape(idx));
+            }
+
+            mt::Shape<storage_dim> shape() const { return m_shape; }
+
+            size_t size() const { return m_shape[0]; }
+
+            size_t numChunks() const { return (size() + PAGE_ROWS - 1) / PAGE_ROWS; }
+
+            void reserve(size_t size)
+            {
+                m_reserved = std::max(m_reserved, size);
+                allocatePages(size);
+            }
+
+            void resize(size_t size)
+            {
+                allocatePages(size);
+                for (size_t row = this->size(); row < size; ++row)
+                {
+                    std::fill_n(rowPtr(row), rowStride(), T());
+                }
+                m_shape.setShape(0, static_cast<uint32_t>(size));
+            }
+
+            void clear() { m_shape.setShape(0, 0); }
+
+            void push_back(const T_& val)
+            {
+                auto input_view = mt::tensorWrap(val);
+                resizeSubarray(input_view.getShape());
+                const size_t new_index = size();
+                resize(new_index + 1);
+                mt::Tensor<T, storage_dim> storage_view = data(new_index);
+                storage_view[0] = input_view;
+            }
+
+            void push_back(T_&& val) { push_back(static_cast<const T_&>(val)); }
+
+            // Append n values whose addresses are stride bytes apart, copied one page at a time
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                if (n == 0)
+                {
+                    return;
+                }
+                if (size() == 0)
+                {
+                    resizeSubarray(mt::tensorWrap(*first).getShape());
+                }
+                size_t row = size();
+                resize(row + n);
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                while (n != 0)
+                {
+                    const size_t count = std::min(n, PAGE_ROWS - row % PAGE_ROWS);
+                    gatherRows<T_>(src, count, stride, data(row));
+                    src += count * stride;
+                    row += count;
+                    n -= count;
+                }
+            }
+
+            // Write rows [start, start + n) to n values spaced stride bytes apart
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0)
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                while (n != 0)
+                {
+                    const size_t count = std::min(n, PAGE_ROWS - start % PAGE_ROWS);
+                    scatterRows<T_>(data(start), count, dst, stride);
+                    dst += count * stride;
+                    start += count;
+                    n -= count;
+                }
+            }
+
+            // Calls fn(chunk, first_row) for every page that holds rows
+            template <class F>
+            void forEachChunk(F&& fn)
+            {
+                for (size_t row = 0; row < size(); row += PAGE_ROWS)
+                {
+                    fn(data(row), row);
+                }
+            }
+
+            template <class F>
+            void forEachChunk(F&& fn) const
+            {
+                for (size_t row = 0; row < size(); row += PAGE_ROWS)
+                {
+                    fn(data(row), row);
+                }
+            }
+
+            void resizeSubarray(mt::Shape<data_dim> subshape)
+            {
+                mt::Shape<storage_dim> shape = m_shape;
+                for (uint8_t i = 1; i < storage_dim; ++i)
+                {
+                    shape.setShape(i, subshape[i - 1]);
+                }
+                resizeSubarray(shape);
+            }
+
+            void resizeSubarray(mt::Shape<storage_dim> shape)
+            {
+                shape.setShape(0, m_shape[0]);
+                shape.calculateStride();
+                padRowStride<T, Page>(shape);
+                bool same = true;
+                for (uint8_t i = 1; i < storage_dim; ++i)
+                {
+                    same = same && shape[i] == m_shape[i];
+                }
+                if (!same)
+                {
+                    relayout(shape);
+                }
+            }
+
+            template <uint8_t I>
+            void resizeSubarray(mt::Shape<I>)
+            {
+            }
+
+            // Overwrites row idx in place, the row keeps its address
+            void assign(size_t idx, const T_& val)
+            {
+                assert(idx < size());
+                mt::Tensor<T, storage_dim> storage_view = data(idx);
+                storage_view[0] = mt::tensorWrap(val);
+            }
+
+            // Shifts all following rows down by one, this does not preserve the stability of later rows
+            void erase(uint32_t index)
+            {
+                for (size_t row = index; row + 1 < size(); ++row)
+                {
+                    std::copy_n(rowPtr(row + 1), rowStride(), rowPtr(row));
+                }
+                m_shape.setShape(0, m_shape[0] - 1);
+            }
+
+            // Moves the last row into row index, the order of the rows is not kept
+            void swapRemove(uint32_t index)
+            {
+                const size_t last = size() - 1;
+                if (index != last)
+                {
+                    std::copy_n(rowPtr(last), rowStride(), rowPtr(index));
+                }
+                m_shape.setShape(0, static_cast<uint32_t>(last));
+            }
+
+          private:
+            size_t rowStride() const { return m_shape.getStride(0); }
+
+            void allocatePages(size_t rows)
+            {
+                const size_t needed = (rows + PAGE_ROWS - 1) / PAGE_ROWS;
+                while (m_pages.size() < needed)
+                {
+                    m_pages.emplace_back(PAGE_ROWS * rowStride());
+                }
+            }
+
+            const T* rowPtr(size_t row) const
+            {
+                const size_t page = row / PAGE_ROWS;
+                return page < m_pages.size() ? m_pages[page].data() + (row % PAGE_ROWS) * rowStride() : nullptr;
+            }
+
+            T* rowPtr(size_t row)
+            {
+                return const_cast<T*>(static_cast<const ChunkedDataTableStorage*>(this)->rowPtr(row));
+            }
+
+            // One past the last row is clamped to the end of the first page, so DataTable::end and view never span
+            // separate page allocations and only cover the first page.
+            T* chunkPtr(size_t row) const
+            {
+                if (row == size() && row >= PAGE_ROWS)
+                {
+                    return const_cast<T*>(rowPtr(PAGE_ROWS - 1)) + rowStride();
+                }
+                return const_cast<T*>(rowPtr(row));
+            }
+
+            mt::Shape<storage_dim> chunkShape(size_t row) const
+            {
+                mt::Shape<storage_dim> shape = m_shape;
+                const size_t page_end = std::min((row / PAGE_ROWS + 1) * PAGE_ROWS, size());
+                shape.setShape(0, static_cast<uint32_t>(page_end - std::min(row, page_end)));
+                return shape;
+            }
+
+            // The subarray shape changed, existing rows keep the leading elements that still fit
+            void relayout(const mt::Shape<storage_dim>& shape)
+            {
+                std::vector<Page> pages;
+                pages.swap(m_pages);
+                const mt::Shape<storage_dim> old_shape = m_shape;
+                m_shape = shape;
+                allocatePages(std::max(m_reserved, size()));
+                // The overlap is copied one innermost run at a time, the outer dimensions are laid out with the old
+                // and the new strides respectively
+                const size_t run = std::min(old_shape[storage_dim - 1], m_shape[storage_dim - 1]);
+                size_t num_runs = 1;
+                for (uint8_t i = 1; i + 1 < storage_dim; ++i)
+                {
+                    num_runs *= std::min(old_shape[i], m_shape[i]);
+                }
+                const size_t old_stride = old_shape.getStride(0);
+                for (size_t row = 0; row < size(); ++row)
+                {
+                    const T* src = pages[row / PAGE_ROWS].data() + (row % PAGE_ROWS) * old_stride;
+                    T* dst = rowPtr(row);
+                    for (size_t r = 0; r < num_runs; ++r)
+                    {
+                        size_t rest = r;
+                        size_t src_offset = 0;
+                        size_t dst_offset = 0;
+                        for (size_t i = storage_dim - 2; i > 0; --i)
+                        {
+                            const size_t extent = std::min(old_shape[i], m_shape[i]);
+                            src_offset += (rest % extent) * old_shape.getStride(i);
+                            dst_offset += (rest % extent) * m_shape.getStride(i);
+                            rest /= extent;
+                        }
+                        std::copy_n(src + src_offset, run, dst + dst_offset);
+                    }
+                }
+            }
+
+            std::vector<Page> m_pages;
+            mt::Shape<storage_dim> m_shape;
+            size_t m_reserved = 0;
+        };
+
+        // Every column is paged, appends never relocate existing rows. DataTable::begin/end and view only cover
+        // the first page, end is clamped to it, iterate large tables with DataTable::forEachChunk.
+        template <class... Ts>
+        struct ChunkedStoragePolicy
+        {
+            template <class T>
+            using StorageType = ChunkedDataTableStorage<T>;
+            using type = std::tuple<StorageType<Ts>...>;
+            type m_data;
+
+            template <index_t I>
+            auto get() -> decltype(std::get<I>(m_data))
+            {
+                return std::get<I>(m_data);
+            }
+
+            template <index_t I>
+            auto get() const -> decltype(std::get<I>(m_data))
+            {
+                return std::get<I>(m_data);
+            }
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_CHUNKED_DATA_TABLE_STORAGE_HPP
@@ -0,0 +1,253 @@
+#ifndef CT_EXT_COLUMN_ARENA_HPP
+#define CT_EXT_COLUMN_ARENA_HPP
+#include "AlignedAllocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // A single allocation shared by all columns of a table. Each column owns a slot of the block, every slot is
+        // CT_EXT_SIMD_ALIGNMENT aligned. When one slot runs out of room all slots are regrown together into a new
+        // block, so a table costs one allocation per growth step instead of one per column.
+        // Requests from reserve are recorded and only committed on the next resize, thus reserving every column of a
+        // table results in a single allocation.
+        struct ColumnArena
+        {
+            ColumnArena() = default;
+            ColumnArena(const ColumnArena&) = delete;
+            ColumnArena& operator=(const ColumnArena&) = delete;
+
+            ~ColumnArena() { release(m_block, m_block_size); }
+
+            size_t addSlot()
+            {
+                m_slots.push_back(Slot());
+                return m_slots.size() - 1;
+            }
+
+            uint8_t* data(size_t slot) const { return m_block ? m_block + m_slots[slot].offset : nullptr; }
+
+            size_t size(size_t slot) const { return m_slots[slot].size; }
+
+            size_t capacity(size_t slot) const { return m_slots[slot].capacity; }
+
+            // Total bytes of the backing block
+            size_t blockSize() const { return m_block_size; }
+
+            void reserve(size_t slot, size_t bytes)
+            {
+                Slot& s = m_slots[slot];
+                if (bytes > s.capacity && bytes > s.requested)
+                {
+                    s.requested = bytes;
+                    m_pending = true;
+                }
+            }
+
+            // New bytes are zero initialized to match std::vector::resize for trivial types
+            void resize(size_t slot, size_t bytes)
+            {
+                if (bytes > m_slots[slot].capacity || m_pending)
+                {
+                    regrow(slot, bytes);
+                }
+                Slot& s = m_slots[slot];
+                if (bytes > s.size)
+                {
+                    std::memset(m_block + s.offset + s.size, 0, bytes - s.size);
+                }
+                s.size = bytes;
+            }
+
+          private:
+            static constexpr const size_t ALIGN = CT_EXT_SIMD_ALIGNMENT;
+
+            struct Slot
+            {
+                size_t offset = 0;
+                size_t size = 0;
+                size_t capacity = 0;
+                size_t requested = 0;
+            };
+
+            static size_t roundUp(size_t bytes) { return (bytes + ALIGN - 1) / ALIGN * ALIGN; }
+
+            static void release(uint8_t* block, size_t bytes)
+            {
+                if (block)
+                {
+                    AlignedAllocator<uint8_t, ALIGN>().deallocate(block, bytes);
+                }
+            }
+
+            void regrow(size_t slot, size_t bytes)
+            {
+                const bool grow = bytes > m_slots[slot].capacity;
+                std::vector<size_t> capacities(m_slots.size());
+                bool changed = m_block == nullptr;
+                for (size_t i = 0; i < m_slots.size(); ++i)
+                {
+                    const Slot& s = m_slots[i];
+                    size_t cap = std::max(s.capacity, s.requested);
+                    if (grow)
+                    {
+                        // Grow every column geometrically, columns are filled at the same row rate
+                        cap = std::max(cap, std::max(2 * s.capacity, static_cast<size_t>(ALIGN)));
+                    }
+                    if (i == slot)
+                    {
+                        cap = std::max(cap, bytes);
+                    }
+                    capacities[i] = roundUp(cap);
+                    changed = changed || capacities[i] != s.capacity;
+                }
+                m_pending = false;
+                if (!changed)
+                {
+                    return;
+                }
+
+                size_t total = 0;
+                for (size_t i = 0; i < m_slots.size(); ++i)
+                {
+                    total += capacities[i];
+                }
+                uint8_t* block = AlignedAllocator<uint8_t, ALIGN>().allocate(std::max<size_t>(total, 1));
+                size_t offset = 0;
+                for (size_t i = 0; i < m_slots.size(); ++i)
+                {
+                    Slot& s = m_slots[i];
+                    if (s.size)
+                    {
+                        std::memcpy(block + offset, m_block + s.offset, s.size);
+                    }
+                    s.offset = offset;
+                    s.capacity = capacities[i];
+                    s.requested = 0;
+                    offset += capacities[i];
+                }
+                release(m_block, m_block_size);
+                m_block = block;
+                m_block_size = std::max<size_t>(total, 1);
+            }
+
+            std::vector<Slot> m_slots;
+            uint8_t* m_block = nullptr;
+            size_t m_block_size = 0;
+            bool m_pending = false;
+        };
+
+        // Column buffer that lives in a slot of a ColumnArena, implements the part of the std::vector interface
+        // used by DataTableStorage. A buffer that is not bound to an arena lazily creates a private one.
+        // Elements are relocated with memcpy when the arena regrows, thus T must be trivially copyable.
+        template <class T>
+        struct ArenaBuffer
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Arena columns are relocated with memcpy");
+
+            using value_type = T;
+            using iterator = T*;
+            using const_iterator = const T*;
+
+            ArenaBuffer() = default;
+
+            explicit ArenaBuffer(std::shared_ptr<ColumnArena> arena)
+                : m_arena(std::move(arena)), m_slot(m_arena->addSlot())
+            {
+            }
+
+            // Copies only the content, the copy gets a private arena
+            ArenaBuffer(const ArenaBuffer& other) { *this = other; }
+
+            ArenaBuffer(ArenaBuffer&&) = default;
+
+            // Copies the content into this buffer's own slot, the arena binding is not changed
+            ArenaBuffer& operator=(const ArenaBuffer& other)
+            {
+                if (this != &other)
+                {
+                    resize(other.size());
+                    if (!other.empty())
+                    {
+                        std::memcpy(data(), other.data(), other.size() * sizeof(T));
+                    }
+                }
+                return *this;
+            }
+
+            ArenaBuffer& operator=(ArenaBuffer&&) = default;
+
+            T* data() { return m_arena ? reinterpret_cast<T*>(m_arena->data(m_slot)) : nullptr; }
+            const T* data() const { return m_arena ? reinterpret_cast<const T*>(m_arena->data(m_slot)) : nullptr; }
+
+            T* begin() { return data(); }
+            const T* begin() const { return data(); }
+            T* end() { return data() + size(); }
+            const T* end() const { return data() + size(); }
+
+            size_t size() const { return m_arena ? m_arena->size(m_slot) / sizeof(T) : 0; }
+            size_t capacity() const { return m_arena ? m_arena->capacity(m_slot) / sizeof(T) : 0; }
+            bool empty() const { return size() == 0; }
+
+            void reserve(size_t n) { arena().reserve(m_slot, n * sizeof(T)); }
+
+            void resize(size_t n) { arena().resize(m_slot, n * sizeof(T)); }
+
+            void clear()
+            {
+                if (m_arena)
+                {
+                    m_arena->resize(m_slot, 0);
+                }
+            }
+
+            T* erase(T* first, T* last)
+            {
+                const size_t n = static_cast<size_t>(last - first);
+                std::memmove(first, last, static_cast<size_t>(end() - last) * sizeof(T));
+                const size_t index = static_cast<size_t>(first - begin());
+                resize(size() - n);
+                return begin() + index;
+            }
+
+            T* insert(T* pos, const T& val)
+            {
+                const size_t index = static_cast<size_t>(pos - begin());
+                const T tmp = val;
+                resize(size() + 1);
+                T* ptr = begin() + index;
+                std::memmove(ptr + 1, ptr, (size() - index - 1) * sizeof(T));
+                *ptr = tmp;
+                return ptr;
+            }
+
+          private:
+            ColumnArena& arena()
+            {
+                if (!m_arena)
+                {
+                    m_arena = std::make_shared<ColumnArena>();
+                    m_slot = m_arena->addSlot();
+                }
+                return *m_arena;
+            }
+
+            std::shared_ptr<ColumnArena> m_arena;
+            size_t m_slot = 0;
+        };
+
+        template <class T>
+        struct BufferAlignment<ArenaBuffer<T>>
+        {
+            static constexpr const size_t value = CT_EXT_SIMD_ALIGNMENT;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_COLUMN_ARENA_HPP
@@ -1,7 +1,9 @@
 #ifndef CT_EXT_DATA_TABLE_BASE_HPP
 #define CT_EXT_DATA_TABLE_BASE_HPP
+#include "Gather.hpp"
 #include "IDataTable.hpp"
 #include "SelectComponents.hpp"
+#include "Sort.hpp"
 
 #include <ct/reflect.hpp>
 #include <ct/type_traits.hpp>
@@ -26,25 +28,44 @@ namespace ct
 
         {
             using Storage = STORAGE_POLICY<Args...>;
+            static constexpr bool has_append_only_column =
+                AnyTrue<IsAppendOnly<typename Storage::template StorageType<Args>>::value...>::value;
+
             DataTableBase() { fillOffsets(Reflect<U>::end()); }
 
             template <class V>
             void populateDataRecurse(V& data, const size_t row, const ct::Indexer<0> idx)
             {
                 const auto accessor = Reflect<V>::getPtr(idx);
-                accessor.set(data, Storage::template get<0>()[row]);
+                accessor.set(data, readRow(Storage::template get<0>(), row));
             }
 
             template <class V, index_t I>
             void populateDataRecurse(V& data, const size_t row, const ct::Indexer<I> idx)
             {
                 const auto accessor = Reflect<V>::getPtr(idx);
-                accessor.set(data, Storage::template get<I>()[row]);
+                accessor.set(data, readRow(Storage::template get<I>(), row));
                 const auto next = --idx;
                 populateDataRecurse(data, row, next);
             }
 
           protected:
+            // Scalar rows are read through the const storage, so reading a row keeps the column's zone map. Array
+            // rows are views that U may hold as mutable.
+            template <class S>
+            static auto readRow(S& storage, const size_t row)
+                -> EnableIf<S::data_dim == 0, decltype(std::declval<const S&>()[row])>
+            {
+                return static_cast<const S&>(storage)[row];
+            }
+
+            template <class S>
+            static auto readRow(S& storage, const size_t row)
+                -> EnableIf<S::data_dim != 0, decltype(storage[row])>
+            {
+                return storage[row];
+            }
+
             void reserveImpl(const size_t size, const ct::Indexer<0>) { Storage::template get<0>().reserve(size); }
 
             template <index_t I>
@@ -73,6 +94,181 @@ namespace ct
                 push(data, next);
             }
 
+            void appendImpl(const U* rows, const size_t n, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                auto& ref = Storage::template get<0>();
+                ref.append(&accessor.get(rows[0]), n, sizeof(U));
+            }
+
+            template <index_t I>
+            void appendImpl(const U* rows, const size_t n, const ct::Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                auto& ref = Storage::template get<I>();
+                ref.append(&accessor.get(rows[0]), n, sizeof(U));
+                const auto next = --idx;
+                appendImpl(rows, n, next);
+            }
+
+            void copyToImpl(U* rows, const size_t n, const size_t start, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                auto& ref = Storage::template get<0>();
+                ref.copyTo(&accessor.set(rows[0]), n, sizeof(U), start);
+            }
+
+            template <index_t I>
+            void copyToImpl(U* rows, const size_t n, const size_t start, const ct::Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                auto& ref = Storage::template get<I>();
+                ref.copyTo(&accessor.set(rows[0]), n, sizeof(U), start);
+                const auto next = --idx;
+                copyToImpl(rows, n, start, next);
+            }
+
+            void gatherImpl(const uint32_t* idx, const size_t n, U* out, const ct::Indexer<0> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                detail::gatherColumn(Storage::template get<0>(), idx, n, &accessor.set(out[0]), sizeof(U));
+            }
+
+            template <index_t I>
+            void gatherImpl(const uint32_t* idx, const size_t n, U* out, const ct::Indexer<I> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                detail::gatherColumn(Storage::template get<I>(), idx, n, &accessor.set(out[0]), sizeof(U));
+                const auto next = --field_index;
+                gatherImpl(idx, n, out, next);
+            }
+
+            void scatterImpl(const uint32_t* idx, const size_t n, const U* rows, const ct::Indexer<0> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                detail::scatterColumn(Storage::template get<0>(), idx, n, &accessor.get(rows[0]), sizeof(U));
+            }
+
+            template <index_t I>
+            void scatterImpl(const uint32_t* idx, const size_t n, const U* rows, const ct::Indexer<I> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                detail::scatterColumn(Storage::template get<I>(), idx, n, &accessor.get(rows[0]), sizeof(U));
+                const auto next = --field_index;
+                scatterImpl(idx, n, rows, next);
+            }
+
+            void appendRowsImpl(DataTableBase& src, const uint32_t* idx, const size_t n,
+                                const ct::Indexer<0> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::appendColumnRows<Member>(Storage::template get<0>(), src.template get<0>(), idx, n);
+            }
+
+            template <index_t I>
+            void appendRowsImpl(DataTableBase& src, const uint32_t* idx, const size_t n,
+                                const ct::Indexer<I> field_index)
+            {
+                const auto accessor = Reflect<U>::getPtr(field_index);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::appendColumnRows<Member>(Storage::template get<I>(), src.template get<I>(), idx, n);
+                const auto next = --field_index;
+                appendRowsImpl(src, idx, n, next);
+            }
+
+            void eraseImpl(const uint32_t row, const ct::Indexer<0>) { Storage::template get<0>().erase(row); }
+
+            template <index_t I>
+            void eraseImpl(const uint32_t row, const ct::Indexer<I> idx)
+            {
+                Storage::template get<I>().erase(row);
+                const auto next = --idx;
+                eraseImpl(row, next);
+            }
+
+            void swapRemoveImpl(const uint32_t row, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::swapRemoveColumn<Member>(Storage::template get<0>(), row);
+            }
+
+            template <index_t I>
+            void swapRemoveImpl(const uint32_t row, const ct::Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::swapRemoveColumn<Member>(Storage::template get<I>(), row);
+                const auto next = --idx;
+                swapRemoveImpl(row, next);
+            }
+
+            void keepRowsImpl(const uint32_t* rows, const size_t n, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::keepColumnRows<Member>(Storage::template get<0>(), rows, n);
+            }
+
+            template <index_t I>
+            void keepRowsImpl(const uint32_t* rows, const size_t n, const ct::Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::keepColumnRows<Member>(Storage::template get<I>(), rows, n);
+                const auto next = --idx;
+                keepRowsImpl(rows, n, next);
+            }
+
+            void permuteImpl(const std::vector<uint32_t>& order, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::permuteColumn<Member>(Storage::template get<0>(), order);
+            }
+
+            template <index_t I>
+            void permuteImpl(const std::vector<uint32_t>& order, const ct::Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                detail::permuteColumn<Member>(Storage::template get<I>(), order);
+                const auto next = --idx;
+                permuteImpl(order, next);
+            }
+
+            // Visits the columns in declaration order as fn(member_name, field_offset, storage)
+            template <class F>
+            void forEachColumnImpl(F& fn, const ct::Indexer<0> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                fn(accessor.getName(), m_field_offsets[0], Storage::template get<0>());
+            }
+
+            template <class F, index_t I>
+            void forEachColumnImpl(F& fn, const ct::Indexer<I> idx)
+            {
+                forEachColumnImpl(fn, --idx);
+                const auto accessor = Reflect<U>::getPtr(idx);
+                fn(accessor.getName(), m_field_offsets[I], Storage::template get<I>());
+            }
+
+            template <class F>
+            void forEachColumnImpl(F& fn, const ct::Indexer<0> idx) const
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                fn(accessor.getName(), m_field_offsets[0], Storage::template get<0>());
+            }
+
+            template <class F, index_t I>
+            void forEachColumnImpl(F& fn, const ct::Indexer<I> idx) const
+            {
+                forEachColumnImpl(fn, --idx);
+                const auto accessor = Reflect<U>::getPtr(idx);
+                fn(accessor.getName(), m_field_offsets[I], Storage::template get<I>());
+            }
+
             mt::Tensor<void, 2> ptr(const size_t offset, const size_t index, const ct::Indexer<0>)
             {
                 if (offset == m_field_offsets[0])
@@ -95,9 +291,14 @@ namespace ct
                 return ptr(offset, index, next);
             }
 
+            // The interface hands out typed pointers, so packed and encoded columns are reported as missing
             mt::Tensor<void, 2> ptr(const size_t offset, const size_t index) override
             {
                 const auto itr = ct::Reflect<U>::end();
+                if (!hasDenseRows(offset, itr))
+                {
+                    return {nullptr, 1};
+                }
                 return ptr(offset, index, itr);
             }
 
@@ -126,9 +327,31 @@ namespace ct
             mt::Tensor<const void, 2> ptr(const size_t offset, const size_t index) const override
             {
                 const auto itr = ct::Reflect<U>::end();
+                if (!hasDenseRows(offset, itr))
+                {
+                    return {nullptr, 1};
+                }
                 return ptr(offset, index, itr);
             }
 
+            bool hasDenseRows(const size_t offset, ct::Indexer<0>) const
+            {
+                using storage_type = typename std::decay<decltype(Storage::template get<0>())>::type;
+                return offset != m_field_offsets[0] || HasDenseRows<storage_type>::value;
+            }
+
+            template <index_t I>
+            bool hasDenseRows(const size_t offset, ct::Indexer<I> field_index) const
+            {
+                using storage_type = typename std::decay<decltype(Storage::template get<I>())>::type;
+                if (offset == m_field_offsets[I])
+                {
+                    return HasDenseRows<storage_type>::value;
+                }
+                const auto next = --field_index;
+                return hasDenseRows(offset, next);
+            }
+
             template <class T>
             const void* storageImpl(const size_t offset, ct::Indexer<0>) const
             {
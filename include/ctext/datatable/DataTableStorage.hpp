@@ -1,6 +1,10 @@
 #ifndef CT_EXT_DATA_TABLE_STORAGE_HPP
 #define CT_EXT_DATA_TABLE_STORAGE_HPP
+#include "AlignedAllocator.hpp"
+#include "ColumnArena.hpp"
 #include "DataTableArrayIterator.hpp"
+#include "Transpose.hpp"
+#include "ZoneMap.hpp"
 
 #include <ct/reflect.hpp>
 #include <ct/static_asserts.hpp>
@@ -10,8 +14,11 @@
 
 #include <minitensor/Tensor.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <memory>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace mt {
@@ -108,16 +115,144 @@ struct DataDimensionality<
   using ConstTensorView = mt::Tensor<const DType, value + 1>;
 };
 
-template <class T_> struct DataTableStorage {
+// Rows of subarray columns start on the alignment guaranteed by the buffer,
+// which may leave padding between rows
+template <class T, class BUFFER, uint8_t N>
+void padRowStride(mt::Shape<N> &shape, std::true_type) {
+  const size_t align = BufferAlignment<BUFFER>::value;
+  if (align <= sizeof(T) || align % sizeof(T) != 0) {
+    return;
+  }
+  const size_t elems = align / sizeof(T);
+  const size_t stride = shape.getStride(0);
+  shape.setStride(0, (stride + elems - 1) / elems * elems);
+}
+
+template <class T, class BUFFER, uint8_t N>
+void padRowStride(mt::Shape<N> &, std::false_type) {}
+
+template <class T, class BUFFER, uint8_t N>
+void padRowStride(mt::Shape<N> &shape) {
+  padRowStride<T, BUFFER>(shape, std::integral_constant<bool, (N > 1)>{});
+}
+
+// Scalar columns whose element is bitwise the stored type can use the SIMD
+// transpose kernels
+template <class T_, class T>
+using Transposable =
+    std::integral_constant<bool, std::is_trivially_copyable<T_>::value &&
+                                     std::is_trivially_copyable<T>::value &&
+                                     sizeof(T_) == sizeof(T)>;
+
+template <class T_, class T>
+void gatherScalars(const uint8_t *src, size_t n, size_t stride, T *dst,
+                   std::true_type) {
+  stridedGather(src, stride, n, dst);
+}
+
+template <class T_, class T>
+void gatherScalars(const uint8_t *src, size_t n, size_t stride, T *dst,
+                   std::false_type) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = *reinterpret_cast<const T_ *>(src + i * stride);
+  }
+}
+
+template <class T_, class T>
+void gatherRows(const uint8_t *src, size_t n, size_t stride,
+                mt::Tensor<T, 1> dst) {
+  gatherScalars<T_>(src, n, stride, dst.data(), Transposable<T_, T>{});
+}
+
+// Copy n values spaced stride bytes apart into the first n rows of dst
+template <class T_, class T, uint8_t N>
+void gatherRows(const uint8_t *src, size_t n, size_t stride,
+                mt::Tensor<T, N> dst) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = mt::tensorWrap(*reinterpret_cast<const T_ *>(src + i * stride));
+  }
+}
+
+template <class T_, class T>
+void scatterScalars(const T *src, size_t n, uint8_t *dst, size_t stride,
+                    std::true_type) {
+  stridedScatter(src, n, dst, stride);
+}
+
+template <class T_, class T>
+void scatterScalars(const T *src, size_t n, uint8_t *dst, size_t stride,
+                    std::false_type) {
+  for (size_t i = 0; i < n; ++i) {
+    *reinterpret_cast<T_ *>(dst + i * stride) = src[i];
+  }
+}
+
+template <class T_, class T>
+void scatterRows(mt::Tensor<T, 1> src, size_t n, uint8_t *dst, size_t stride) {
+  scatterScalars<T_>(src.data(), n, dst, stride, Transposable<T_, T>{});
+}
+
+// Write the first n rows of src to n values spaced stride bytes apart,
+// subarray values are set to views of src
+template <class T_, class T, uint8_t N>
+void scatterRows(mt::Tensor<T, N> src, size_t n, uint8_t *dst, size_t stride) {
+  for (size_t i = 0; i < n; ++i) {
+    *reinterpret_cast<T_ *>(dst + i * stride) = src[i];
+  }
+}
+
+// Hints that the memory at ptr is read soon
+inline void prefetchRow(const void *ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr);
+#else
+  (void)ptr;
+#endif
+}
+
+// Rows read ahead by the indexed gathers, far enough to hide a cache miss
+constexpr const size_t PREFETCH_ROWS = 16;
+
+// Row i of dst is row idx[i] of src, rows are row_stride values apart. The
+// indices are known up front so the row PREFETCH_ROWS ahead is prefetched.
+template <class T>
+void gatherIndexedRows(const T *src, const uint32_t *idx, size_t n,
+                       size_t row_stride, T *dst) {
+  for (size_t i = 0; i < n; ++i) {
+    if (i + PREFETCH_ROWS < n) {
+      prefetchRow(src + idx[i + PREFETCH_ROWS] * row_stride);
+    }
+    if (row_stride == 1) {
+      dst[i] = src[idx[i]];
+    } else {
+      std::copy(src + idx[i] * row_stride, src + (idx[i] + 1) * row_stride,
+                dst + i * row_stride);
+    }
+  }
+}
+
+// BUFFER is the contiguous container backing the column, it needs the subset of
+// the std::vector interface used below
+template <class T_,
+          class BUFFER = std::vector<typename DataDimensionality<T_>::DType>>
+struct DataTableStorage {
   static constexpr const uint8_t data_dim = DataDimensionality<T_>::value;
   static constexpr const uint8_t storage_dim = data_dim + 1;
 
   using T = typename DataDimensionality<T_>::DType;
+  using Buffer = BUFFER;
 
-  DataTableStorage() {}
+  DataTableStorage() { m_shape.calculateStride(); }
 
+  explicit DataTableStorage(BUFFER buffer) : m_data(std::move(buffer)) {
+    m_shape.calculateStride();
+  }
+
+  // Writes through the returned row are not tracked, so this drops the zone
+  // map like data(); read through a const storage to keep it
   auto operator[](size_t idx)
       -> decltype(std::declval<mt::Tensor<T, storage_dim>>()[idx]) {
+    m_zones_valid = false;
     T *ptr = m_data.data();
     mt::Tensor<T, storage_dim> view(ptr, m_shape);
     return view[idx];
@@ -130,13 +265,11 @@ template <class T_> struct DataTableStorage {
     return view[idx];
   }
 
+  // Writes through the returned tensor are not tracked, so this drops the zone
+  // map until buildZoneMap is called again
   mt::Tensor<T, storage_dim> data(size_t idx = 0) {
-    T *ptr = m_data.data();
-    mt::Shape<storage_dim> out_shape = m_shape;
-    const auto stride = out_shape.getStride(0);
-    ptr += stride * idx;
-    out_shape.setShape(0, out_shape[0] - idx);
-    return mt::Tensor<T, storage_dim>(ptr, out_shape);
+    m_zones_valid = false;
+    return view(idx);
   }
 
   mt::Tensor<const T, storage_dim> data(size_t idx = 0) const {
@@ -148,25 +281,23 @@ template <class T_> struct DataTableStorage {
     return mt::Tensor<const T, storage_dim>(ptr, out_shape);
   }
 
-  void reserve(size_t size) {
-    auto tmp = m_shape;
-    tmp.setShape(0, size);
-    const auto num_elems = tmp.numElements();
-    m_data.reserve(num_elems);
-  }
+  void reserve(size_t size) { m_data.reserve(size * m_shape.getStride(0)); }
 
   mt::Shape<storage_dim> shape() const { return m_shape; }
 
   void reshape(mt::Shape<storage_dim> shape) {
     m_shape = std::move(shape);
-    m_data.resize(m_shape.numElements());
+    padStride();
+    m_data.resize(bufferSize());
+    updateZones(0);
   }
 
   size_t size() const { return m_shape[0]; }
 
   void resize(size_t size) {
-    m_shape.setShape(0, size);
-    m_data.resize(m_shape.numElements());
+    const size_t old_size = this->size();
+    resizeRows(size);
+    updateZones(old_size);
   }
 
   void push_back(const T_ &val) {
@@ -175,14 +306,11 @@ template <class T_> struct DataTableStorage {
     ct::StaticEqualTypes<const T, const typename decltype(input_view)::DType>{};
 
     resizeSubarray(input_view.getShape());
-    const size_t current_elems = m_data.size();
-    const size_t new_elems = input_view.getShape().numElements();
-    const size_t new_size = current_elems + new_elems;
-    m_data.resize(new_size);
     uint32_t new_index = m_shape[0];
-    m_shape.setShape(0, new_index + 1);
-    mt::Tensor<T, storage_dim> storage_view = this->data();
+    resizeRows(new_index + 1);
+    mt::Tensor<T, storage_dim> storage_view = this->view();
     storage_view[new_index] = input_view;
+    updateZones(new_index);
     // storage_view[new_size - 1].assign(input_view);
     // m_data.push_back(val);
   }
@@ -198,8 +326,84 @@ template <class T_> struct DataTableStorage {
       new_shape.setShape(i, input_shape[i - 1]);
     }
     this->resizeSubarray(new_shape);
-    mt::Tensor<T, storage_dim> storage_view = this->data();
+    mt::Tensor<T, storage_dim> storage_view = this->view();
     storage_view[new_index] = input_view;
+    updateZones(new_index);
+  }
+
+  // Append n values whose addresses are stride bytes apart, ie the same member
+  // of n consecutive structs. The column is grown once before copying.
+  void append(const T_ *first, size_t n, size_t stride = sizeof(T_)) {
+    if (n == 0) {
+      return;
+    }
+    if (size() == 0) {
+      resizeSubarray(mt::tensorWrap(*first).getShape());
+    }
+    const size_t start = size();
+    resizeRows(start + n);
+    gatherRows<T_>(reinterpret_cast<const uint8_t *>(first), n, stride,
+                   view(start));
+    updateZones(start);
+  }
+
+  // Write rows [start, start + n) to n values spaced stride bytes apart, the
+  // inverse of append. Subarray values are set to views into this storage.
+  void copyTo(T_ *first, size_t n, size_t stride = sizeof(T_),
+              size_t start = 0) {
+    assert(start + n <= size());
+    scatterRows<T_>(view(start), n, reinterpret_cast<uint8_t *>(first),
+                    stride);
+  }
+
+  // Write rows idx[0], ..., idx[n - 1] to n values spaced stride bytes apart,
+  // copyTo for an index list
+  void gather(const uint32_t *idx, size_t n, T_ *first,
+              size_t stride = sizeof(T_)) {
+    gatherIndexed(idx, n, reinterpret_cast<uint8_t *>(first), stride,
+                  std::integral_constant<bool, data_dim == 0>{});
+  }
+
+  // Assign n values spaced stride bytes apart to rows idx[0], ...,
+  // idx[n - 1]
+  void scatter(const uint32_t *idx, size_t n, const T_ *first,
+               size_t stride = sizeof(T_)) {
+    scatterIndexed(idx, n, reinterpret_cast<const uint8_t *>(first), stride,
+                   std::integral_constant<bool, data_dim == 0>{});
+  }
+
+  // Append rows idx[0], ..., idx[n - 1] of src, whole rows are copied from
+  // buffer to buffer
+  void appendRows(const DataTableStorage &src, const uint32_t *idx,
+                  size_t n) {
+    if (n == 0) {
+      return;
+    }
+    if (size() == 0) {
+      m_shape = src.m_shape;
+      m_shape.setShape(0, 0);
+    }
+    const size_t row_stride = m_shape.getStride(0);
+    assert(row_stride == src.m_shape.getStride(0));
+    const size_t start = size();
+    resizeRows(start + n);
+    gatherIndexedRows(src.m_data.data(), idx, n, row_stride,
+                      m_data.data() + start * row_stride);
+    updateZones(start);
+  }
+
+  // Calls fn(chunk, first_row) for every contiguous block of rows, the whole
+  // column is a single block
+  template <class F> void forEachChunk(F &&fn) {
+    if (size() != 0) {
+      fn(data(), size_t(0));
+    }
+  }
+
+  template <class F> void forEachChunk(F &&fn) const {
+    if (size() != 0) {
+      fn(data(), size_t(0));
+    }
   }
 
   void resizeSubarray(mt::Shape<data_dim> subshape) {
@@ -208,14 +412,16 @@ template <class T_> struct DataTableStorage {
       m_shape.setShape(i, subshape[i - 1]);
     }
     m_shape.calculateStride();
-    m_data.resize(m_shape.numElements());
+    padStride();
+    m_data.resize(bufferSize());
   }
 
   void resizeSubarray(mt::Shape<storage_dim> shape) {
     // TODO move stuff?
     m_shape = std::move(shape);
     m_shape.calculateStride();
-    m_data.resize(m_shape.numElements());
+    padStride();
+    m_data.resize(bufferSize());
   }
 
   template <uint8_t I> void resizeSubarray(mt::Shape<I>) {
@@ -223,24 +429,68 @@ template <class T_> struct DataTableStorage {
   }
 
   void erase(uint32_t index) {
-    if (data_dim > 1) {
-      const auto subdim_size = mt::stripOuterDim(m_shape).numElements();
-      m_data.erase(m_data.begin() + index * subdim_size,
-                   m_data.begin() + (index + 1) * subdim_size);
-    } else {
-      m_data.erase(m_data.begin() + index);
-    }
+    const size_t row_stride = m_shape.getStride(0);
+    m_data.erase(m_data.begin() + index * row_stride,
+                 m_data.begin() + (index + 1) * row_stride);
     m_shape.setShape(0, m_shape[0] - 1);
+    updateZones(index);
+  }
+
+  // Moves the last row into row index and drops the last row, O(1) unlike
+  // erase but the last row changes place
+  void swapRemove(uint32_t index) {
+    assert(index < size());
+    const size_t row_stride = m_shape.getStride(0);
+    const size_t last = size() - 1;
+    if (index != last) {
+      T *ptr = m_data.data();
+      std::copy(ptr + last * row_stride, ptr + (last + 1) * row_stride,
+                ptr + index * row_stride);
+      widenZone(index, HasZoneMap{});
+    }
+    resizeRows(last);
+    updateZones(last);
+  }
+
+  // Keeps rows rows[0] < rows[1] < ... < rows[n - 1] in place and drops the
+  // others, in one pass over the buffer
+  void keepRows(const uint32_t *rows, size_t n) {
+    assert(n <= size());
+    const size_t row_stride = m_shape.getStride(0);
+    T *ptr = m_data.data();
+    size_t first_moved = n;
+    for (size_t i = 0; i < n; ++i) {
+      assert(rows[i] >= i && (i == 0 || rows[i] > rows[i - 1]));
+      if (rows[i] != i) {
+        first_moved = std::min(first_moved, i);
+        std::copy(ptr + rows[i] * row_stride, ptr + (rows[i] + 1) * row_stride,
+                  ptr + i * row_stride);
+      }
+    }
+    resizeRows(n);
+    updateZones(first_moved);
+  }
+
+  // Reorders the rows, row i becomes row order[i] of the rows before
+  void permute(const std::vector<uint32_t> &order) {
+    assert(order.size() == size());
+    const size_t row_stride = m_shape.getStride(0);
+    const std::vector<T> source(m_data.data(), m_data.data() + m_data.size());
+    gatherIndexedRows(source.data(), order.data(), order.size(), row_stride,
+                      m_data.data());
+    updateZones(0);
   }
 
   void clear() {
     m_shape.setShape(0, 0);
     m_data.clear();
+    m_zones.clear();
   }
 
   // TODO tensorize
   void insert(uint32_t idx, const T_ &val) {
     m_data.insert(m_data.begin() + idx, val);
+    updateZones(idx);
   }
 
   template<class U>
@@ -249,8 +499,9 @@ template <class T_> struct DataTableStorage {
     if (m_data.empty()) {
       resizeSubarray(input_view.getShape());
     }
-    mt::Tensor<T, storage_dim> storage_view = this->data();
+    mt::Tensor<T, storage_dim> storage_view = this->view();
     storage_view[idx] = input_view;
+    widenZone(idx, HasZoneMap{});
   }
 
   /*void assign(uint32_t idx, T_ val)
@@ -264,13 +515,152 @@ template <class T_> struct DataTableStorage {
       input_view.copyTo(storage_view[idx]);
   }*/
 
+  // Drops the zone map like data()
+  BUFFER &buffer() {
+    m_zones_valid = false;
+    return m_data;
+  }
+  const BUFFER &buffer() const { return m_data; }
+
+  // Summarizes every 4096 rows of a scalar column by their min and max so
+  // filters, min and max can skip whole blocks. The zone map is kept up to
+  // date by push_back, append, assign, erase, insert, resize and clear. Writes
+  // through data(), buffer() or the non-const operator[] are not seen, so
+  // those drop the zone map until buildZoneMap is called again.
+  void buildZoneMap() {
+    static_assert(HasZoneMap::value,
+                  "Zone maps need a column of arithmetic scalars");
+    m_zones.clear();
+    m_zones_valid = true;
+    updateZones(0);
+  }
+
+  void dropZoneMap() {
+    m_zones.clear();
+    m_zones_valid = false;
+  }
+
+  // nullptr unless built and up to date
+  const ZoneMap<T> *zoneMap() const {
+    return m_zones_valid ? &m_zones : nullptr;
+  }
+
 private:
-  std::vector<T> m_data;
+  using HasZoneMap =
+      std::integral_constant<bool,
+                             data_dim == 0 && std::is_arithmetic<T>::value>;
+
+  mt::Tensor<T, storage_dim> view(size_t idx = 0) {
+    T *ptr = m_data.data();
+    mt::Shape<storage_dim> out_shape = m_shape;
+    const auto stride = out_shape.getStride(0);
+    ptr += stride * idx;
+    out_shape.setShape(0, out_shape[0] - idx);
+    return mt::Tensor<T, storage_dim>(ptr, out_shape);
+  }
+
+  void resizeRows(size_t size) {
+    m_shape.setShape(0, size);
+    m_data.resize(bufferSize());
+  }
+
+  // Summarizes the rows again from the block holding first_row on
+  void updateZones(size_t first_row) {
+    updateZones(first_row, HasZoneMap{});
+  }
+
+  void updateZones(size_t first_row, std::true_type) {
+    if (m_zones_valid) {
+      m_zones.truncate(first_row);
+      const size_t first = m_zones.size();
+      m_zones.extend(m_data.data() + first, size() - first);
+    }
+  }
+
+  void updateZones(size_t, std::false_type) {}
+
+  void widenZone(size_t idx, std::true_type) {
+    if (m_zones_valid) {
+      m_zones.widen(idx, m_data[idx]);
+    }
+  }
+
+  void widenZone(size_t, std::false_type) {}
+
+  void gatherIndexed(const uint32_t *idx, size_t n, uint8_t *dst,
+                     size_t stride, std::true_type) {
+    const T *src = m_data.data();
+    for (size_t i = 0; i < n; ++i) {
+      if (i + PREFETCH_ROWS < n) {
+        prefetchRow(src + idx[i + PREFETCH_ROWS]);
+      }
+      *reinterpret_cast<T_ *>(dst + i * stride) = src[idx[i]];
+    }
+  }
+
+  // Subarray values are set to views into this storage like copyTo does
+  void gatherIndexed(const uint32_t *idx, size_t n, uint8_t *dst,
+                     size_t stride, std::false_type) {
+    mt::Tensor<T, storage_dim> rows = view();
+    for (size_t i = 0; i < n; ++i) {
+      *reinterpret_cast<T_ *>(dst + i * stride) = rows[idx[i]];
+    }
+  }
+
+  void scatterIndexed(const uint32_t *idx, size_t n, const uint8_t *src,
+                      size_t stride, std::true_type) {
+    T *dst = m_data.data();
+    for (size_t i = 0; i < n; ++i) {
+      if (i + PREFETCH_ROWS < n) {
+        prefetchRow(dst + idx[i + PREFETCH_ROWS]);
+      }
+      dst[idx[i]] = *reinterpret_cast<const T_ *>(src + i * stride);
+      widenZone(idx[i], HasZoneMap{});
+    }
+  }
+
+  void scatterIndexed(const uint32_t *idx, size_t n, const uint8_t *src,
+                      size_t stride, std::false_type) {
+    for (size_t i = 0; i < n; ++i) {
+      assign(idx[i], *reinterpret_cast<const T_ *>(src + i * stride));
+    }
+  }
+
+  void padStride() { padRowStride<T, BUFFER>(m_shape); }
+
+  size_t bufferSize() const { return m_shape[0] * m_shape.getStride(0); }
+
+  BUFFER m_data;
   mt::Shape<storage_dim> m_shape;
+  ZoneMap<T> m_zones;
+  bool m_zones_valid = false;
 };
 
+// The storage used for a member of type T by the default policies,
+// specialized for member types that are not stored as a dense tensor
+template <class T, class E = void> struct ColumnStorage {
+  using type = DataTableStorage<T>;
+};
+
+// Whether data() of a storage holds a column's member values back to back, so
+// begin, end and view can hand out pointers to them. Specialized to false by
+// storages that hold packed, encoded or offset data instead.
+template <class STORAGE> struct HasDenseRows : std::true_type {};
+
+// Whether a storage only grows at its end, so rows can not be assigned or
+// moved in place. Specialized to true by storages that encode rows in sealed
+// blocks.
+template <class STORAGE> struct IsAppendOnly : std::false_type {};
+
+template <bool...> struct BoolPack {};
+
+template <bool... B>
+using AnyTrue = std::integral_constant<
+    bool, !std::is_same<BoolPack<false, B...>, BoolPack<B..., false>>::value>;
+
 template <class... Ts> struct DefaultStoragePolicy {
-  using type = std::tuple<DataTableStorage<Ts>...>;
+  template <class T> using StorageType = typename ColumnStorage<T>::type;
+  using type = std::tuple<StorageType<Ts>...>;
   type m_data;
 
   static type init() { return {}; }
@@ -290,8 +680,72 @@ template <class... Ts> struct DefaultStoragePolicy {
   }
 };
 
+// Every column is 64 byte aligned and padded to a whole number of vector
+// registers, subarray rows are padded to the same boundary
+template <class... Ts> struct AlignedStoragePolicy {
+  template <class T>
+  using StorageType =
+      DataTableStorage<T, AlignedVector<typename DataDimensionality<T>::DType>>;
+  using type = std::tuple<StorageType<Ts>...>;
+  type m_data;
+
+  template <index_t I> auto get() -> decltype(std::get<I>(m_data)) {
+    return std::get<I>(m_data);
+  }
+
+  template <index_t I> auto get() const -> decltype(std::get<I>(m_data)) {
+    return std::get<I>(m_data);
+  }
+};
+
+// All columns share one ColumnArena, reserve sizes a single block for the whole
+// table and the columns are regrown together. Columns must hold trivially
+// copyable types.
+template <class... Ts> struct ArenaStoragePolicy {
+  template <class T>
+  using StorageType =
+      DataTableStorage<T, ArenaBuffer<typename DataDimensionality<T>::DType>>;
+  using type = std::tuple<StorageType<Ts>...>;
+
+  ArenaStoragePolicy() : ArenaStoragePolicy(std::make_shared<ColumnArena>()) {}
+
+  // A copy gets its own arena
+  ArenaStoragePolicy(const ArenaStoragePolicy &other) : ArenaStoragePolicy() {
+    m_data = other.m_data;
+  }
+
+  ArenaStoragePolicy(ArenaStoragePolicy &&) = default;
+
+  ArenaStoragePolicy &operator=(const ArenaStoragePolicy &other) {
+    m_data = other.m_data;
+    return *this;
+  }
+
+  ArenaStoragePolicy &operator=(ArenaStoragePolicy &&) = default;
+
+  template <index_t I> auto get() -> decltype(std::get<I>(std::declval<type &>())) {
+    return std::get<I>(m_data);
+  }
+
+  template <index_t I>
+  auto get() const -> decltype(std::get<I>(std::declval<const type &>())) {
+    return std::get<I>(m_data);
+  }
+
+  const ColumnArena &arena() const { return *m_arena; }
+
+private:
+  explicit ArenaStoragePolicy(std::shared_ptr<ColumnArena> arena)
+      : m_arena(arena),
+        m_data(StorageType<Ts>(typename StorageType<Ts>::Buffer(arena))...) {}
+
+  std::shared_ptr<ColumnArena> m_arena;
+  type m_data;
+};
+
 template <class... Ts> struct SharedPtrStoragePolicy {
-  using type = std::tuple<std::shared_ptr<DataTableStorage<Ts>>...>;
+  template <class T> using StorageType = typename ColumnStorage<T>::type;
+  using type = std::tuple<std::shared_ptr<StorageType<Ts>>...>;
   type m_data;
 
   template <index_t I> auto get() -> decltype(*std::get<I>(m_data)) {
@@ -331,8 +785,8 @@ private:
 };
 } // namespace ext
 
-template <class T> struct ReflectImpl<ext::DataTableStorage<T>, void> {
-  using DataType = ext::DataTableStorage<T>;
+template <class T, class B> struct ReflectImpl<ext::DataTableStorage<T, B>, void> {
+  using DataType = ext::DataTableStorage<T, B>;
   using StorageType = typename DataType::T;
   using this_t = ReflectImpl<DataType, void>;
 
@@ -354,7 +808,7 @@ template <class T> struct ReflectImpl<ext::DataTableStorage<T>, void> {
     auto tensor = data.data();
     const StorageType *ptr = tensor.data();
     const auto shape = data.shape();
-    const size_t size = shape.numElements();
+    const size_t size = shape[0] * shape.getStride(0);
     return TArrayView<const StorageType>(ptr, size);
   }
 
@@ -362,7 +816,7 @@ template <class T> struct ReflectImpl<ext::DataTableStorage<T>, void> {
     auto tensor = data.data();
     StorageType *ptr = tensor.data();
     const auto shape = data.shape();
-    const size_t size = shape.numElements();
+    const size_t size = shape[0] * shape.getStride(0);
     return TArrayView<StorageType>(ptr, size);
   }
 
@@ -0,0 +1,531 @@
+#ifndef CT_EXT_FILTER_HPP
+#define CT_EXT_FILTER_HPP
+#include "BitVector.hpp"
+#include "DataTableStorage.hpp"
+#include "ZoneMap.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        enum class CompareOp
+        {
+            Less,
+            LessEqual,
+            Greater,
+            GreaterEqual,
+            Equal,
+            NotEqual
+        };
+
+        // Ascending row indices of the selected rows
+        using SelectionVector = std::vector<uint32_t>;
+
+        inline SelectionVector toSelection(const BitVector& bits)
+        {
+            SelectionVector selection;
+            selection.reserve(bits.count());
+            bits.forEachSet([&selection](size_t row) { selection.push_back(static_cast<uint32_t>(row)); });
+            return selection;
+        }
+
+        inline BitVector toBitmap(const SelectionVector& selection, size_t size)
+        {
+            BitVector bits(size, false);
+            for (uint32_t row : selection)
+            {
+                bits.set(row, true);
+            }
+            return bits;
+        }
+
+        // The rows an operation applies to: every row, the set bits of a bitmap or the entries of a selection vector.
+        // Converts implicitly, so a function taking a RowSelection also takes a filter result as is. Only a pointer to
+        // the bitmap or vector is kept.
+        class RowSelection
+        {
+          public:
+            RowSelection() = default;
+
+            RowSelection(const BitVector& bits) : m_bits(&bits) {}
+
+            RowSelection(const SelectionVector& rows) : m_rows(&rows) {}
+
+            bool all() const { return m_bits == nullptr && m_rows == nullptr; }
+
+            // Number of selected rows of a column of num_rows rows
+            size_t count(size_t num_rows) const
+            {
+                if (m_bits != nullptr)
+                {
+                    return m_bits->count();
+                }
+                return m_rows != nullptr ? m_rows->size() : num_rows;
+            }
+
+            // Size of the domain forEachRun splits: rows, bitmap words or selection entries
+            size_t numUnits(size_t num_rows) const
+            {
+                if (m_bits != nullptr)
+                {
+                    return m_bits->numWords();
+                }
+                return m_rows != nullptr ? m_rows->size() : num_rows;
+            }
+
+            // Calls fn(begin, end) for every run of consecutive selected rows within units [first, last), the runs of
+            // disjoint unit ranges never overlap so the units can be shared out between threads
+            template <class F>
+            void forEachRun(size_t num_rows, size_t first, size_t last, F&& fn) const
+            {
+                (void)num_rows;
+                if (m_bits != nullptr)
+                {
+                    assert(m_bits->size() == num_rows);
+                    for (size_t word = first; word < last; ++word)
+                    {
+                        uint64_t w = m_bits->words()[word];
+                        while (w != 0)
+                        {
+                            const uint32_t start = detail::countTrailingZeros64(w);
+                            const uint64_t rest = ~(w >> start);
+                            const uint32_t end = rest == 0 ? 64 : start + detail::countTrailingZeros64(rest);
+                            fn(word * 64 + start, word * 64 + end);
+                            w = end == 64 ? 0 : w & (~uint64_t(0) << end);
+                        }
+                    }
+                }
+                else if (m_rows != nullptr)
+                {
+                    const SelectionVector& rows = *m_rows;
+                    size_t i = first;
+                    while (i < last)
+                    {
+                        assert(rows[i] < num_rows);
+                        size_t j = i + 1;
+                        while (j < last && rows[j] == rows[j - 1] + 1)
+                        {
+                            ++j;
+                        }
+                        fn(size_t(rows[i]), size_t(rows[j - 1]) + 1);
+                        i = j;
+                    }
+                }
+                else if (first < last)
+                {
+                    fn(first, last);
+                }
+            }
+
+          private:
+            const BitVector* m_bits = nullptr;
+            const SelectionVector* m_rows = nullptr;
+        };
+
+        namespace detail
+        {
+            template <CompareOp OP>
+            struct Compare;
+
+            template <>
+            struct Compare<CompareOp::Less>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a < b;
+                }
+            };
+
+            template <>
+            struct Compare<CompareOp::LessEqual>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a <= b;
+                }
+            };
+
+            template <>
+            struct Compare<CompareOp::Greater>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a > b;
+                }
+            };
+
+            template <>
+            struct Compare<CompareOp::GreaterEqual>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a >= b;
+                }
+            };
+
+            template <>
+            struct Compare<CompareOp::Equal>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a == b;
+                }
+            };
+
+            template <>
+            struct Compare<CompareOp::NotEqual>
+            {
+                template <class T>
+                static bool apply(const T& a, const T& b)
+                {
+                    return a != b;
+                }
+            };
+
+            // Bit i of the result is values[i] OP value, n <= 64
+            template <CompareOp OP, class T>
+            uint64_t compareWord(const T* values, size_t n, const T& value)
+            {
+                uint64_t mask = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    mask |= uint64_t(Compare<OP>::apply(values[i], value)) << i;
+                }
+                return mask;
+            }
+
+#if defined(__AVX2__)
+            template <CompareOp OP>
+            struct FloatPredicate;
+
+            // Ordered compares are false for NaN like the scalar operators, != is unordered so NaN != x holds
+            template <>
+            struct FloatPredicate<CompareOp::Less>
+            {
+                static constexpr const int value = _CMP_LT_OQ;
+            };
+            template <>
+            struct FloatPredicate<CompareOp::LessEqual>
+            {
+                static constexpr const int value = _CMP_LE_OQ;
+            };
+            template <>
+            struct FloatPredicate<CompareOp::Greater>
+            {
+                static constexpr const int value = _CMP_GT_OQ;
+            };
+            template <>
+            struct FloatPredicate<CompareOp::GreaterEqual>
+            {
+                static constexpr const int value = _CMP_GE_OQ;
+            };
+            template <>
+            struct FloatPredicate<CompareOp::Equal>
+            {
+                static constexpr const int value = _CMP_EQ_OQ;
+            };
+            template <>
+            struct FloatPredicate<CompareOp::NotEqual>
+            {
+                static constexpr const int value = _CMP_NEQ_UQ;
+            };
+
+            template <CompareOp OP>
+            uint64_t compareWord(const float* values, size_t n, const float& value)
+            {
+                if (n != 64)
+                {
+                    return compareWord<OP, float>(values, n, value);
+                }
+                const __m256 rhs = _mm256_set1_ps(value);
+                uint64_t mask = 0;
+                for (size_t j = 0; j < 8; ++j)
+                {
+                    const __m256 cmp = _mm256_cmp_ps(_mm256_loadu_ps(values + j * 8), rhs, FloatPredicate<OP>::value);
+                    mask |= uint64_t(static_cast<uint32_t>(_mm256_movemask_ps(cmp))) << (j * 8);
+                }
+                return mask;
+            }
+
+            // Integer compares only come as == and >, the rest are swapped or negated
+            inline __m256i compareLanes(__m256i a, __m256i b, CompareOp op)
+            {
+                const __m256i ones = _mm256_set1_epi32(-1);
+                switch (op)
+                {
+                case CompareOp::Less:
+                    return _mm256_cmpgt_epi32(b, a);
+                case CompareOp::LessEqual:
+                    return _mm256_xor_si256(_mm256_cmpgt_epi32(a, b), ones);
+                case CompareOp::Greater:
+                    return _mm256_cmpgt_epi32(a, b);
+                case CompareOp::GreaterEqual:
+                    return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), ones);
+                case CompareOp::Equal:
+                    return _mm256_cmpeq_epi32(a, b);
+                case CompareOp::NotEqual:
+                    break;
+                }
+                return _mm256_xor_si256(_mm256_cmpeq_epi32(a, b), ones);
+            }
+
+            template <CompareOp OP>
+            uint64_t compareWord(const int32_t* values, size_t n, const int32_t& value)
+            {
+                if (n != 64)
+                {
+                    return compareWord<OP, int32_t>(values, n, value);
+                }
+                const __m256i rhs = _mm256_set1_epi32(value);
+                uint64_t mask = 0;
+                for (size_t j = 0; j < 8; ++j)
+                {
+                    const __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + j * 8));
+                    const __m256i cmp = compareLanes(lhs, rhs, OP);
+                    mask |= uint64_t(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)))) << (j * 8);
+                }
+                return mask;
+            }
+#endif // __AVX2__
+
+            // Calls fn(row, values + i, count) for runs of at most 64 of the n rows starting at first that each fill
+            // one word of a bitmap, so the caller can store a whole word at once
+            template <class T, class F>
+            void forEachWordRun(const T* values, size_t first, size_t n, F&& fn)
+            {
+                size_t i = 0;
+                while (i < n)
+                {
+                    const size_t row = first + i;
+                    const size_t count = std::min<size_t>(64 - row % 64, n - i);
+                    fn(row, values + i, count);
+                    i += count;
+                }
+            }
+
+            template <class STORAGE, class F>
+            void forEachWordRun(const STORAGE& storage, F&& fn)
+            {
+                static_assert(STORAGE::data_dim == 0, "Filters need a scalar column");
+                storage.forEachChunk([&fn](mt::Tensor<const typename STORAGE::T, 1> chunk, size_t first) {
+                    forEachWordRun(chunk.data(), first, chunk.getShape()[0], fn);
+                });
+            }
+
+            // Ors the mask of count bits for rows [row, row + count) into the bitmap, all within one word
+            inline void storeMask(BitVector& bits, size_t row, size_t count, uint64_t mask)
+            {
+                (void)count;
+                bits.words()[row / 64] |= mask << (row % 64);
+            }
+
+            // Sets the bits of rows [begin, end)
+            inline void setRows(BitVector& bits, size_t begin, size_t end)
+            {
+                uint64_t* words = bits.words();
+                for (; begin < end && begin % 64 != 0; ++begin)
+                {
+                    words[begin / 64] |= uint64_t(1) << (begin % 64);
+                }
+                for (; begin + 64 <= end; begin += 64)
+                {
+                    words[begin / 64] = ~uint64_t(0);
+                }
+                for (; begin < end; ++begin)
+                {
+                    words[begin / 64] |= uint64_t(1) << (begin % 64);
+                }
+            }
+
+            // Which rows of a zone map block can satisfy a predicate
+            enum class ZoneMatch
+            {
+                None,
+                Some,
+                All
+            };
+
+            inline ZoneMatch both(ZoneMatch lhs, ZoneMatch rhs)
+            {
+                if (lhs == ZoneMatch::None || rhs == ZoneMatch::None)
+                {
+                    return ZoneMatch::None;
+                }
+                return lhs == ZoneMatch::All && rhs == ZoneMatch::All ? ZoneMatch::All : ZoneMatch::Some;
+            }
+
+            // A NaN row matches NotEqual only, so blocks with NaNs are never all matches of the other operators
+            template <CompareOp OP, class T>
+            ZoneMatch zoneMatch(const ZoneMap<T>& zones, size_t block, const T& rhs)
+            {
+                const T& lo = zones.min(block);
+                const T& hi = zones.max(block);
+                const bool clean = !zones.hasNan(block);
+                switch (OP)
+                {
+                case CompareOp::Less:
+                    return !(lo < rhs) ? ZoneMatch::None : hi < rhs && clean ? ZoneMatch::All : ZoneMatch::Some;
+                case CompareOp::LessEqual:
+                    return !(lo <= rhs) ? ZoneMatch::None : hi <= rhs && clean ? ZoneMatch::All : ZoneMatch::Some;
+                case CompareOp::Greater:
+                    return !(hi > rhs) ? ZoneMatch::None : lo > rhs && clean ? ZoneMatch::All : ZoneMatch::Some;
+                case CompareOp::GreaterEqual:
+                    return !(hi >= rhs) ? ZoneMatch::None : lo >= rhs && clean ? ZoneMatch::All : ZoneMatch::Some;
+                case CompareOp::Equal:
+                    if (!(lo <= rhs && rhs <= hi))
+                    {
+                        return ZoneMatch::None;
+                    }
+                    return lo == hi && clean ? ZoneMatch::All : ZoneMatch::Some;
+                case CompareOp::NotEqual:
+                    break;
+                }
+                if (rhs < lo || hi < rhs)
+                {
+                    return ZoneMatch::All;
+                }
+                return lo == hi && lo == rhs && clean ? ZoneMatch::None : ZoneMatch::Some;
+            }
+
+            // forEachWordRun over the blocks of the storage's zone map that classify(zones, block) says may hold
+            // matches, blocks where every row matches are set in bits without reading the column. Falls back to every
+            // row if the storage has no zone map.
+            template <class STORAGE, class CLASSIFY, class F>
+            void forEachCandidateRun(const STORAGE& storage, BitVector& bits, const CLASSIFY& classify, F&& fn)
+            {
+                using T = typename STORAGE::T;
+                const ZoneMap<T>* zones = zoneMapOf(storage);
+                if (zones == nullptr)
+                {
+                    forEachWordRun(storage, fn);
+                    return;
+                }
+                const size_t BLOCK_ROWS = ZoneMap<T>::BLOCK_ROWS;
+                storage.forEachChunk([&](mt::Tensor<const T, 1> chunk, size_t first) {
+                    const size_t last = first + chunk.getShape()[0];
+                    for (size_t block = first / BLOCK_ROWS; block * BLOCK_ROWS < last; ++block)
+                    {
+                        const size_t begin = std::max(first, block * BLOCK_ROWS);
+                        const size_t end = std::min(last, (block + 1) * BLOCK_ROWS);
+                        switch (classify(*zones, block))
+                        {
+                        case ZoneMatch::None:
+                            break;
+                        case ZoneMatch::All:
+                            setRows(bits, begin, end);
+                            break;
+                        case ZoneMatch::Some:
+                            forEachWordRun(chunk.data() + (begin - first), begin, end - begin, fn);
+                            break;
+                        }
+                    }
+                });
+            }
+
+            template <CompareOp OP, class STORAGE, class T>
+            BitVector whereImpl(const STORAGE& storage, const T& value)
+            {
+                BitVector bits(storage.size(), false);
+                forEachCandidateRun(
+                    storage,
+                    bits,
+                    [&value](const ZoneMap<T>& zones, size_t block) { return zoneMatch<OP>(zones, block, value); },
+                    [&bits, &value](size_t row, const T* values, size_t count) {
+                        storeMask(bits, row, count, compareWord<OP>(values, count, value));
+                    });
+                return bits;
+            }
+        } // namespace detail
+
+        // Rows where value OP rhs. Full words of 64 rows are compared with AVX2 for float and int32 columns, blocks
+        // ruled in or out by the column's zone map are not read.
+        template <class STORAGE>
+        BitVector where(const STORAGE& storage, CompareOp op, const typename STORAGE::T& rhs)
+        {
+            switch (op)
+            {
+            case CompareOp::Less:
+                return detail::whereImpl<CompareOp::Less>(storage, rhs);
+            case CompareOp::LessEqual:
+                return detail::whereImpl<CompareOp::LessEqual>(storage, rhs);
+            case CompareOp::Greater:
+                return detail::whereImpl<CompareOp::Greater>(storage, rhs);
+            case CompareOp::GreaterEqual:
+                return detail::whereImpl<CompareOp::GreaterEqual>(storage, rhs);
+            case CompareOp::Equal:
+                return detail::whereImpl<CompareOp::Equal>(storage, rhs);
+            case CompareOp::NotEqual:
+                break;
+            }
+            return detail::whereImpl<CompareOp::NotEqual>(storage, rhs);
+        }
+
+        // Rows where lo <= value <= hi, both bounds are evaluated per word and combined before the store
+        template <class STORAGE>
+        BitVector whereBetween(const STORAGE& storage, const typename STORAGE::T& lo, const typename STORAGE::T& hi)
+        {
+            using T = typename STORAGE::T;
+            BitVector bits(storage.size(), false);
+            auto classify = [&lo, &hi](const ZoneMap<T>& zones, size_t block) {
+                return detail::both(detail::zoneMatch<CompareOp::GreaterEqual>(zones, block, lo),
+                                    detail::zoneMatch<CompareOp::LessEqual>(zones, block, hi));
+            };
+            detail::forEachCandidateRun(storage, bits, classify, [&](size_t row, const T* values, size_t count) {
+                const uint64_t mask = detail::compareWord<CompareOp::GreaterEqual>(values, count, lo) &
+                                      detail::compareWord<CompareOp::LessEqual>(values, count, hi);
+                detail::storeMask(bits, row, count, mask);
+            });
+            return bits;
+        }
+
+        // Rows whose value is one of set. Small sets are or'ed equality masks, large sets are binary searched.
+        template <class STORAGE>
+        BitVector whereIn(const STORAGE& storage, std::vector<typename STORAGE::T> set)
+        {
+            using T = typename STORAGE::T;
+            std::sort(set.begin(), set.end());
+            set.erase(std::unique(set.begin(), set.end()), set.end());
+            BitVector bits(storage.size(), false);
+            // A block may match if a key of the set lies within its bounds
+            auto classify = [&set](const ZoneMap<T>& zones, size_t block) {
+                const auto key = std::lower_bound(set.begin(), set.end(), zones.min(block));
+                return key != set.end() && !(zones.max(block) < *key) ? detail::ZoneMatch::Some
+                                                                      : detail::ZoneMatch::None;
+            };
+            detail::forEachCandidateRun(storage, bits, classify, [&](size_t row, const T* values, size_t count) {
+                uint64_t mask = 0;
+                if (set.size() <= 8)
+                {
+                    for (const T& key : set)
+                    {
+                        mask |= detail::compareWord<CompareOp::Equal>(values, count, key);
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        mask |= uint64_t(std::binary_search(set.begin(), set.end(), values[i])) << i;
+                    }
+                }
+                detail::storeMask(bits, row, count, mask);
+            });
+            return bits;
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_FILTER_HPP
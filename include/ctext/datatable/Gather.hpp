@@ -0,0 +1,150 @@
+#ifndef CT_EXT_GATHER_HPP
+#define CT_EXT_GATHER_HPP
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Column wise gather, scatter and removal by row index. Storages with gather, scatter, appendRows,
+        // swapRemove or keepRows members move rows straight within and between buffers, the others go through
+        // copyTo, assign, append and erase.
+        namespace detail
+        {
+            template <class STORAGE, class T_>
+            auto gatherColumn(STORAGE& storage, const uint32_t* idx, size_t n, T_* first, size_t stride, int)
+                -> decltype(storage.gather(idx, n, first, stride))
+            {
+                return storage.gather(idx, n, first, stride);
+            }
+
+            // One copyTo per run of consecutive indices, so a sorted selection is copied a run at a time
+            template <class STORAGE, class T_>
+            void gatherColumn(STORAGE& storage, const uint32_t* idx, size_t n, T_* first, size_t stride, long)
+            {
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t begin = 0; begin < n;)
+                {
+                    size_t end = begin + 1;
+                    while (end < n && idx[end] == idx[end - 1] + 1)
+                    {
+                        ++end;
+                    }
+                    storage.copyTo(reinterpret_cast<T_*>(dst + begin * stride), end - begin, stride, idx[begin]);
+                    begin = end;
+                }
+            }
+
+            // Writes rows idx[0], ..., idx[n - 1] of a column to n values spaced stride bytes apart
+            template <class STORAGE, class T_>
+            void gatherColumn(STORAGE& storage, const uint32_t* idx, size_t n, T_* first, size_t stride = sizeof(T_))
+            {
+                gatherColumn(storage, idx, n, first, stride, 0);
+            }
+
+            template <class STORAGE, class T_>
+            auto scatterColumn(STORAGE& storage, const uint32_t* idx, size_t n, const T_* first, size_t stride, int)
+                -> decltype(storage.scatter(idx, n, first, stride))
+            {
+                return storage.scatter(idx, n, first, stride);
+            }
+
+            template <class STORAGE, class T_>
+            void scatterColumn(STORAGE& storage, const uint32_t* idx, size_t n, const T_* first, size_t stride, long)
+            {
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    storage.assign(idx[i], *reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            // Assigns n values spaced stride bytes apart to rows idx[0], ..., idx[n - 1] of a column, the column
+            // must support assign
+            template <class STORAGE, class T_>
+            void scatterColumn(STORAGE& storage, const uint32_t* idx, size_t n, const T_* first,
+                               size_t stride = sizeof(T_))
+            {
+                scatterColumn(storage, idx, n, first, stride, 0);
+            }
+
+            template <class MEMBER, class STORAGE>
+            auto appendColumnRows(STORAGE& dst, STORAGE& src, const uint32_t* idx, size_t n, int)
+                -> decltype(dst.appendRows(src, idx, n))
+            {
+                return dst.appendRows(src, idx, n);
+            }
+
+            template <class MEMBER, class STORAGE>
+            void appendColumnRows(STORAGE& dst, STORAGE& src, const uint32_t* idx, size_t n, long)
+            {
+                std::unique_ptr<MEMBER[]> values(new MEMBER[n]);
+                gatherColumn(src, idx, n, values.get());
+                dst.append(values.get(), n);
+            }
+
+            // Appends rows idx[0], ..., idx[n - 1] of src to dst
+            template <class MEMBER, class STORAGE>
+            void appendColumnRows(STORAGE& dst, STORAGE& src, const uint32_t* idx, size_t n)
+            {
+                if (n != 0)
+                {
+                    appendColumnRows<MEMBER>(dst, src, idx, n, 0);
+                }
+            }
+
+            template <class MEMBER, class STORAGE>
+            auto swapRemoveColumn(STORAGE& storage, uint32_t index, int) -> decltype(storage.swapRemove(index))
+            {
+                return storage.swapRemove(index);
+            }
+
+            template <class MEMBER, class STORAGE>
+            void swapRemoveColumn(STORAGE& storage, uint32_t index, long)
+            {
+                const uint32_t last = static_cast<uint32_t>(storage.size() - 1);
+                if (index != last)
+                {
+                    MEMBER value;
+                    storage.copyTo(&value, 1, sizeof(MEMBER), last);
+                    storage.assign(index, value);
+                }
+                storage.erase(last);
+            }
+
+            // Moves the last row of a column into row index and drops the last row, the column must support assign
+            template <class MEMBER, class STORAGE>
+            void swapRemoveColumn(STORAGE& storage, uint32_t index)
+            {
+                assert(index < storage.size());
+                swapRemoveColumn<MEMBER>(storage, index, 0);
+            }
+
+            template <class MEMBER, class STORAGE>
+            auto keepColumnRows(STORAGE& storage, const uint32_t* rows, size_t n, int)
+                -> decltype(storage.keepRows(rows, n))
+            {
+                return storage.keepRows(rows, n);
+            }
+
+            template <class MEMBER, class STORAGE>
+            void keepColumnRows(STORAGE& storage, const uint32_t* rows, size_t n, long)
+            {
+                STORAGE source = storage;
+                storage.clear();
+                appendColumnRows<MEMBER>(storage, source, rows, n);
+            }
+
+            // Keeps the ascending rows of a column and drops the others
+            template <class MEMBER, class STORAGE>
+            void keepColumnRows(STORAGE& storage, const uint32_t* rows, size_t n)
+            {
+                keepColumnRows<MEMBER>(storage, rows, n, 0);
+            }
+        } // namespace detail
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_GATHER_HPP
@@ -0,0 +1,433 @@
+#ifndef CT_EXT_GROUP_BY_HPP
+#define CT_EXT_GROUP_BY_HPP
+#include "../DataTable.hpp"
+#include "Aggregate.hpp"
+#include "HashTable.hpp"
+
+#include <ct/reflect.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Aggregate specifications for GroupBy::aggregate, e.g. agg::sum(&U::val)
+        namespace agg
+        {
+            template <class T, class U>
+            struct Sum
+            {
+                T U::*mem_ptr;
+            };
+
+            struct Count
+            {
+            };
+
+            template <class T, class U>
+            struct Mean
+            {
+                T U::*mem_ptr;
+            };
+
+            template <class T, class U>
+            struct Min
+            {
+                T U::*mem_ptr;
+            };
+
+            template <class T, class U>
+            struct Max
+            {
+                T U::*mem_ptr;
+            };
+
+            template <class T, class U>
+            Sum<T, U> sum(T U::*mem_ptr)
+            {
+                return Sum<T, U>{mem_ptr};
+            }
+
+            inline Count count() { return Count{}; }
+
+            template <class T, class U>
+            Mean<T, U> mean(T U::*mem_ptr)
+            {
+                return Mean<T, U>{mem_ptr};
+            }
+
+            template <class T, class U>
+            Min<T, U> min(T U::*mem_ptr)
+            {
+                return Min<T, U>{mem_ptr};
+            }
+
+            template <class T, class U>
+            Max<T, U> max(T U::*mem_ptr)
+            {
+                return Max<T, U>{mem_ptr};
+            }
+        } // namespace agg
+
+        namespace detail
+        {
+            // Rows reordered by hash partition with the group of each row. Group ids are dense and the groups of a
+            // partition are consecutive, so partitions can be aggregated in parallel without sharing state.
+            template <class K>
+            struct GroupAssignment
+            {
+                // Position of each row in partition order, empty if the rows were not partitioned
+                std::vector<uint32_t> positions;
+                // Group of each row in partition order
+                std::vector<uint32_t> groups;
+                // Rows [partitions[p], partitions[p + 1]) of the partition order belong to partition p
+                std::vector<size_t> partitions;
+                // Key of each group
+                std::vector<K> keys;
+
+                // Moves a column into partition order. The rows are read in order and written to one stream per
+                // partition, which is far cheaper than reading the rows of a partition at random.
+                template <class V>
+                std::vector<V> reorder(std::vector<V> values) const
+                {
+                    if (positions.empty())
+                    {
+                        return values;
+                    }
+                    std::vector<V> out(values.size());
+                    for (size_t row = 0; row < values.size(); ++row)
+                    {
+                        out[positions[row]] = values[row];
+                    }
+                    return out;
+                }
+
+                // Copy of a scalar column in partition order
+                template <class STORAGE>
+                std::vector<typename STORAGE::T> gather(const STORAGE& storage) const
+                {
+                    if (positions.empty())
+                    {
+                        return columnValues(storage);
+                    }
+                    size_t dim = 0;
+                    std::vector<typename STORAGE::T> out(storage.size());
+                    for (const ColumnBlock<typename STORAGE::T>& block : columnBlocks(storage, dim))
+                    {
+                        for (size_t i = 0; i < block.rows; ++i)
+                        {
+                            out[positions[block.first + i]] = block.data[i];
+                        }
+                    }
+                    return out;
+                }
+            };
+
+            // Group of the rows in dead, which form no group of their own and are left out of the results
+            constexpr uint32_t DEAD_GROUP = std::numeric_limits<uint32_t>::max();
+
+            // dead flags the rows to leave out, such as tombstoned rows, and is empty if every row counts. Once all
+            // groups are known the dead rows of partition p are put in group keys.size() + p, so the aggregators need
+            // one extra group per partition. Partitions are aggregated in parallel and must not share a group.
+            template <class K>
+            GroupAssignment<K> assignGroups(std::vector<K> keys, size_t num_threads, std::vector<uint8_t> dead = {})
+            {
+                GroupAssignment<K> out;
+                const size_t num_rows = keys.size();
+                const uint32_t bits = partitionBits(num_rows, num_threads);
+                const size_t num_partitions = size_t(1) << bits;
+                out.positions = hashPartition(keys, bits, out.partitions);
+                keys = out.reorder(std::move(keys));
+                if (!dead.empty())
+                {
+                    dead = out.reorder(std::move(dead));
+                }
+
+                out.groups.resize(num_rows);
+                std::vector<std::vector<K>> partition_keys(num_partitions);
+                parallelFor(num_partitions, num_threads, [&](size_t p) {
+                    const size_t begin = out.partitions[p];
+                    const size_t end = out.partitions[p + 1];
+                    // Sized for a quarter of the rows being distinct, enough to rarely rehash
+                    KeyHashTable<K> table((end - begin) / 4);
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        out.groups[i] = !dead.empty() && dead[i] != 0 ? DEAD_GROUP : table.insert(keys[i]);
+                    }
+                    partition_keys[p] = table.keys();
+                });
+                std::vector<uint32_t> base(num_partitions, 0);
+                for (size_t p = 0; p < num_partitions; ++p)
+                {
+                    base[p] = static_cast<uint32_t>(out.keys.size());
+                    out.keys.insert(out.keys.end(), partition_keys[p].begin(), partition_keys[p].end());
+                }
+                for (size_t p = 0; p < num_partitions; ++p)
+                {
+                    const uint32_t dead_group = static_cast<uint32_t>(out.keys.size() + p);
+                    for (size_t i = out.partitions[p]; i < out.partitions[p + 1]; ++i)
+                    {
+                        out.groups[i] = out.groups[i] == DEAD_GROUP ? dead_group : out.groups[i] + base[p];
+                    }
+                }
+                return out;
+            }
+
+            // Per group state of one aggregate over a column in partition order, add() folds values[first + i] into
+            // groups[i]
+            template <class TABLE, class SPEC>
+            class GroupAggregator;
+
+            template <class TABLE, class T, class U>
+            class GroupAggregator<TABLE, agg::Sum<T, U>>
+            {
+              public:
+                using Value = typename TABLE::template StorageType<T>::T;
+                using Result = SumType<Value>;
+
+                template <class K>
+                GroupAggregator(const TABLE& table, agg::Sum<T, U> spec, const GroupAssignment<K>& groups)
+                    : m_values(groups.gather(table.storage(spec.mem_ptr)))
+                {
+                }
+
+                void resize(size_t num_groups) { m_sums.assign(num_groups, Result(0)); }
+
+                void add(size_t first, const uint32_t* groups, size_t n)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        m_sums[groups[i]] += static_cast<Result>(m_values[first + i]);
+                    }
+                }
+
+                Result result(size_t group) const { return m_sums[group]; }
+
+              private:
+                std::vector<Value> m_values;
+                std::vector<Result> m_sums;
+            };
+
+            template <class TABLE>
+            class GroupAggregator<TABLE, agg::Count>
+            {
+              public:
+                template <class K>
+                GroupAggregator(const TABLE&, agg::Count, const GroupAssignment<K>&)
+                {
+                }
+
+                void resize(size_t num_groups) { m_counts.assign(num_groups, 0); }
+
+                void add(size_t, const uint32_t* groups, size_t n)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        ++m_counts[groups[i]];
+                    }
+                }
+
+                uint64_t result(size_t group) const { return m_counts[group]; }
+
+              private:
+                std::vector<uint64_t> m_counts;
+            };
+
+            template <class TABLE, class T, class U>
+            class GroupAggregator<TABLE, agg::Mean<T, U>>
+            {
+              public:
+                using Value = typename TABLE::template StorageType<T>::T;
+
+                template <class K>
+                GroupAggregator(const TABLE& table, agg::Mean<T, U> spec, const GroupAssignment<K>& groups)
+                    : m_values(groups.gather(table.storage(spec.mem_ptr)))
+                {
+                }
+
+                void resize(size_t num_groups)
+                {
+                    m_sums.assign(num_groups, 0.0);
+                    m_counts.assign(num_groups, 0);
+                }
+
+                void add(size_t first, const uint32_t* groups, size_t n)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        m_sums[groups[i]] += static_cast<double>(m_values[first + i]);
+                        ++m_counts[groups[i]];
+                    }
+                }
+
+                double result(size_t group) const { return m_sums[group] / static_cast<double>(m_counts[group]); }
+
+              private:
+                std::vector<Value> m_values;
+                std::vector<double> m_sums;
+                std::vector<uint64_t> m_counts;
+            };
+
+            // NaNs never compare better so they are skipped as in minimum() and maximum()
+            template <class TABLE, class OP, class T, class U>
+            class ExtremumGroupAggregator
+            {
+              public:
+                using Value = typename TABLE::template StorageType<T>::T;
+
+                template <class K>
+                ExtremumGroupAggregator(const TABLE& table, T U::*mem_ptr, const GroupAssignment<K>& groups)
+                    : m_values(groups.gather(table.storage(mem_ptr)))
+                {
+                }
+
+                void resize(size_t num_groups) { m_best.assign(num_groups, OP::template identity<Value>()); }
+
+                void add(size_t first, const uint32_t* groups, size_t n)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        const Value& value = m_values[first + i];
+                        if (OP::better(value, m_best[groups[i]]))
+                        {
+                            m_best[groups[i]] = value;
+                        }
+                    }
+                }
+
+                Value result(size_t group) const { return m_best[group]; }
+
+              private:
+                std::vector<Value> m_values;
+                std::vector<Value> m_best;
+            };
+
+            template <class TABLE, class T, class U>
+            class GroupAggregator<TABLE, agg::Min<T, U>> : public ExtremumGroupAggregator<TABLE, MinOp, T, U>
+            {
+              public:
+                template <class K>
+                GroupAggregator(const TABLE& table, agg::Min<T, U> spec, const GroupAssignment<K>& groups)
+                    : ExtremumGroupAggregator<TABLE, MinOp, T, U>(table, spec.mem_ptr, groups)
+                {
+                }
+            };
+
+            template <class TABLE, class T, class U>
+            class GroupAggregator<TABLE, agg::Max<T, U>> : public ExtremumGroupAggregator<TABLE, MaxOp, T, U>
+            {
+              public:
+                template <class K>
+                GroupAggregator(const TABLE& table, agg::Max<T, U> spec, const GroupAssignment<K>& groups)
+                    : ExtremumGroupAggregator<TABLE, MaxOp, T, U>(table, spec.mem_ptr, groups)
+                {
+                }
+            };
+
+            template <class R, index_t I, class V>
+            void setMember(R& row, Indexer<I> idx, const V& value)
+            {
+                const auto accessor = Reflect<R>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(row))>::type;
+                accessor.set(row, static_cast<Member>(value));
+            }
+
+            template <class R, class AGGREGATORS, size_t... I>
+            void setResults(R& row, const AGGREGATORS& aggregators, size_t group, std::index_sequence<I...>)
+            {
+                const int expand[] = {0,
+                                      (setMember(row,
+                                                 Indexer<static_cast<index_t>(I) + 1>(),
+                                                 std::get<I>(aggregators).result(group)),
+                                       0)...};
+                (void)expand;
+            }
+
+            template <class AGGREGATORS, size_t... I>
+            void resizeAggregators(AGGREGATORS& aggregators, size_t num_groups, std::index_sequence<I...>)
+            {
+                const int expand[] = {0, (std::get<I>(aggregators).resize(num_groups), 0)...};
+                (void)expand;
+            }
+
+            template <class AGGREGATORS, size_t... I>
+            void addToAggregators(AGGREGATORS& aggregators, size_t first, const uint32_t* groups, size_t n,
+                                  std::index_sequence<I...>)
+            {
+                const int expand[] = {0, (std::get<I>(aggregators).add(first, groups, n), 0)...};
+                (void)expand;
+            }
+        } // namespace detail
+
+        // Hash group-by over a scalar key column, created by DataTable::groupBy. The key column is hashed once,
+        // large tables are radix partitioned by hash and each partition is grouped with its own open addressing table
+        // and aggregated column by column, partitions run in parallel with num_threads > 1.
+        template <class TABLE, class U, class K>
+        class GroupBy
+        {
+          public:
+            using Key = typename TABLE::template StorageType<K>::T;
+
+            GroupBy(const TABLE& table, K U::*key, size_t num_threads)
+                : m_table(table), m_key(key), m_num_threads(num_threads)
+            {
+            }
+
+            // One row of R per distinct key: R's first member receives the key and the following members the
+            // aggregates in order, e.g. aggregate<R>(agg::sum(&U::val), agg::count()) for struct R {key, sum, count}.
+            // Groups are ordered by first occurrence within each hash partition.
+            template <class R, class... SPECS>
+            DataTable<R> aggregate(SPECS... specs) const
+            {
+                static_assert(std::is_same<typename std::decay<decltype(Reflect<R>::end())>::type,
+                                           Indexer<static_cast<index_t>(sizeof...(SPECS))>>::value,
+                              "R needs a member for the key followed by one member per aggregate");
+                // Tombstoned rows are folded into one extra group per partition, these are not returned
+                std::vector<uint8_t> dead;
+                if (m_table.numTombstones() != 0)
+                {
+                    dead.resize(m_table.size());
+                    for (size_t row = 0; row < dead.size(); ++row)
+                    {
+                        dead[row] = m_table.isTombstone(row) ? 1 : 0;
+                    }
+                }
+                const detail::GroupAssignment<Key> groups =
+                    detail::assignGroups(detail::columnValues(m_table.storage(m_key)), m_num_threads, std::move(dead));
+                const size_t num_groups = groups.keys.size();
+                using Aggregators = std::tuple<detail::GroupAggregator<TABLE, SPECS>...>;
+                using Indices = std::index_sequence_for<SPECS...>;
+                Aggregators aggregators(detail::GroupAggregator<TABLE, SPECS>(m_table, specs, groups)...);
+                detail::resizeAggregators(aggregators, num_groups + groups.partitions.size() - 1, Indices());
+                detail::parallelFor(groups.partitions.size() - 1, m_num_threads, [&](size_t p) {
+                    const size_t begin = groups.partitions[p];
+                    detail::addToAggregators(aggregators,
+                                             begin,
+                                             groups.groups.data() + begin,
+                                             groups.partitions[p + 1] - begin,
+                                             Indices());
+                });
+                std::vector<R> rows(num_groups);
+                for (size_t group = 0; group < num_groups; ++group)
+                {
+                    detail::setMember(rows[group], Indexer<0>(), groups.keys[group]);
+                    detail::setResults(rows[group], aggregators, group, Indices());
+                }
+                return DataTable<R>(rows);
+            }
+
+          private:
+            const TABLE& m_table;
+            K U::*m_key;
+            size_t m_num_threads;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_GROUP_BY_HPP
@@ -0,0 +1,219 @@
+#ifndef CT_EXT_HASH_TABLE_HPP
+#define CT_EXT_HASH_TABLE_HPP
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        namespace detail
+        {
+            // splitmix64 finalizer, spreads consecutive integer keys over all bits
+            inline uint64_t mixHash(uint64_t x)
+            {
+                x ^= x >> 30;
+                x *= 0xbf58476d1ce4e5b9ull;
+                x ^= x >> 27;
+                x *= 0x94d049bb133111ebull;
+                return x ^ (x >> 31);
+            }
+
+            template <class K, class E = void>
+            struct KeyTraits
+            {
+                static uint64_t hash(const K& key) { return mixHash(static_cast<uint64_t>(key)); }
+
+                static bool equal(const K& lhs, const K& rhs) { return lhs == rhs; }
+            };
+
+            // Floating point keys compare by bit pattern with -0 folded onto 0, so all NaNs with the same payload
+            // form one key instead of one per row
+            template <class K>
+            struct KeyTraits<K, typename std::enable_if<std::is_floating_point<K>::value>::type>
+            {
+                static uint64_t hash(const K& key) { return mixHash(bits(key)); }
+
+                static bool equal(const K& lhs, const K& rhs) { return bits(lhs) == bits(rhs); }
+
+                static uint64_t bits(K key)
+                {
+                    if (key == K(0))
+                    {
+                        key = K(0);
+                    }
+                    uint64_t out = 0;
+                    std::memcpy(&out, &key, sizeof(K));
+                    return out;
+                }
+            };
+
+            template <class K>
+            uint64_t hashKey(const K& key)
+            {
+                return KeyTraits<K>::hash(key);
+            }
+
+            // Radix partitioning splits the rows by the top bits of their hash so that each partition's hash table
+            // stays in cache, a partition is aimed at ~32k rows. With threads the partitions are the unit of work.
+            inline uint32_t partitionBits(size_t num_rows, size_t num_threads)
+            {
+                uint32_t bits = 0;
+                while (bits < 8 && (num_rows >> bits) > 32768)
+                {
+                    ++bits;
+                }
+                while (num_threads > 1 && bits < 8 && (size_t(1) << bits) < num_threads * 4 &&
+                       (num_rows >> bits) > 1024)
+                {
+                    ++bits;
+                }
+                return bits;
+            }
+
+            // Position of each key when the keys are stably ordered by the top bits of their hash, partition p covers
+            // positions [offsets[p], offsets[p + 1]). Returns no positions if bits is 0. Hashes are recomputed rather
+            // than stored, a pass over the keys is cheaper than writing and reading back eight bytes per row.
+            template <class K>
+            std::vector<uint32_t> hashPartition(const std::vector<K>& keys, uint32_t bits, std::vector<size_t>& offsets)
+            {
+                const size_t num_partitions = size_t(1) << bits;
+                offsets.assign(num_partitions + 1, 0);
+                if (bits == 0)
+                {
+                    offsets[1] = keys.size();
+                    return {};
+                }
+                for (const K& key : keys)
+                {
+                    ++offsets[(hashKey(key) >> (64 - bits)) + 1];
+                }
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+                std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+                std::vector<uint32_t> positions(keys.size());
+                for (size_t row = 0; row < keys.size(); ++row)
+                {
+                    positions[row] = static_cast<uint32_t>(cursor[hashKey(keys[row]) >> (64 - bits)]++);
+                }
+                return positions;
+            }
+        } // namespace detail
+
+        // Open addressing hash table assigning dense ids to keys in insertion order, the keys live in a flat array
+        // indexed by id. Each slot packs the upper 32 bits of the hash next to the id so most probes are settled
+        // without touching the key array.
+        template <class K>
+        class KeyHashTable
+        {
+          public:
+            enum : uint32_t
+            {
+                NOT_FOUND = ~uint32_t(0)
+            };
+
+            explicit KeyHashTable(size_t expected_keys = 0) { reserve(expected_keys); }
+
+            void reserve(size_t num_keys)
+            {
+                size_t num_slots = 16;
+                while (num_slots < num_keys * 2)
+                {
+                    num_slots *= 2;
+                }
+                if (num_slots > m_slots.size())
+                {
+                    rehash(num_slots);
+                }
+                m_keys.reserve(num_keys);
+            }
+
+            // Id of key, NOT_FOUND if it has not been inserted
+            uint32_t find(const K& key) const
+            {
+                const uint64_t hash = detail::hashKey(key);
+                if (m_slots.empty())
+                {
+                    return NOT_FOUND;
+                }
+                const size_t mask = m_slots.size() - 1;
+                const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+                for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+                {
+                    const Slot& entry = m_slots[slot];
+                    if (entry.id == NOT_FOUND ||
+                        (entry.tag == tag && detail::KeyTraits<K>::equal(m_keys[entry.id], key)))
+                    {
+                        return entry.id;
+                    }
+                }
+            }
+
+            // Id of key, inserting it with the next id if missing
+            uint32_t insert(const K& key)
+            {
+                const uint64_t hash = detail::hashKey(key);
+                if ((m_keys.size() + 1) * 2 > m_slots.size())
+                {
+                    rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+                }
+                const size_t mask = m_slots.size() - 1;
+                const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+                size_t slot = hash & mask;
+                for (; m_slots[slot].id != NOT_FOUND; slot = (slot + 1) & mask)
+                {
+                    const Slot& entry = m_slots[slot];
+                    if (entry.tag == tag && detail::KeyTraits<K>::equal(m_keys[entry.id], key))
+                    {
+                        return entry.id;
+                    }
+                }
+                const uint32_t id = static_cast<uint32_t>(m_keys.size());
+                m_keys.push_back(key);
+                m_slots[slot] = Slot{tag, id};
+                return id;
+            }
+
+            size_t size() const { return m_keys.size(); }
+
+            const K& key(uint32_t id) const { return m_keys[id]; }
+
+            const std::vector<K>& keys() const { return m_keys; }
+
+            void clear()
+            {
+                m_slots.clear();
+                m_keys.clear();
+            }
+
+          private:
+            struct Slot
+            {
+                uint32_t tag;
+                uint32_t id;
+            };
+
+            void rehash(size_t num_slots)
+            {
+                m_slots.assign(num_slots, Slot{0, uint32_t(NOT_FOUND)});
+                const size_t mask = num_slots - 1;
+                for (uint32_t id = 0; id < m_keys.size(); ++id)
+                {
+                    const uint64_t hash = detail::hashKey(m_keys[id]);
+                    size_t slot = hash & mask;
+                    while (m_slots[slot].id != NOT_FOUND)
+                    {
+                        slot = (slot + 1) & mask;
+                    }
+                    m_slots[slot] = Slot{static_cast<uint32_t>(hash >> 32), id};
+                }
+            }
+
+            std::vector<Slot> m_slots;
+            std::vector<K> m_keys;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_HASH_TABLE_HPP
@@ -110,7 +110,7 @@ template <class DTYPE> struct IDataTable<DTYPE, VariadicTypedef<>> {
 
   template <class T, class U>
   auto end(T U::*mem_ptr) const
-      -> EnableIf<DataDimensionality<T>::value == 0, T *> {
+      -> EnableIf<DataDimensionality<T>::value == 0, const T *> {
     static_assert(std::is_same<U, DTYPE>::value ||
                       IsBase<Base<DTYPE>, Derived<U>>::value,
                   "Mem ptr must derive from DTYPE");
@@ -147,6 +147,10 @@ template <class DTYPE> struct IDataTable<DTYPE, VariadicTypedef<>> {
 
   virtual size_t size() const = 0;
 
+  // Whether row idx is marked deleted and waits for compaction, see
+  // DataTable::tombstone
+  virtual bool isTombstone(size_t) const { return false; }
+
   /**
    * @brief populateData populates a struct DTYPE with the data from element idx
    * in the table
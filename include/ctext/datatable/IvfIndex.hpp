@@ -0,0 +1,514 @@
+#ifndef CT_EXT_IVF_INDEX_HPP
+#define CT_EXT_IVF_INDEX_HPP
+#include "SecondaryIndex.hpp"
+#include "Similarity.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        struct IvfFileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t metric;
+            uint64_t dim;
+            uint64_t num_lists;
+            uint64_t num_rows;
+        };
+
+        static_assert(sizeof(IvfFileHeader) == 40, "IvfFileHeader must be packed");
+
+        // Inverted file index (IVF-Flat) over an embedding column. The rows are clustered around num_lists k-means
+        // centroids and each list keeps a copy of the vectors of its rows back to back. A search scores the query
+        // against the nprobe closest centroids' lists only, trading recall for a scan of roughly nprobe / num_lists
+        // of the column. Row ids follow the table. Declared with DataTable::createIvfIndex the table keeps the index
+        // current on every mutation and retrains it on reindex, compact and permute. A standalone index is kept
+        // current by hand: sync() indexes rows appended since the last build or sync, and update, erase and
+        // swapRemove must be called alongside the table's.
+        class IvfIndex
+        {
+          public:
+            static constexpr const uint32_t VERSION = 1;
+
+            explicit IvfIndex(size_t num_lists = 64, Metric metric = Metric::L2) : m_num_lists(num_lists), m_metric(metric)
+            {
+            }
+
+            // Trains the centroids with k-means on a strided sample of the column, then indexes every row
+            template <class STORAGE>
+            void build(const STORAGE& storage, size_t iterations = 10, size_t max_training_rows = 65536)
+            {
+                size_t dim = 0;
+                const std::vector<detail::EmbeddingBlock> blocks = detail::embeddingBlocks(storage, dim);
+                const size_t num_rows = storage.size();
+                m_dim = dim;
+                m_size = 0;
+                m_lists.assign(std::max<size_t>(1, std::min(m_num_lists, num_rows)), List());
+                const size_t num_lists = m_lists.size();
+                const size_t num_samples = std::max(num_lists, std::min(num_rows, max_training_rows));
+                std::vector<float> samples(num_samples * dim);
+                for (size_t i = 0; i < num_samples && num_rows != 0; ++i)
+                {
+                    const float* values = rowPtr(blocks, i * num_rows / num_samples);
+                    std::copy(values, values + dim, samples.begin() + static_cast<std::ptrdiff_t>(i * dim));
+                }
+                train(samples, num_samples, num_lists, iterations);
+                for (const detail::EmbeddingBlock& block : blocks)
+                {
+                    for (size_t i = 0; i < block.rows; ++i)
+                    {
+                        add(block.data + i * block.stride);
+                    }
+                }
+            }
+
+            // Indexes the rows appended to the column since the last build or sync
+            template <class STORAGE>
+            void sync(const STORAGE& storage)
+            {
+                size_t dim = 0;
+                const std::vector<detail::EmbeddingBlock> blocks = detail::embeddingBlocks(storage, dim);
+                assert(m_centroids.empty() || dim == m_dim);
+                for (size_t row = m_size; row < storage.size(); ++row)
+                {
+                    add(rowPtr(blocks, row));
+                }
+            }
+
+            // Indexes values as the next row, returns its row id
+            size_t add(const float* values)
+            {
+                if (m_centroids.empty())
+                {
+                    throw std::logic_error("IvfIndex must be built before rows are added");
+                }
+                insert(m_size, values);
+                return m_size++;
+            }
+
+            // Reads row of the column again after it was assigned, it moves to the list of its new nearest centroid
+            template <class STORAGE>
+            void update(const STORAGE& storage, size_t row)
+            {
+                assert(row < m_size);
+                size_t dim = 0;
+                const std::vector<detail::EmbeddingBlock> blocks = detail::embeddingBlocks(storage, dim);
+                removeEntry(row);
+                insert(row, rowPtr(blocks, row));
+            }
+
+            // Drops row from the index and gives the last row its id, as DataTable::swapRemove does
+            void swapRemove(size_t row)
+            {
+                assert(row < m_size);
+                removeEntry(row);
+                const size_t last = m_size - 1;
+                for (List& list : m_lists)
+                {
+                    std::replace(list.rows.begin(), list.rows.end(), last, row);
+                }
+                --m_size;
+            }
+
+            // Drops row from the index, the ids of later rows shift down by one as they do in the table
+            void erase(size_t row)
+            {
+                assert(row < m_size);
+                for (List& list : m_lists)
+                {
+                    for (size_t i = 0; i < list.rows.size(); ++i)
+                    {
+                        if (list.rows[i] == row)
+                        {
+                            const size_t last = list.rows.size() - 1;
+                            list.rows[i] = list.rows[last];
+                            std::copy(list.values.begin() + static_cast<std::ptrdiff_t>(last * m_dim),
+                                      list.values.end(), list.values.begin() + static_cast<std::ptrdiff_t>(i * m_dim));
+                            list.rows.pop_back();
+                            list.values.resize(last * m_dim);
+                        }
+                        if (i < list.rows.size() && list.rows[i] > row)
+                        {
+                            --list.rows[i];
+                        }
+                    }
+                }
+                --m_size;
+            }
+
+            // The k best rows among the lists of the nprobe centroids closest to query, best first
+            std::vector<SearchResult> search(const float* query, size_t k, size_t nprobe = 8) const
+            {
+                detail::TopKHeap heap(k, m_metric);
+                if (m_centroids.empty())
+                {
+                    return heap.sorted();
+                }
+                std::vector<std::pair<float, size_t>> order(m_lists.size());
+                for (size_t l = 0; l < m_lists.size(); ++l)
+                {
+                    order[l] = std::make_pair(detail::l2F32(centroid(l), query, m_dim), l);
+                }
+                nprobe = std::min(std::max<size_t>(nprobe, 1), order.size());
+                std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(nprobe), order.end());
+                float query_norm2 = 0.0f;
+                detail::dotNormF32(query, query, m_dim, query_norm2);
+                for (size_t p = 0; p < nprobe; ++p)
+                {
+                    const List& list = m_lists[order[p].second];
+                    for (size_t i = 0; i < list.rows.size(); ++i)
+                    {
+                        heap.push(list.rows[i], score(list.values.data() + i * m_dim, query, query_norm2));
+                    }
+                }
+                return heap.sorted();
+            }
+
+            // Number of indexed rows
+            size_t size() const { return m_size; }
+
+            size_t dim() const { return m_dim; }
+
+            size_t numLists() const { return m_lists.size(); }
+
+            size_t listSize(size_t list) const { return m_lists[list].rows.size(); }
+
+            Metric metric() const { return m_metric; }
+
+            const float* centroid(size_t list) const { return m_centroids.data() + list * m_dim; }
+
+            void save(std::ostream& os) const
+            {
+                IvfFileHeader header;
+                std::memcpy(header.magic, "CTEXTIVF", 8);
+                header.version = VERSION;
+                header.metric = static_cast<uint32_t>(m_metric);
+                header.dim = m_dim;
+                header.num_lists = m_lists.size();
+                header.num_rows = m_size;
+                os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                write(os, m_centroids);
+                for (const List& list : m_lists)
+                {
+                    const uint64_t count = list.rows.size();
+                    os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+                    const std::vector<uint64_t> rows(list.rows.begin(), list.rows.end());
+                    write(os, rows);
+                    write(os, list.values);
+                }
+                if (!os)
+                {
+                    throw std::runtime_error("Failed to write ivf index");
+                }
+            }
+
+            // The index is left unchanged if the file is truncated or corrupt
+            void load(std::istream& is)
+            {
+                IvfFileHeader header;
+                read(is, &header, sizeof(header));
+                if (std::memcmp(header.magic, "CTEXTIVF", 8) != 0)
+                {
+                    throw std::runtime_error("Not an ivf index file");
+                }
+                if (header.version != VERSION)
+                {
+                    throw std::runtime_error("Unsupported ivf index version " + std::to_string(header.version));
+                }
+                if (header.metric > static_cast<uint32_t>(Metric::L2))
+                {
+                    throw std::runtime_error("Unknown ivf index metric " + std::to_string(header.metric));
+                }
+                // Everything is allocated before it is read, so the sizes in the header are checked against the bytes
+                // left in the stream first. Each list stores a centroid and a row count, each row its values and its id.
+                const uint64_t max = std::numeric_limits<uint64_t>::max();
+                const uint64_t entry_bytes = header.dim <= (max - sizeof(uint64_t)) / sizeof(float)
+                                                 ? header.dim * sizeof(float) + sizeof(uint64_t)
+                                                 : 0;
+                if (entry_bytes == 0 || header.num_rows > max - header.num_lists ||
+                    header.num_lists + header.num_rows > max / entry_bytes)
+                {
+                    throw std::runtime_error("Ivf index sizes are out of range");
+                }
+                checkRemaining(is, (header.num_lists + header.num_rows) * entry_bytes);
+                IvfIndex loaded(static_cast<size_t>(header.num_lists), static_cast<Metric>(header.metric));
+                loaded.m_dim = static_cast<size_t>(header.dim);
+                loaded.m_size = static_cast<size_t>(header.num_rows);
+                loaded.m_centroids.resize(loaded.m_num_lists * loaded.m_dim);
+                read(is, loaded.m_centroids.data(), loaded.m_centroids.size() * sizeof(float));
+                loaded.m_lists.assign(loaded.m_num_lists, List());
+                uint64_t num_indexed = 0;
+                for (List& list : loaded.m_lists)
+                {
+                    uint64_t count = 0;
+                    read(is, &count, sizeof(count));
+                    if (count > header.num_rows - num_indexed)
+                    {
+                        throw std::runtime_error("Ivf index lists hold more rows than the index");
+                    }
+                    num_indexed += count;
+                    std::vector<uint64_t> rows(static_cast<size_t>(count));
+                    read(is, rows.data(), rows.size() * sizeof(uint64_t));
+                    for (uint64_t row : rows)
+                    {
+                        if (row >= header.num_rows)
+                        {
+                            throw std::runtime_error("Ivf index row " + std::to_string(row) + " is out of range");
+                        }
+                    }
+                    list.rows.assign(rows.begin(), rows.end());
+                    list.values.resize(rows.size() * loaded.m_dim);
+                    read(is, list.values.data(), list.values.size() * sizeof(float));
+                }
+                if (num_indexed != header.num_rows)
+                {
+                    throw std::runtime_error("Ivf index lists hold fewer rows than the index");
+                }
+                *this = std::move(loaded);
+            }
+
+            void save(const std::string& path) const
+            {
+                std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+                if (!ofs)
+                {
+                    throw std::runtime_error("Unable to open " + path + " for writing");
+                }
+                save(ofs);
+            }
+
+            void load(const std::string& path)
+            {
+                std::ifstream ifs(path, std::ios::binary);
+                if (!ifs)
+                {
+                    throw std::runtime_error("Unable to open " + path + " for reading");
+                }
+                load(ifs);
+            }
+
+          private:
+            struct List
+            {
+                std::vector<size_t> rows;
+                std::vector<float> values;
+            };
+
+            static const float* rowPtr(const std::vector<detail::EmbeddingBlock>& blocks, size_t row)
+            {
+                for (const detail::EmbeddingBlock& block : blocks)
+                {
+                    if (row < block.first + block.rows)
+                    {
+                        return block.data + (row - block.first) * block.stride;
+                    }
+                }
+                return nullptr;
+            }
+
+            template <class V>
+            static void write(std::ostream& os, const std::vector<V>& values)
+            {
+                os.write(reinterpret_cast<const char*>(values.data()),
+                         static_cast<std::streamsize>(values.size() * sizeof(V)));
+            }
+
+            // Throws if the stream is seekable and ends within the next bytes
+            static void checkRemaining(std::istream& is, uint64_t bytes)
+            {
+                const std::istream::pos_type pos = is.tellg();
+                if (pos == std::istream::pos_type(-1) || !is.seekg(0, std::ios::end))
+                {
+                    is.clear();
+                    return;
+                }
+                const std::istream::pos_type end = is.tellg();
+                is.seekg(pos);
+                if (end == std::istream::pos_type(-1) || !is ||
+                    static_cast<uint64_t>(end - pos) < bytes)
+                {
+                    throw std::runtime_error("Ivf index file is truncated");
+                }
+            }
+
+            // Inserts values as row into the list of the nearest centroid
+            void insert(size_t row, const float* values)
+            {
+                List& list = m_lists[nearestCentroid(values)];
+                list.rows.push_back(row);
+                list.values.insert(list.values.end(), values, values + m_dim);
+            }
+
+            // Drops the entry of row, the ids of the other rows are kept
+            void removeEntry(size_t row)
+            {
+                for (List& list : m_lists)
+                {
+                    const auto it = std::find(list.rows.begin(), list.rows.end(), row);
+                    if (it != list.rows.end())
+                    {
+                        const size_t i = static_cast<size_t>(it - list.rows.begin());
+                        const size_t last = list.rows.size() - 1;
+                        list.rows[i] = list.rows[last];
+                        std::copy(list.values.begin() + static_cast<std::ptrdiff_t>(last * m_dim),
+                                  list.values.end(),
+                                  list.values.begin() + static_cast<std::ptrdiff_t>(i * m_dim));
+                        list.rows.pop_back();
+                        list.values.resize(last * m_dim);
+                        return;
+                    }
+                }
+            }
+
+            static void read(std::istream& is, void* dst, size_t bytes)
+            {
+                if (!is.read(static_cast<char*>(dst), static_cast<std::streamsize>(bytes)))
+                {
+                    throw std::runtime_error("Ivf index file is truncated");
+                }
+            }
+
+            float score(const float* values, const float* query, float query_norm2) const
+            {
+                switch (m_metric)
+                {
+                case Metric::Dot:
+                    return detail::dotF32(values, query, m_dim);
+                case Metric::Cosine:
+                {
+                    float norm2 = 0.0f;
+                    const float dot = detail::dotNormF32(values, query, m_dim, norm2);
+                    return detail::cosine(dot, norm2, query_norm2);
+                }
+                case Metric::L2:
+                    break;
+                }
+                return detail::l2F32(values, query, m_dim);
+            }
+
+            size_t nearestCentroid(const float* values) const
+            {
+                size_t best = 0;
+                float best_dist = std::numeric_limits<float>::max();
+                for (size_t l = 0; l < m_lists.size(); ++l)
+                {
+                    const float dist = detail::l2F32(centroid(l), values, m_dim);
+                    if (dist < best_dist)
+                    {
+                        best_dist = dist;
+                        best = l;
+                    }
+                }
+                return best;
+            }
+
+            // Lloyd's k-means seeded with evenly spaced samples, an empty cluster keeps its previous centroid
+            void train(const std::vector<float>& samples, size_t num_samples, size_t num_lists, size_t iterations)
+            {
+                m_centroids.assign(num_lists * m_dim, 0.0f);
+                for (size_t l = 0; l < num_lists && num_samples != 0; ++l)
+                {
+                    const size_t sample = l * num_samples / num_lists;
+                    std::copy(samples.begin() + static_cast<std::ptrdiff_t>(sample * m_dim),
+                              samples.begin() + static_cast<std::ptrdiff_t>((sample + 1) * m_dim),
+                              m_centroids.begin() + static_cast<std::ptrdiff_t>(l * m_dim));
+                }
+                std::vector<float> sums(num_lists * m_dim);
+                std::vector<size_t> counts(num_lists);
+                for (size_t it = 0; it < iterations && num_samples != 0; ++it)
+                {
+                    std::fill(sums.begin(), sums.end(), 0.0f);
+                    std::fill(counts.begin(), counts.end(), 0);
+                    for (size_t i = 0; i < num_samples; ++i)
+                    {
+                        const float* values = samples.data() + i * m_dim;
+                        const size_t l = nearestCentroid(values);
+                        ++counts[l];
+                        for (size_t d = 0; d < m_dim; ++d)
+                        {
+                            sums[l * m_dim + d] += values[d];
+                        }
+                    }
+                    for (size_t l = 0; l < num_lists; ++l)
+                    {
+                        for (size_t d = 0; d < m_dim && counts[l] != 0; ++d)
+                        {
+                            m_centroids[l * m_dim + d] = sums[l * m_dim + d] / static_cast<float>(counts[l]);
+                        }
+                    }
+                }
+            }
+
+            size_t m_num_lists;
+            Metric m_metric;
+            size_t m_dim = 0;
+            size_t m_size = 0;
+            std::vector<float> m_centroids;
+            std::vector<List> m_lists;
+        };
+
+        namespace detail
+        {
+            // An IvfIndex declared on an embedding column, see DataTable::createIvfIndex. Rows are read from the
+            // column, a rebuild retrains the centroids.
+            template <class TABLE, class T>
+            class ColumnIndex<TABLE, T, IvfIndex> : public DeclaredIndex<TABLE>
+            {
+              public:
+                using U = typename TABLE::DType;
+
+                explicit ColumnIndex(T U::*mem_ptr, IvfIndex index = IvfIndex())
+                    : m_mem_ptr(mem_ptr), m_index(std::move(index))
+                {
+                }
+
+                std::unique_ptr<DeclaredIndex<TABLE>> clone() const override
+                {
+                    return std::unique_ptr<DeclaredIndex<TABLE>>(new ColumnIndex(*this));
+                }
+
+                size_t fieldOffset() const override { return memberOffset(m_mem_ptr); }
+
+                // An index declared on an empty table is trained on the first rows appended
+                void sync(const TABLE& table) override
+                {
+                    if (m_index.size() == 0)
+                    {
+                        rebuild(table);
+                        return;
+                    }
+                    m_index.sync(table.storage(m_mem_ptr));
+                }
+
+                void update(const TABLE& table, size_t row) override { m_index.update(table.storage(m_mem_ptr), row); }
+
+                void erase(size_t row) override { m_index.erase(row); }
+
+                void swapRemove(size_t row) override { m_index.swapRemove(row); }
+
+                void rebuild(const TABLE& table) override { m_index.build(table.storage(m_mem_ptr)); }
+
+                const IvfIndex& index() const { return m_index; }
+
+              private:
+                T U::*m_mem_ptr;
+                IvfIndex m_index;
+            };
+        } // namespace detail
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_IVF_INDEX_HPP
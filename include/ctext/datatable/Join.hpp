@@ -0,0 +1,215 @@
+#ifndef CT_EXT_JOIN_HPP
+#define CT_EXT_JOIN_HPP
+#include "Aggregate.hpp"
+#include "HashTable.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        enum class JoinType
+        {
+            Inner,
+            Left
+        };
+
+        // Matching rows of a join, row left[i] of the left table matches row right[i] of the right table. In a left
+        // join a left row without a match pairs with NO_MATCH.
+        struct JoinResult
+        {
+            enum : uint32_t
+            {
+                NO_MATCH = ~uint32_t(0)
+            };
+
+            std::vector<uint32_t> left;
+            std::vector<uint32_t> right;
+
+            size_t size() const { return left.size(); }
+
+            void append(const JoinResult& other)
+            {
+                left.insert(left.end(), other.left.begin(), other.left.end());
+                right.insert(right.end(), other.right.begin(), other.right.end());
+            }
+        };
+
+        namespace detail
+        {
+            // Build side of a hash join: the distinct keys in a KeyHashTable and the rows of each key stored next to
+            // each other, so a probe is one table lookup followed by a contiguous read of the matching rows.
+            template <class K>
+            class JoinBuildTable
+            {
+              public:
+                // rows[i] is the row of keys[i], or first + i if rows is null
+                JoinBuildTable(const K* keys, const uint32_t* rows, size_t first, size_t n) : m_table(n / 4)
+                {
+                    std::vector<uint32_t> ids(n);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        ids[i] = m_table.insert(keys[i]);
+                    }
+                    m_offsets.assign(m_table.size() + 1, 0);
+                    for (uint32_t id : ids)
+                    {
+                        ++m_offsets[id + 1];
+                    }
+                    std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+                    std::vector<uint32_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+                    m_rows.resize(n);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        m_rows[cursor[ids[i]]++] = rows ? rows[i] : static_cast<uint32_t>(first + i);
+                    }
+                }
+
+                // Appends the matches of keys to out. The probe runs in batches, all lookups of a batch are issued
+                // before any output is written so that their cache misses overlap.
+                void probe(const K* keys, const uint32_t* rows, size_t first, size_t n, JoinType type,
+                           JoinResult& out) const
+                {
+                    const size_t BATCH = 256;
+                    uint32_t ids[BATCH];
+                    for (size_t begin = 0; begin < n; begin += BATCH)
+                    {
+                        const size_t count = std::min(BATCH, n - begin);
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            ids[i] = m_table.find(keys[begin + i]);
+                        }
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            const uint32_t row = rows ? rows[begin + i] : static_cast<uint32_t>(first + begin + i);
+                            if (ids[i] == KeyHashTable<K>::NOT_FOUND)
+                            {
+                                if (type == JoinType::Left)
+                                {
+                                    out.left.push_back(row);
+                                    out.right.push_back(JoinResult::NO_MATCH);
+                                }
+                                continue;
+                            }
+                            for (uint32_t j = m_offsets[ids[i]]; j < m_offsets[ids[i] + 1]; ++j)
+                            {
+                                out.left.push_back(row);
+                                out.right.push_back(m_rows[j]);
+                            }
+                        }
+                    }
+                }
+
+              private:
+                KeyHashTable<K> m_table;
+                std::vector<uint32_t> m_offsets;
+                std::vector<uint32_t> m_rows;
+            };
+
+            // Keys and row ids of a scalar column in hash partition order
+            template <class K>
+            struct PartitionedKeys
+            {
+                std::vector<K> keys;
+                std::vector<uint32_t> rows;
+                std::vector<size_t> offsets;
+            };
+
+            template <class STORAGE>
+            PartitionedKeys<typename STORAGE::T> partitionKeys(const STORAGE& storage, uint32_t bits)
+            {
+                PartitionedKeys<typename STORAGE::T> out;
+                const std::vector<typename STORAGE::T> keys = columnValues(storage);
+                const std::vector<uint32_t> positions = hashPartition(keys, bits, out.offsets);
+                out.keys.resize(keys.size());
+                out.rows.resize(keys.size());
+                for (size_t row = 0; row < keys.size(); ++row)
+                {
+                    out.keys[positions[row]] = keys[row];
+                    out.rows[positions[row]] = static_cast<uint32_t>(row);
+                }
+                return out;
+            }
+
+            inline JoinResult concatenate(const std::vector<JoinResult>& parts)
+            {
+                size_t size = 0;
+                for (const JoinResult& part : parts)
+                {
+                    size += part.size();
+                }
+                JoinResult out;
+                out.left.reserve(size);
+                out.right.reserve(size);
+                for (const JoinResult& part : parts)
+                {
+                    out.append(part);
+                }
+                return out;
+            }
+        } // namespace detail
+
+        // Hash join of two scalar key columns on equality, the right column is the build side and is hashed once.
+        // A build side small enough to stay in cache is probed by streaming the left column, split into contiguous
+        // ranges with num_threads > 1, and the pairs come out in left row order. A larger build side is radix
+        // partitioned together with the left column and each pair of partitions is joined on its own, in parallel with
+        // num_threads > 1; the pairs are then ordered by partition and by left row within a partition.
+        template <class LEFT, class RIGHT>
+        JoinResult hashJoin(const LEFT& left, const RIGHT& right, JoinType type = JoinType::Inner,
+                            size_t num_threads = 1)
+        {
+            using K = typename LEFT::T;
+            static_assert(std::is_same<K, typename RIGHT::T>::value, "Join keys must have the same type");
+            static_assert(LEFT::data_dim == 0 && RIGHT::data_dim == 0, "Join keys must be scalar columns");
+            using Span = detail::ColumnBlock<K>;
+            num_threads = std::max<size_t>(1, num_threads);
+            // Build sides up to ~32k rows are not partitioned
+            if (detail::partitionBits(right.size(), 1) == 0)
+            {
+                const std::vector<K> right_keys = detail::columnValues(right);
+                const detail::JoinBuildTable<K> table(right_keys.data(), nullptr, 0, right_keys.size());
+                size_t dim = 0;
+                const std::vector<Span> blocks = detail::columnBlocks(left, dim);
+                const size_t num_rows = left.size();
+                if (num_rows == 0)
+                {
+                    return JoinResult();
+                }
+                const size_t num_tasks = std::min(num_threads, std::max<size_t>(1, num_rows / 4096));
+                std::vector<JoinResult> parts(num_tasks);
+                detail::parallelFor(num_tasks, num_threads, [&](size_t task) {
+                    const size_t begin = task * num_rows / num_tasks;
+                    const size_t end = (task + 1) * num_rows / num_tasks;
+                    detail::forEachSpan(blocks, begin, end, [&](const Span& span) {
+                        table.probe(span.data, nullptr, span.first, span.rows, type, parts[task]);
+                    });
+                });
+                return num_tasks == 1 ? std::move(parts[0]) : detail::concatenate(parts);
+            }
+            const uint32_t bits = detail::partitionBits(right.size(), num_threads);
+            const detail::PartitionedKeys<K> build = detail::partitionKeys(right, bits);
+            const detail::PartitionedKeys<K> probe = detail::partitionKeys(left, bits);
+            const size_t num_partitions = build.offsets.size() - 1;
+            std::vector<JoinResult> parts(num_partitions);
+            detail::parallelFor(num_partitions, num_threads, [&](size_t p) {
+                const size_t begin = build.offsets[p];
+                const detail::JoinBuildTable<K> table(
+                    build.keys.data() + begin, build.rows.data() + begin, 0, build.offsets[p + 1] - begin);
+                const size_t probe_begin = probe.offsets[p];
+                table.probe(probe.keys.data() + probe_begin,
+                            probe.rows.data() + probe_begin,
+                            0,
+                            probe.offsets[p + 1] - probe_begin,
+                            type,
+                            parts[p]);
+            });
+            return detail::concatenate(parts);
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_JOIN_HPP
@@ -0,0 +1,485 @@
+#ifndef CT_EXT_MMAP_STORAGE_HPP
+#define CT_EXT_MMAP_STORAGE_HPP
+#include "../DataTable.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Stored in front of the column data of every mapped column file. Everything needed to rebuild the storage
+        // and to check it against the reflected layout of the row type is recorded here.
+        struct MmapColumnHeader
+        {
+            static constexpr const uint64_t magic_value = 0x4C4F4354584554ULL; // "TEXTCOL"
+            static constexpr const uint32_t current_version = 1;
+            static constexpr const size_t max_dims = 7;
+
+            uint64_t magic;
+            uint32_t version;
+            uint32_t element_size;
+            uint64_t num_bytes;
+            uint64_t field_offset;
+            uint32_t data_dim;
+            uint32_t shape[max_dims];
+            char name[192];
+        };
+
+        static_assert(sizeof(MmapColumnHeader) == 256, "The column header is part of the file format");
+
+        // A read write mapping of a column file, or of anonymous memory when no file is given. The first
+        // header_size bytes hold a MmapColumnHeader, column data follows. Growing the mapping extends the file and
+        // remaps it, the kernel moves the pages so no data is copied on Linux.
+        class MmapRegion
+        {
+          public:
+            static constexpr const size_t header_size = sizeof(MmapColumnHeader);
+
+            MmapRegion() = default;
+
+            explicit MmapRegion(const std::string& path)
+            {
+                m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+                if (m_fd < 0)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+                }
+                struct stat st;
+                if (::fstat(m_fd, &st) != 0)
+                {
+                    fail("Unable to stat " + path);
+                }
+                size_t bytes = static_cast<size_t>(st.st_size);
+                if (bytes < header_size)
+                {
+                    bytes = header_size;
+                    if (::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0)
+                    {
+                        fail("Unable to extend " + path);
+                    }
+                }
+                void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+                if (base == MAP_FAILED)
+                {
+                    fail("Unable to map " + path);
+                }
+                m_base = static_cast<uint8_t*>(base);
+                m_mapped = bytes;
+            }
+
+            MmapRegion(const MmapRegion&) = delete;
+            MmapRegion& operator=(const MmapRegion&) = delete;
+
+            MmapRegion(MmapRegion&& other) noexcept { swap(other); }
+
+            MmapRegion& operator=(MmapRegion&& other) noexcept
+            {
+                MmapRegion tmp(std::move(other));
+                swap(tmp);
+                return *this;
+            }
+
+            // The file is truncated to the used bytes so unused capacity does not linger on disk
+            ~MmapRegion()
+            {
+                const size_t used = m_base ? header_size + header().num_bytes : 0;
+                if (m_base)
+                {
+                    ::munmap(m_base, m_mapped);
+                }
+                if (m_fd >= 0)
+                {
+                    if (used != 0 && ::ftruncate(m_fd, static_cast<off_t>(used)) != 0)
+                    {
+                        // Nothing to recover, the file keeps its capacity
+                    }
+                    ::close(m_fd);
+                }
+            }
+
+            bool isMapped() const { return m_base != nullptr; }
+
+            bool isFileBacked() const { return m_fd >= 0; }
+
+            uint8_t* data() const { return m_base ? m_base + header_size : nullptr; }
+
+            size_t capacity() const { return m_base ? m_mapped - header_size : 0; }
+
+            MmapColumnHeader& header() { return *reinterpret_cast<MmapColumnHeader*>(m_base); }
+            const MmapColumnHeader& header() const { return *reinterpret_cast<const MmapColumnHeader*>(m_base); }
+
+            void reserve(size_t bytes)
+            {
+                if (m_base && bytes <= capacity())
+                {
+                    return;
+                }
+                const size_t cap = std::max(bytes, std::max(2 * capacity(), static_cast<size_t>(4096)));
+                remap(header_size + (cap + CT_EXT_SIMD_ALIGNMENT - 1) / CT_EXT_SIMD_ALIGNMENT * CT_EXT_SIMD_ALIGNMENT);
+            }
+
+            void sync()
+            {
+                if (m_base && m_fd >= 0 && ::msync(m_base, m_mapped, MS_SYNC) != 0)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to sync mapped column");
+                }
+            }
+
+          private:
+            void swap(MmapRegion& other)
+            {
+                std::swap(m_fd, other.m_fd);
+                std::swap(m_base, other.m_base);
+                std::swap(m_mapped, other.m_mapped);
+            }
+
+            [[noreturn]] void fail(const std::string& what)
+            {
+                const int err = errno;
+                if (m_fd >= 0)
+                {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+                throw std::system_error(err, std::generic_category(), what);
+            }
+
+            void remap(size_t bytes)
+            {
+                if (m_fd >= 0 && ::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to extend mapped column");
+                }
+                void* base = MAP_FAILED;
+                if (m_base == nullptr)
+                {
+                    // Anonymous pages start zeroed, which is an empty header
+                    base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                }
+                else
+                {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+                    base = ::mremap(m_base, m_mapped, bytes, MREMAP_MAYMOVE);
+#else
+                    if (m_fd >= 0)
+                    {
+                        ::munmap(m_base, m_mapped);
+                        m_base = nullptr;
+                        base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+                    }
+                    else
+                    {
+                        base =
+                            ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                        if (base != MAP_FAILED)
+                        {
+                            std::memcpy(base, m_base, m_mapped);
+                            ::munmap(m_base, m_mapped);
+                        }
+                    }
+#endif
+                }
+                if (base == MAP_FAILED)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to map column");
+                }
+                m_base = static_cast<uint8_t*>(base);
+                m_mapped = bytes;
+            }
+
+            int m_fd = -1;
+            uint8_t* m_base = nullptr;
+            size_t m_mapped = 0;
+        };
+
+        // Column buffer backed by a MmapRegion, implements the part of the std::vector interface used by
+        // DataTableStorage. A default constructed buffer lives in anonymous memory, a copy always does.
+        template <class T>
+        struct MmapBuffer
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Mapped columns are stored as raw bytes");
+
+            using value_type = T;
+            using iterator = T*;
+            using const_iterator = const T*;
+
+            MmapBuffer() = default;
+
+            explicit MmapBuffer(const std::string& path) : m_region(path) {}
+
+            MmapBuffer(const MmapBuffer& other) { *this = other; }
+
+            MmapBuffer(MmapBuffer&&) = default;
+
+            MmapBuffer& operator=(const MmapBuffer& other)
+            {
+                if (this != &other)
+                {
+                    resize(other.size());
+                    if (!other.empty())
+                    {
+                        std::memcpy(data(), other.data(), other.size() * sizeof(T));
+                    }
+                }
+                return *this;
+            }
+
+            MmapBuffer& operator=(MmapBuffer&&) = default;
+
+            T* data() { return reinterpret_cast<T*>(m_region.data()); }
+            const T* data() const { return reinterpret_cast<const T*>(m_region.data()); }
+
+            T* begin() { return data(); }
+            const T* begin() const { return data(); }
+            T* end() { return data() + size(); }
+            const T* end() const { return data() + size(); }
+
+            size_t size() const { return m_region.isMapped() ? m_region.header().num_bytes / sizeof(T) : 0; }
+            size_t capacity() const { return m_region.capacity() / sizeof(T); }
+            bool empty() const { return size() == 0; }
+
+            void reserve(size_t n) { m_region.reserve(n * sizeof(T)); }
+
+            // New elements are zero initialized to match std::vector::resize for trivial types
+            void resize(size_t n)
+            {
+                reserve(n);
+                const size_t old = size();
+                if (n > old)
+                {
+                    std::memset(data() + old, 0, (n - old) * sizeof(T));
+                }
+                m_region.header().num_bytes = n * sizeof(T);
+            }
+
+            void clear()
+            {
+                if (m_region.isMapped())
+                {
+                    resize(0);
+                }
+            }
+
+            T* erase(T* first, T* last)
+            {
+                const size_t n = static_cast<size_t>(last - first);
+                std::memmove(first, last, static_cast<size_t>(end() - last) * sizeof(T));
+                const size_t index = static_cast<size_t>(first - begin());
+                resize(size() - n);
+                return begin() + index;
+            }
+
+            T* insert(T* pos, const T& val)
+            {
+                const size_t index = static_cast<size_t>(pos - begin());
+                const T tmp = val;
+                resize(size() + 1);
+                T* ptr = begin() + index;
+                std::memmove(ptr + 1, ptr, (size() - index - 1) * sizeof(T));
+                *ptr = tmp;
+                return ptr;
+            }
+
+            MmapRegion& region() { return m_region; }
+            const MmapRegion& region() const { return m_region; }
+
+          private:
+            MmapRegion m_region;
+        };
+
+        template <class T>
+        struct BufferAlignment<MmapBuffer<T>>
+        {
+            static_assert(MmapRegion::header_size % CT_EXT_SIMD_ALIGNMENT == 0, "Column data must stay aligned");
+            static constexpr const size_t value = CT_EXT_SIMD_ALIGNMENT;
+        };
+
+        namespace detail
+        {
+            // Records the shape of a mapped column in its header
+            template <class T, class B>
+            void storeShape(DataTableStorage<T, B>& storage)
+            {
+                static_assert(DataTableStorage<T, B>::storage_dim <= MmapColumnHeader::max_dims,
+                              "Too many dimensions for the column header");
+                MmapRegion& region = storage.buffer().region();
+                if (!region.isMapped())
+                {
+                    return;
+                }
+                const auto shape = storage.shape();
+                for (uint8_t i = 0; i < DataTableStorage<T, B>::storage_dim; ++i)
+                {
+                    region.header().shape[i] = shape[i];
+                }
+            }
+        } // namespace detail
+
+        // Columns live in mmap regions. Until mapTable binds the table to a directory the regions are anonymous
+        // memory, afterwards every column is a file in that directory. Shapes are written to the column headers by
+        // sync and on destruction.
+        template <class... Ts>
+        struct MmapStoragePolicy
+        {
+            template <class T>
+            using StorageType = DataTableStorage<T, MmapBuffer<typename DataDimensionality<T>::DType>>;
+            using type = std::tuple<StorageType<Ts>...>;
+            type m_data;
+
+            MmapStoragePolicy() = default;
+            MmapStoragePolicy(const MmapStoragePolicy&) = default;
+            MmapStoragePolicy(MmapStoragePolicy&&) = default;
+            MmapStoragePolicy& operator=(const MmapStoragePolicy&) = default;
+            MmapStoragePolicy& operator=(MmapStoragePolicy&&) = default;
+
+            ~MmapStoragePolicy() { storeShapes(Indexer<sizeof...(Ts) - 1>{}); }
+
+            template <index_t I>
+            auto get() -> decltype(std::get<I>(m_data))
+            {
+                return std::get<I>(m_data);
+            }
+
+            template <index_t I>
+            auto get() const -> decltype(std::get<I>(m_data))
+            {
+                return std::get<I>(m_data);
+            }
+
+            // Records the current shapes and flushes every mapped column to its file
+            void sync() { syncImpl(Indexer<sizeof...(Ts) - 1>{}); }
+
+          private:
+            void storeShapes(Indexer<0>) { detail::storeShape(get<0>()); }
+
+            template <index_t I>
+            void storeShapes(Indexer<I> idx)
+            {
+                detail::storeShape(get<I>());
+                storeShapes(--idx);
+            }
+
+            void syncImpl(Indexer<0>)
+            {
+                detail::storeShape(get<0>());
+                get<0>().buffer().region().sync();
+            }
+
+            template <index_t I>
+            void syncImpl(Indexer<I> idx)
+            {
+                detail::storeShape(get<I>());
+                get<I>().buffer().region().sync();
+                syncImpl(--idx);
+            }
+        };
+
+        namespace detail
+        {
+            struct MapColumn
+            {
+                template <class T_, class T>
+                void operator()(StringView name, size_t field_offset, DataTableStorage<T_, MmapBuffer<T>>& storage)
+                {
+                    using Storage = DataTableStorage<T_, MmapBuffer<T>>;
+                    std::ostringstream ss;
+                    ss << name;
+                    const std::string member = ss.str();
+                    const std::string path = directory + "/" + member + ".col";
+                    if (member.size() >= sizeof(MmapColumnHeader::name))
+                    {
+                        throw std::runtime_error("Member name too long for a mapped column: " + member);
+                    }
+
+                    MmapBuffer<T> buffer(path);
+                    MmapColumnHeader& header = buffer.region().header();
+                    if (header.magic == 0)
+                    {
+                        // New file, the current content of the column is moved into it
+                        header.magic = MmapColumnHeader::magic_value;
+                        header.version = MmapColumnHeader::current_version;
+                        header.element_size = sizeof(T);
+                        header.field_offset = field_offset;
+                        header.data_dim = Storage::data_dim;
+                        std::memcpy(header.name, member.c_str(), member.size() + 1);
+
+                        Storage mapped{std::move(buffer)};
+                        mapped.reshape(storage.shape());
+                        if (storage.size() != 0)
+                        {
+                            std::memcpy(mapped.data().data(),
+                                        storage.data().data(),
+                                        storage.size() * storage.shape().getStride(0) * sizeof(T));
+                        }
+                        storage = std::move(mapped);
+                        storeShape(storage);
+                    }
+                    else
+                    {
+                        if (header.magic != MmapColumnHeader::magic_value ||
+                            header.version != MmapColumnHeader::current_version ||
+                            header.element_size != sizeof(T) || header.field_offset != field_offset ||
+                            header.data_dim != Storage::data_dim ||
+                            std::strncmp(header.name, member.c_str(), sizeof(header.name)) != 0)
+                        {
+                            throw std::runtime_error(path + " does not match the reflected layout of the table");
+                        }
+                        mt::Shape<Storage::storage_dim> shape;
+                        for (uint8_t i = 1; i < Storage::storage_dim; ++i)
+                        {
+                            shape.setShape(i, header.shape[i]);
+                        }
+                        shape.calculateStride();
+                        padRowStride<T, MmapBuffer<T>>(shape);
+                        const size_t row_bytes = shape.getStride(0) * sizeof(T);
+                        if (row_bytes == 0)
+                        {
+                            throw std::runtime_error(path + " has no subarray shape, was the table synced?");
+                        }
+                        shape.setShape(0, static_cast<uint32_t>(header.num_bytes / row_bytes));
+
+                        Storage mapped{std::move(buffer)};
+                        mapped.reshape(shape);
+                        storage = std::move(mapped);
+                    }
+
+                    if (rows != static_cast<size_t>(-1) && rows != storage.size())
+                    {
+                        throw std::runtime_error(path + " has a different number of rows than the other columns");
+                    }
+                    rows = storage.size();
+                }
+
+                std::string directory;
+                size_t rows;
+            };
+        } // namespace detail
+
+        // Binds every column of table to the file <directory>/<member name>.col. Existing files are reopened and
+        // replace the content of the table, after checking that each column still has the member name, offset,
+        // element size and dimensionality of the reflected layout of U. Missing files are created from the current
+        // content of the table. The directory must exist.
+        template <class U>
+        void mapTable(DataTable<U, MmapStoragePolicy>& table, const std::string& directory)
+        {
+            detail::MapColumn map_column{directory, static_cast<size_t>(-1)};
+            table.forEachColumn(map_column);
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_MMAP_STORAGE_HPP
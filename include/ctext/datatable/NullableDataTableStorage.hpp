@@ -0,0 +1,195 @@
+#ifndef CT_EXT_NULLABLE_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_NULLABLE_DATA_TABLE_STORAGE_HPP
+#include "BitVector.hpp"
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Member type for a value that may be missing
+        template <class T>
+        struct Nullable
+        {
+            Nullable() = default;
+            Nullable(T value) : m_value(std::move(value)), m_valid(true) {}
+
+            bool isNull() const { return !m_valid; }
+            explicit operator bool() const { return m_valid; }
+
+            const T& operator*() const { return m_value; }
+
+            T valueOr(T fallback) const { return m_valid ? m_value : fallback; }
+
+            bool operator==(const Nullable& other) const
+            {
+                return m_valid == other.m_valid && (!m_valid || m_value == other.m_value);
+            }
+            bool operator!=(const Nullable& other) const { return !(*this == other); }
+
+            T m_value = T();
+            bool m_valid = false;
+        };
+
+        template <class T>
+        struct DataDimensionality<Nullable<T>, void>
+        {
+            static constexpr const uint8_t value = 0;
+            using DType = T;
+            using TensorView = mt::Tensor<DType, value + 1>;
+            using ConstTensorView = mt::Tensor<const DType, value + 1>;
+        };
+
+        // One bit per row, set for rows holding a value
+        using ValidityBitmap = BitVector;
+
+        // A dense column of values next to a validity bitmap. Null rows hold T() in the values so scans can run over
+        // the values and combine them with the bitmap without branching per row.
+        template <class T_>
+        struct NullableDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 0;
+            static constexpr const uint8_t storage_dim = 1;
+
+            using T = typename DataDimensionality<T_>::DType;
+
+            T_ operator[](size_t idx) const { return m_validity.test(idx) ? T_(values()[idx]) : T_(); }
+
+            // The values, null rows read as T()
+            mt::Tensor<T, 1> data(size_t idx = 0) { return m_values.data(idx); }
+            mt::Tensor<const T, 1> data(size_t idx = 0) const { return m_values.data(idx); }
+
+            mt::Shape<1> shape() const { return m_values.shape(); }
+
+            size_t size() const { return m_values.size(); }
+
+            bool isNull(size_t idx) const { return !m_validity.test(idx); }
+
+            const ValidityBitmap& validity() const { return m_validity; }
+
+            size_t countNull() const { return size() - m_validity.count(); }
+
+            void reserve(size_t size)
+            {
+                m_values.reserve(size);
+                m_validity.reserve(size);
+            }
+
+            // New rows are null
+            void resize(size_t size)
+            {
+                m_values.resize(size);
+                m_validity.resize(size, false);
+            }
+
+            void clear()
+            {
+                m_values.clear();
+                m_validity.clear();
+            }
+
+            void push_back(const T_& val)
+            {
+                m_values.push_back(val.valueOr(T()));
+                m_validity.push_back(static_cast<bool>(val));
+            }
+
+            void assign(size_t idx, const T_& val)
+            {
+                values()[idx] = val.valueOr(T());
+                m_validity.set(idx, static_cast<bool>(val));
+            }
+
+            void setNull(size_t idx) { assign(idx, T_()); }
+
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                const size_t start = size();
+                resize(start + n);
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    assign(start + i, *reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<T_*>(dst + i * stride) = (*this)[start + i];
+                }
+            }
+
+            // Sum of the valid rows. The rows are visited 64 at a time with one bitmap word, all null words are
+            // skipped and within a word the value is selected without a branch.
+            template <class ACC = T>
+            ACC sumValid() const
+            {
+                const T* vals = values();
+                const uint64_t* words = m_validity.words();
+                const size_t n = size();
+                ACC acc = ACC();
+                for (size_t base = 0; base < n; base += 64)
+                {
+                    const uint64_t w = words[base / 64];
+                    if (w == 0)
+                    {
+                        continue;
+                    }
+                    const size_t count = std::min<size_t>(64, n - base);
+                    for (size_t b = 0; b < count; ++b)
+                    {
+                        acc += ((w >> b) & 1) ? ACC(vals[base + b]) : ACC();
+                    }
+                }
+                return acc;
+            }
+
+            // Calls fn(row, value) for every valid row
+            template <class F>
+            void forEachValid(F&& fn) const
+            {
+                const T* vals = values();
+                m_validity.forEachSet([&](size_t row) { fn(row, vals[row]); });
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            void erase(uint32_t index)
+            {
+                m_values.erase(index);
+                m_validity.erase(index);
+            }
+
+          private:
+            T* values() { return m_values.data().data(); }
+            const T* values() const { return m_values.data().data(); }
+
+            DataTableStorage<T> m_values;
+            ValidityBitmap m_validity;
+        };
+
+        template <class T_>
+        struct HasDenseRows<NullableDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class T>
+        struct ColumnStorage<Nullable<T>>
+        {
+            using type = NullableDataTableStorage<Nullable<T>>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_NULLABLE_DATA_TABLE_STORAGE_HPP
@@ -0,0 +1,502 @@
+#ifndef CT_EXT_PACKED_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_PACKED_DATA_TABLE_STORAGE_HPP
+#include "BitVector.hpp"
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Member type for integers stored bit packed in blocks of 1024 rows
+        template <class T>
+        struct Packed
+        {
+            static_assert(std::is_integral<T>::value, "Packed columns hold integers");
+
+            Packed(T value = T()) : m_value(value) {}
+
+            operator T() const { return m_value; }
+
+            T m_value;
+        };
+
+        template <class T>
+        struct DataDimensionality<Packed<T>, void>
+        {
+            static constexpr const uint8_t value = 0;
+            using DType = T;
+            using TensorView = mt::Tensor<DType, value + 1>;
+            using ConstTensorView = mt::Tensor<const DType, value + 1>;
+        };
+
+        namespace detail
+        {
+            // Maps integers to unsigned keys with the same order, signed values are offset by 2^63
+            template <class T>
+            uint64_t toOrderedKey(T value, std::true_type)
+            {
+                return static_cast<uint64_t>(static_cast<int64_t>(value)) ^ (uint64_t(1) << 63);
+            }
+
+            template <class T>
+            uint64_t toOrderedKey(T value, std::false_type)
+            {
+                return static_cast<uint64_t>(value);
+            }
+
+            template <class T>
+            uint64_t toOrderedKey(T value)
+            {
+                return toOrderedKey(value, std::is_signed<T>());
+            }
+
+            template <class T>
+            T fromOrderedKey(uint64_t key, std::true_type)
+            {
+                return static_cast<T>(static_cast<int64_t>(key ^ (uint64_t(1) << 63)));
+            }
+
+            template <class T>
+            T fromOrderedKey(uint64_t key, std::false_type)
+            {
+                return static_cast<T>(key);
+            }
+
+            template <class T>
+            T fromOrderedKey(uint64_t key)
+            {
+                return fromOrderedKey<T>(key, std::is_signed<T>());
+            }
+
+            inline uint32_t bitsNeeded(uint64_t value)
+            {
+                uint32_t bits = 0;
+                while (bits < 64 && (value >> bits) != 0)
+                {
+                    ++bits;
+                }
+                return bits;
+            }
+
+            inline uint64_t lowBits(uint32_t width) { return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1; }
+
+            // Value idx of a run of width bit values
+            inline uint64_t extractBits(const uint64_t* words, size_t idx, uint32_t width)
+            {
+                if (width == 0)
+                {
+                    return 0;
+                }
+                const size_t pos = idx * width;
+                const uint32_t shift = pos % 64;
+                uint64_t value = words[pos / 64] >> shift;
+                if (shift + width > 64)
+                {
+                    value |= words[pos / 64 + 1] << (64 - shift);
+                }
+                return value & lowBits(width);
+            }
+
+            // 64 values of W bits fill exactly W words. With W known at compile time the shifts are constants and
+            // the loops unroll and vectorize. Carries are shifted in two steps so that no instantiation shifts by 64.
+            template <uint32_t W>
+            void unpackGroup(const uint64_t* in, uint64_t* out)
+            {
+                for (uint32_t i = 0; i < 64; ++i)
+                {
+                    const uint32_t pos = i * W;
+                    const uint32_t shift = pos % 64;
+                    uint64_t value = W == 0 ? 0 : in[pos / 64] >> shift;
+                    if (shift + W > 64)
+                    {
+                        value |= (in[pos / 64 + 1] << 1) << (63 - shift);
+                    }
+                    out[i] = value & lowBits(W);
+                }
+            }
+
+            // out must hold W zeroed words
+            template <uint32_t W>
+            void packGroup(const uint64_t* in, uint64_t* out)
+            {
+                for (uint32_t i = 0; i < 64 && W != 0; ++i)
+                {
+                    const uint32_t pos = i * W;
+                    const uint32_t shift = pos % 64;
+                    out[pos / 64] |= in[i] << shift;
+                    if (shift + W > 64)
+                    {
+                        out[pos / 64 + 1] |= (in[i] >> 1) >> (63 - shift);
+                    }
+                }
+            }
+
+            using GroupCodec = void (*)(const uint64_t*, uint64_t*);
+
+            template <size_t... W>
+            GroupCodec unpackGroupCodec(uint32_t width, std::index_sequence<W...>)
+            {
+                static const GroupCodec codecs[] = {&unpackGroup<W>...};
+                return codecs[width];
+            }
+
+            template <size_t... W>
+            GroupCodec packGroupCodec(uint32_t width, std::index_sequence<W...>)
+            {
+                static const GroupCodec codecs[] = {&packGroup<W>...};
+                return codecs[width];
+            }
+
+            inline GroupCodec unpackGroupCodec(uint32_t width)
+            {
+                return unpackGroupCodec(width, std::make_index_sequence<65>());
+            }
+
+            inline GroupCodec packGroupCodec(uint32_t width)
+            {
+                return packGroupCodec(width, std::make_index_sequence<65>());
+            }
+        } // namespace detail
+
+        // Lightweight compression for integer columns. Full blocks of BLOCK_ROWS rows are sealed into
+        //   key(row) = base + row * step + residual(row)
+        // with the residuals bit packed at the smallest width that fits. Unsorted blocks use step = 0, which is plain
+        // frame of reference. Sorted blocks use the smallest delta as step, so ids that grow by a constant need zero
+        // bits per row. Any row can be decoded on its own, thus access stays O(1). The last, partial block is kept
+        // uncompressed until it fills up.
+        template <class T_>
+        struct PackedDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 0;
+            static constexpr const uint8_t storage_dim = 1;
+
+            using T = typename DataDimensionality<T_>::DType;
+
+            enum : size_t
+            {
+                BLOCK_ROWS = 1024,
+                GROUPS_PER_BLOCK = BLOCK_ROWS / 64
+            };
+
+            T_ operator[](size_t idx) const { return T_(get(idx)); }
+
+            T get(size_t idx) const
+            {
+                const size_t b = idx / BLOCK_ROWS;
+                const size_t row = idx % BLOCK_ROWS;
+                if (b == m_blocks.size())
+                {
+                    return m_tail[row];
+                }
+                const Block& block = m_blocks[b];
+                const uint64_t residual = detail::extractBits(m_words.data() + block.offset, row, block.width);
+                return detail::fromOrderedKey<T>(block.base + row * block.step + residual);
+            }
+
+            // The packed words starting with the block that holds row idx
+            mt::Tensor<uint64_t, 1> data(size_t idx = 0)
+            {
+                const size_t offset = wordOffset(idx);
+                return mt::Tensor<uint64_t, 1>(m_words.data() + offset, m_words.size() - offset);
+            }
+
+            mt::Tensor<const uint64_t, 1> data(size_t idx = 0) const
+            {
+                const size_t offset = wordOffset(idx);
+                return mt::Tensor<const uint64_t, 1>(m_words.data() + offset, m_words.size() - offset);
+            }
+
+            size_t size() const { return m_blocks.size() * BLOCK_ROWS + m_tail.size(); }
+
+            size_t numBlocks() const { return m_blocks.size(); }
+
+            // Bits per row of sealed block b
+            uint32_t blockWidth(size_t b) const { return m_blocks[b].width; }
+
+            // Bytes used by the packed blocks and the uncompressed tail
+            size_t memoryBytes() const
+            {
+                return m_words.size() * sizeof(uint64_t) + m_blocks.size() * sizeof(Block) + m_tail.size() * sizeof(T);
+            }
+
+            // Decodes rows [start, start + n), whole blocks are unpacked a group of 64 rows at a time
+            void decode(size_t start, size_t n, T* out) const
+            {
+                assert(start + n <= size());
+                size_t i = 0;
+                while (i < n)
+                {
+                    const size_t idx = start + i;
+                    const size_t b = idx / BLOCK_ROWS;
+                    if (idx % BLOCK_ROWS == 0 && b < m_blocks.size() && n - i >= BLOCK_ROWS)
+                    {
+                        decodeBlock(b, out + i);
+                        i += BLOCK_ROWS;
+                    }
+                    else
+                    {
+                        out[i] = get(idx);
+                        ++i;
+                    }
+                }
+            }
+
+            // Rows with lo <= value <= hi. Blocks outside the range are skipped and blocks inside it are set whole
+            // from their min and max, the rest are compared group wise on the unpacked keys without decoding back to T.
+            BitVector filterRange(T lo, T hi) const
+            {
+                BitVector out(size(), false);
+                const uint64_t key_lo = detail::toOrderedKey(lo);
+                const uint64_t key_hi = detail::toOrderedKey(hi);
+                if (key_lo > key_hi)
+                {
+                    return out;
+                }
+                const uint64_t span = key_hi - key_lo;
+                uint64_t residuals[64];
+                for (size_t b = 0; b < m_blocks.size(); ++b)
+                {
+                    const Block& block = m_blocks[b];
+                    uint64_t* words = out.words() + b * GROUPS_PER_BLOCK;
+                    if (block.max_key < key_lo || block.base > key_hi)
+                    {
+                        continue;
+                    }
+                    if (block.base >= key_lo && block.max_key <= key_hi)
+                    {
+                        std::fill(words, words + GROUPS_PER_BLOCK, ~uint64_t(0));
+                        continue;
+                    }
+                    const detail::GroupCodec unpack = detail::unpackGroupCodec(block.width);
+                    for (size_t g = 0; g < GROUPS_PER_BLOCK; ++g)
+                    {
+                        unpack(m_words.data() + block.offset + g * block.width, residuals);
+                        const uint64_t first = block.base + g * 64 * block.step;
+                        uint64_t mask = 0;
+                        for (uint32_t i = 0; i < 64; ++i)
+                        {
+                            const uint64_t key = first + i * block.step + residuals[i];
+                            mask |= uint64_t(key - key_lo <= span) << i;
+                        }
+                        words[g] = mask;
+                    }
+                }
+                const size_t start = m_blocks.size() * BLOCK_ROWS;
+                for (size_t i = 0; i < m_tail.size(); ++i)
+                {
+                    out.set(start + i, detail::toOrderedKey(m_tail[i]) - key_lo <= span);
+                }
+                return out;
+            }
+
+            void reserve(size_t size)
+            {
+                m_blocks.reserve(size / BLOCK_ROWS);
+                m_tail.reserve(BLOCK_ROWS);
+            }
+
+            // New rows are zero
+            void resize(size_t size)
+            {
+                if (size < this->size())
+                {
+                    truncate(size);
+                }
+                while (this->size() < size)
+                {
+                    push_back(T_(T()));
+                }
+            }
+
+            void clear()
+            {
+                m_blocks.clear();
+                m_words.clear();
+                m_tail.clear();
+            }
+
+            void push_back(const T_& val)
+            {
+                m_tail.push_back(static_cast<T>(val));
+                if (m_tail.size() == BLOCK_ROWS)
+                {
+                    Block block;
+                    encode(m_tail.data(), block, m_words.size());
+                    m_blocks.push_back(block);
+                    m_tail.clear();
+                }
+            }
+
+            // Re-encodes the block of row idx when it is sealed
+            void assign(size_t idx, const T_& val)
+            {
+                const size_t b = idx / BLOCK_ROWS;
+                if (b == m_blocks.size())
+                {
+                    m_tail[idx % BLOCK_ROWS] = static_cast<T>(val);
+                    return;
+                }
+                std::vector<T> rows(BLOCK_ROWS);
+                decodeBlock(b, rows.data());
+                rows[idx % BLOCK_ROWS] = static_cast<T>(val);
+                const size_t offset = m_blocks[b].offset;
+                const size_t old_words = m_blocks[b].width * GROUPS_PER_BLOCK;
+                m_words.erase(m_words.begin() + static_cast<std::ptrdiff_t>(offset),
+                              m_words.begin() + static_cast<std::ptrdiff_t>(offset + old_words));
+                encode(rows.data(), m_blocks[b], offset);
+                const size_t new_words = m_blocks[b].width * GROUPS_PER_BLOCK;
+                for (size_t i = b + 1; i < m_blocks.size(); ++i)
+                {
+                    m_blocks[i].offset = m_blocks[i].offset + new_words - old_words;
+                }
+            }
+
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                reserve(size() + n);
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                std::vector<T> rows(n);
+                decode(start, n, rows.data());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<T_*>(dst + i * stride) = T_(rows[i]);
+                }
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            // Rows after index are decoded and packed again
+            void erase(uint32_t index)
+            {
+                std::vector<T> rest(size() - index - 1);
+                decode(index + 1, rest.size(), rest.data());
+                truncate(index);
+                for (const T& val : rest)
+                {
+                    push_back(T_(val));
+                }
+            }
+
+          private:
+            struct Block
+            {
+                uint64_t base = 0;
+                uint64_t step = 0;
+                uint64_t max_key = 0;
+                size_t offset = 0;
+                uint32_t width = 0;
+            };
+
+            size_t wordOffset(size_t idx) const
+            {
+                const size_t b = idx / BLOCK_ROWS;
+                return b < m_blocks.size() ? m_blocks[b].offset : m_words.size();
+            }
+
+            void decodeBlock(size_t b, T* out) const
+            {
+                const Block& block = m_blocks[b];
+                const detail::GroupCodec unpack = detail::unpackGroupCodec(block.width);
+                uint64_t residuals[64];
+                for (size_t g = 0; g < GROUPS_PER_BLOCK; ++g)
+                {
+                    unpack(m_words.data() + block.offset + g * block.width, residuals);
+                    const uint64_t first = block.base + g * 64 * block.step;
+                    for (uint32_t i = 0; i < 64; ++i)
+                    {
+                        out[g * 64 + i] = detail::fromOrderedKey<T>(first + i * block.step + residuals[i]);
+                    }
+                }
+            }
+
+            // Packs BLOCK_ROWS rows into the words at offset
+            void encode(const T* rows, Block& block, size_t offset)
+            {
+                uint64_t keys[BLOCK_ROWS];
+                bool sorted = true;
+                uint64_t min_key = ~uint64_t(0);
+                uint64_t max_key = 0;
+                uint64_t step = ~uint64_t(0);
+                for (size_t i = 0; i < BLOCK_ROWS; ++i)
+                {
+                    keys[i] = detail::toOrderedKey(rows[i]);
+                    min_key = std::min(min_key, keys[i]);
+                    max_key = std::max(max_key, keys[i]);
+                    if (i > 0)
+                    {
+                        sorted = sorted && keys[i] >= keys[i - 1];
+                        step = sorted ? std::min(step, keys[i] - keys[i - 1]) : 0;
+                    }
+                }
+                block.step = sorted ? step : 0;
+                block.base = sorted ? keys[0] : min_key;
+                block.max_key = max_key;
+                uint64_t max_residual = 0;
+                for (size_t i = 0; i < BLOCK_ROWS; ++i)
+                {
+                    keys[i] -= block.base + i * block.step;
+                    max_residual = std::max(max_residual, keys[i]);
+                }
+                block.width = detail::bitsNeeded(max_residual);
+                block.offset = offset;
+                const size_t num_words = block.width * GROUPS_PER_BLOCK;
+                m_words.insert(m_words.begin() + static_cast<std::ptrdiff_t>(offset), num_words, 0);
+                const detail::GroupCodec pack = detail::packGroupCodec(block.width);
+                for (size_t g = 0; g < GROUPS_PER_BLOCK; ++g)
+                {
+                    pack(keys + g * 64, m_words.data() + offset + g * block.width);
+                }
+            }
+
+            // Drops the rows from size on, a partially kept block is unpacked into the tail
+            void truncate(size_t size)
+            {
+                const size_t keep = size / BLOCK_ROWS;
+                const size_t rows = size % BLOCK_ROWS;
+                if (keep < m_blocks.size())
+                {
+                    m_tail.resize(BLOCK_ROWS);
+                    decodeBlock(keep, m_tail.data());
+                    m_words.resize(m_blocks[keep].offset);
+                    m_blocks.resize(keep);
+                }
+                m_tail.resize(rows);
+            }
+
+            std::vector<Block> m_blocks;
+            std::vector<uint64_t> m_words;
+            std::vector<T> m_tail;
+        };
+
+        template <class T_>
+        struct HasDenseRows<PackedDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class T>
+        struct ColumnStorage<Packed<T>>
+        {
+            using type = PackedDataTableStorage<Packed<T>>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_PACKED_DATA_TABLE_STORAGE_HPP
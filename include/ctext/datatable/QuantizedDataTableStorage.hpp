@@ -0,0 +1,478 @@
+#ifndef CT_EXT_QUANTIZED_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_QUANTIZED_DATA_TABLE_STORAGE_HPP
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        // IEEE 754 half precision
+        struct Half
+        {
+            uint16_t bits;
+        };
+
+        // The upper half of a float, same range as float with 8 bits of mantissa
+        struct BFloat16
+        {
+            uint16_t bits;
+        };
+
+        namespace detail
+        {
+            inline uint32_t floatBits32(float value)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(float));
+                return bits;
+            }
+
+            inline float bitsFloat32(uint32_t bits)
+            {
+                float value;
+                std::memcpy(&value, &bits, sizeof(float));
+                return value;
+            }
+
+            // Round to nearest even, overflow saturates to infinity
+            inline Half toHalf(float value)
+            {
+                const uint32_t f = floatBits32(value);
+                const uint16_t sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+                const uint32_t exponent = (f >> 23) & 0xFF;
+                uint32_t mantissa = f & 0x7FFFFF;
+                if (exponent == 0xFF)
+                {
+                    return Half{static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0))};
+                }
+                const int32_t e = static_cast<int32_t>(exponent) - 127 + 15;
+                if (e >= 31)
+                {
+                    return Half{static_cast<uint16_t>(sign | 0x7C00)};
+                }
+                if (e <= 0)
+                {
+                    if (e < -10)
+                    {
+                        return Half{sign};
+                    }
+                    mantissa |= 0x800000;
+                    const uint32_t shift = static_cast<uint32_t>(14 - e);
+                    uint32_t h = mantissa >> shift;
+                    const uint32_t rem = mantissa & ((uint32_t(1) << shift) - 1);
+                    const uint32_t half = uint32_t(1) << (shift - 1);
+                    h += (rem > half || (rem == half && (h & 1))) ? 1 : 0;
+                    return Half{static_cast<uint16_t>(sign | h)};
+                }
+                uint32_t h = (static_cast<uint32_t>(e) << 10) | (mantissa >> 13);
+                const uint32_t rem = mantissa & 0x1FFF;
+                h += (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ? 1 : 0;
+                return Half{static_cast<uint16_t>(sign | h)};
+            }
+
+            inline float toFloat(Half value)
+            {
+                const uint32_t sign = static_cast<uint32_t>(value.bits & 0x8000) << 16;
+                const uint32_t exponent = (value.bits >> 10) & 0x1F;
+                const uint32_t mantissa = value.bits & 0x3FF;
+                if (exponent == 0)
+                {
+                    const float subnormal = std::ldexp(static_cast<float>(mantissa), -24);
+                    return sign ? -subnormal : subnormal;
+                }
+                if (exponent == 31)
+                {
+                    return bitsFloat32(sign | 0x7F800000 | (mantissa << 13));
+                }
+                return bitsFloat32(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+            }
+
+            inline BFloat16 toBFloat16(float value)
+            {
+                const uint32_t f = floatBits32(value);
+                if ((f & 0x7FFFFFFF) > 0x7F800000)
+                {
+                    return BFloat16{static_cast<uint16_t>((f >> 16) | 0x40)};
+                }
+                return BFloat16{static_cast<uint16_t>((f + 0x7FFF + ((f >> 16) & 1)) >> 16)};
+            }
+
+            inline float toFloat(BFloat16 value) { return bitsFloat32(static_cast<uint32_t>(value.bits) << 16); }
+
+            inline float toFloat(int8_t value) { return static_cast<float>(value); }
+
+            // Per row encoding, returns the scale the codes are multiplied by when decoding
+            inline float quantizeRow(const float* src, size_t n, Half* dst)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = toHalf(src[i]);
+                }
+                return 1.0f;
+            }
+
+            inline float quantizeRow(const float* src, size_t n, BFloat16* dst)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = toBFloat16(src[i]);
+                }
+                return 1.0f;
+            }
+
+            // Symmetric, the largest magnitude of the row maps to 127
+            inline float quantizeRow(const float* src, size_t n, int8_t* dst)
+            {
+                float max_abs = 0.0f;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    max_abs = std::max(max_abs, std::fabs(src[i]));
+                }
+                const float scale = max_abs / 127.0f;
+                const float inv = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const float code = std::nearbyint(src[i] * inv);
+                    dst[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, code)));
+                }
+                return scale;
+            }
+
+#if defined(__AVX2__)
+            inline __m256 fmadd8(__m256 a, __m256 b, __m256 c)
+            {
+#if defined(__FMA__)
+                return _mm256_fmadd_ps(a, b, c);
+#else
+                return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+            }
+
+            inline float horizontalSum8(__m256 v)
+            {
+                __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                __m128 shuf = _mm_movehdup_ps(sum);
+                sum = _mm_add_ps(sum, shuf);
+                shuf = _mm_movehl_ps(shuf, sum);
+                return _mm_cvtss_f32(_mm_add_ss(sum, shuf));
+            }
+
+            // Widens 8 codes to floats, scale not applied
+            inline __m256 load8(const BFloat16* src)
+            {
+                const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(bits), 16));
+            }
+
+            inline __m256 load8(const int8_t* src)
+            {
+                const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+                return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+            }
+
+            inline __m256 load8(const Half* src)
+            {
+#if defined(__F16C__)
+                return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#else
+                float values[8];
+                for (int i = 0; i < 8; ++i)
+                {
+                    values[i] = toFloat(src[i]);
+                }
+                return _mm256_loadu_ps(values);
+#endif
+            }
+#endif // __AVX2__
+
+            // dot(decode(codes), query), scale applied once to the sum
+            template <class Q>
+            float quantizedDot(const Q* codes, const float* query, size_t n, float scale)
+            {
+                size_t i = 0;
+                float sum = 0.0f;
+#if defined(__AVX2__)
+                __m256 acc = _mm256_setzero_ps();
+                for (; i + 8 <= n; i += 8)
+                {
+                    acc = fmadd8(load8(codes + i), _mm256_loadu_ps(query + i), acc);
+                }
+                sum = horizontalSum8(acc);
+#endif
+                for (; i < n; ++i)
+                {
+                    sum += toFloat(codes[i]) * query[i];
+                }
+                return sum * scale;
+            }
+
+            // Squared euclidean distance between decode(codes) and query
+            template <class Q>
+            float quantizedL2(const Q* codes, const float* query, size_t n, float scale)
+            {
+                size_t i = 0;
+                float sum = 0.0f;
+#if defined(__AVX2__)
+                const __m256 s = _mm256_set1_ps(scale);
+                __m256 acc = _mm256_setzero_ps();
+                for (; i + 8 <= n; i += 8)
+                {
+                    const __m256 diff = _mm256_sub_ps(_mm256_mul_ps(load8(codes + i), s), _mm256_loadu_ps(query + i));
+                    acc = fmadd8(diff, diff, acc);
+                }
+                sum = horizontalSum8(acc);
+#endif
+                for (; i < n; ++i)
+                {
+                    const float diff = toFloat(codes[i]) * scale - query[i];
+                    sum += diff * diff;
+                }
+                return sum;
+            }
+        } // namespace detail
+
+        // Read only view of one quantized row, decodes on access
+        template <class Q>
+        class QuantizedRow
+        {
+          public:
+            QuantizedRow(const Q* codes, size_t size, float scale) : m_codes(codes), m_size(size), m_scale(scale) {}
+
+            float operator[](size_t idx) const { return detail::toFloat(m_codes[idx]) * m_scale; }
+
+            size_t size() const { return m_size; }
+
+            const Q* codes() const { return m_codes; }
+
+            float scale() const { return m_scale; }
+
+            void decode(float* out) const
+            {
+                for (size_t i = 0; i < m_size; ++i)
+                {
+                    out[i] = (*this)[i];
+                }
+            }
+
+            float dot(const float* query) const { return detail::quantizedDot(m_codes, query, m_size, m_scale); }
+
+            float l2(const float* query) const { return detail::quantizedL2(m_codes, query, m_size, m_scale); }
+
+          private:
+            const Q* m_codes;
+            size_t m_size;
+            float m_scale;
+        };
+
+        // Member type for float arrays stored as Half, BFloat16 or int8_t with a per row scale. The member owns its
+        // floats, rows read from a table are a dequantized copy.
+        template <class Q>
+        struct Quantized : std::vector<float>
+        {
+            template <class... ARGS>
+            Quantized(ARGS&&... args) : std::vector<float>(std::forward<ARGS>(args)...)
+            {
+            }
+
+            Quantized(std::initializer_list<float> values) : std::vector<float>(values) {}
+
+            Quantized(QuantizedRow<Q> row) : std::vector<float>(row.size())
+            {
+                row.decode(this->data());
+            }
+        };
+
+        template <class Q>
+        struct DataDimensionality<Quantized<Q>, void>
+        {
+            static constexpr const uint8_t value = 1;
+            using DType = Q;
+            using TensorView = mt::Tensor<DType, value + 1>;
+            using ConstTensorView = mt::Tensor<const DType, value + 1>;
+        };
+
+        // Fixed length float arrays quantized row by row. All rows share the length of the first row pushed. The
+        // search kernels run on the codes, a query is compared against every row without decoding the column.
+        template <class T_>
+        struct QuantizedDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 1;
+            static constexpr const uint8_t storage_dim = 2;
+
+            using T = typename DataDimensionality<T_>::DType;
+
+            QuantizedRow<T> operator[](size_t idx) const
+            {
+                return QuantizedRow<T>(m_codes.data() + idx * m_dim, m_dim, m_scales[idx]);
+            }
+
+            // The codes of rows [idx, size())
+            mt::Tensor<T, 2> data(size_t idx = 0) { return mt::Tensor<T, 2>(m_codes.data() + idx * m_dim, shape(idx)); }
+
+            mt::Tensor<const T, 2> data(size_t idx = 0) const
+            {
+                return mt::Tensor<const T, 2>(m_codes.data() + idx * m_dim, shape(idx));
+            }
+
+            size_t size() const { return m_scales.size(); }
+
+            // Length of every row
+            size_t dim() const { return m_dim; }
+
+            const T* codes() const { return m_codes.data(); }
+
+            const std::vector<float>& scales() const { return m_scales; }
+
+            // out[row] = dot(row, query) for every row, query holds dim() floats
+            void dot(const float* query, float* out) const
+            {
+                for (size_t row = 0; row < size(); ++row)
+                {
+                    out[row] = detail::quantizedDot(m_codes.data() + row * m_dim, query, m_dim, m_scales[row]);
+                }
+            }
+
+            // out[row] = squared euclidean distance between row and query
+            void l2(const float* query, float* out) const
+            {
+                for (size_t row = 0; row < size(); ++row)
+                {
+                    out[row] = detail::quantizedL2(m_codes.data() + row * m_dim, query, m_dim, m_scales[row]);
+                }
+            }
+
+            void reserve(size_t size)
+            {
+                m_codes.reserve(size * m_dim);
+                m_scales.reserve(size);
+            }
+
+            // New rows are zero
+            void resize(size_t size)
+            {
+                m_codes.resize(size * m_dim, T());
+                m_scales.resize(size, 0.0f);
+            }
+
+            void clear()
+            {
+                m_codes.clear();
+                m_scales.clear();
+            }
+
+            // Every row must have dim() values, a row of another length throws std::invalid_argument and leaves the
+            // column unchanged
+            void push_back(const T_& val)
+            {
+                if (size() == 0)
+                {
+                    m_dim = val.size();
+                }
+                checkLength(val);
+                resize(size() + 1);
+                assign(size() - 1, val);
+            }
+
+            void assign(size_t idx, const T_& val)
+            {
+                assert(idx < size());
+                checkLength(val);
+                m_scales[idx] = detail::quantizeRow(val.data(), m_dim, m_codes.data() + idx * m_dim);
+            }
+
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                if (n == 0)
+                {
+                    return;
+                }
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                if (size() == 0)
+                {
+                    m_dim = first->size();
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    checkLength(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+                const size_t start = size();
+                resize(start + n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    assign(start + i, *reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            // Writes dequantized copies of rows [start, start + n)
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<T_*>(dst + i * stride) = T_((*this)[start + i]);
+                }
+            }
+
+            // The row length is taken from the first row pushed
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            void erase(uint32_t index)
+            {
+                m_codes.erase(m_codes.begin() + static_cast<std::ptrdiff_t>(index * m_dim),
+                              m_codes.begin() + static_cast<std::ptrdiff_t>((index + 1) * m_dim));
+                m_scales.erase(m_scales.begin() + index);
+            }
+
+          private:
+            void checkLength(const T_& val) const
+            {
+                if (val.size() != m_dim)
+                {
+                    throw std::invalid_argument("Quantized rows must all have the length of the first row");
+                }
+            }
+
+            mt::Shape<2> shape(size_t idx) const
+            {
+                mt::Shape<2> shape;
+                shape.setShape(0, static_cast<uint32_t>(size() - std::min(idx, size())));
+                shape.setShape(1, static_cast<uint32_t>(m_dim));
+                shape.calculateStride();
+                return shape;
+            }
+
+            size_t m_dim = 0;
+            std::vector<T> m_codes;
+            std::vector<float> m_scales;
+        };
+
+        template <class T_>
+        struct HasDenseRows<QuantizedDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class Q>
+        struct ColumnStorage<Quantized<Q>>
+        {
+            using type = QuantizedDataTableStorage<Quantized<Q>>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_QUANTIZED_DATA_TABLE_STORAGE_HPP
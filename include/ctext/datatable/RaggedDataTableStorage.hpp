@@ -0,0 +1,180 @@
+#ifndef CT_EXT_RAGGED_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_RAGGED_DATA_TABLE_STORAGE_HPP
+#include "DataTableStorage.hpp"
+
+#include <ct/types/TArrayView.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Member type for variable length arrays. Unlike a TArrayView member, where every row of the column shares one
+        // subarray shape, each row of a RaggedView column has its own length.
+        template <class T>
+        struct RaggedView : TArrayView<T>
+        {
+            template <class... ARGS>
+            RaggedView(ARGS&&... args) : TArrayView<T>(std::forward<ARGS>(args)...)
+            {
+            }
+        };
+
+        // Arrow style list column, the values of all rows are stored back to back and row i spans
+        // [offsets[i], offsets[i + 1]) of the values. Appending a row costs O(length of the row) amortized.
+        template <class T_>
+        struct RaggedDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 1;
+            static constexpr const uint8_t storage_dim = 2;
+
+            using T = typename DataDimensionality<T_>::DType;
+
+            RaggedDataTableStorage() : m_offsets(1, 0) {}
+
+            TArrayView<T> operator[](size_t idx)
+            {
+                return TArrayView<T>(m_values.data() + m_offsets[idx], length(idx));
+            }
+
+            TArrayView<const T> operator[](size_t idx) const
+            {
+                return TArrayView<const T>(m_values.data() + m_offsets[idx], length(idx));
+            }
+
+            // The values of row idx as a 1 x length tensor, rows do not share a shape so there is no column tensor
+            mt::Tensor<T, 2> data(size_t idx = 0)
+            {
+                return mt::Tensor<T, 2>(m_values.data() + begin(idx), rowShape(idx));
+            }
+
+            mt::Tensor<const T, 2> data(size_t idx = 0) const
+            {
+                return mt::Tensor<const T, 2>(m_values.data() + begin(idx), rowShape(idx));
+            }
+
+            size_t size() const { return m_offsets.size() - 1; }
+
+            size_t length(size_t idx) const { return static_cast<size_t>(m_offsets[idx + 1] - m_offsets[idx]); }
+
+            // Total number of values over all rows
+            size_t numValues() const { return m_values.size(); }
+
+            const std::vector<T>& values() const { return m_values; }
+
+            const std::vector<uint64_t>& offsets() const { return m_offsets; }
+
+            void reserve(size_t size) { m_offsets.reserve(size + 1); }
+
+            void reserveValues(size_t size) { m_values.reserve(size); }
+
+            // New rows are empty
+            void resize(size_t size) { m_offsets.resize(size + 1, m_offsets.back()); }
+
+            void clear()
+            {
+                m_values.clear();
+                m_offsets.assign(1, 0);
+            }
+
+            void push_back(const T_& val)
+            {
+                m_values.insert(m_values.end(), val.data(), val.data() + val.size());
+                m_offsets.push_back(m_values.size());
+            }
+
+            void push_back(T_&& val) { push_back(static_cast<const T_&>(val)); }
+
+            // Appends n rows spaced stride bytes apart, the values are sized once for all rows
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                size_t num_values = m_values.size();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    num_values += reinterpret_cast<const T_*>(src + i * stride)->size();
+                }
+                m_values.reserve(num_values);
+                m_offsets.reserve(m_offsets.size() + n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            // Sets n values spaced stride bytes apart to views of rows [start, start + n)
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0)
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<T_*>(dst + i * stride) = (*this)[start + i];
+                }
+            }
+
+            // Rows carry their own length
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            // Replaces the values of row idx, a row of a different length moves the values of the later rows
+            void assign(size_t idx, const T_& val)
+            {
+                // val may view values of this column
+                const std::vector<T> row(val.data(), val.data() + val.size());
+                const int64_t delta = static_cast<int64_t>(row.size()) - static_cast<int64_t>(length(idx));
+                const auto first = m_values.begin() + static_cast<std::ptrdiff_t>(m_offsets[idx]);
+                m_values.insert(m_values.erase(first, first + static_cast<std::ptrdiff_t>(length(idx))), row.begin(), row.end());
+                for (size_t i = idx + 1; i < m_offsets.size(); ++i)
+                {
+                    m_offsets[i] = static_cast<uint64_t>(static_cast<int64_t>(m_offsets[i]) + delta);
+                }
+            }
+
+            void erase(uint32_t index)
+            {
+                const uint64_t len = m_offsets[index + 1] - m_offsets[index];
+                m_values.erase(m_values.begin() + static_cast<std::ptrdiff_t>(m_offsets[index]),
+                               m_values.begin() + static_cast<std::ptrdiff_t>(m_offsets[index + 1]));
+                m_offsets.erase(m_offsets.begin() + index + 1);
+                for (size_t i = index + 1; i < m_offsets.size(); ++i)
+                {
+                    m_offsets[i] -= len;
+                }
+            }
+
+          private:
+            size_t begin(size_t idx) const { return static_cast<size_t>(m_offsets[std::min(idx, size())]); }
+
+            mt::Shape<2> rowShape(size_t idx) const
+            {
+                mt::Shape<2> shape;
+                shape.setShape(0, idx < size() ? 1 : 0);
+                shape.setShape(1, static_cast<uint32_t>(idx < size() ? length(idx) : 0));
+                shape.calculateStride();
+                return shape;
+            }
+
+            std::vector<T> m_values;
+            std::vector<uint64_t> m_offsets;
+        };
+
+        template <class T_>
+        struct HasDenseRows<RaggedDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class T>
+        struct ColumnStorage<RaggedView<T>>
+        {
+            using type = RaggedDataTableStorage<RaggedView<T>>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_RAGGED_DATA_TABLE_STORAGE_HPP
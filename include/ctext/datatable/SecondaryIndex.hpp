@@ -0,0 +1,476 @@
+#ifndef CT_EXT_SECONDARY_INDEX_HPP
+#define CT_EXT_SECONDARY_INDEX_HPP
+#include "Aggregate.hpp"
+#include "Filter.hpp"
+#include "HashTable.hpp"
+
+#include <ct/reflect.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Secondary indexes over a scalar column. Declared on a table with DataTable::createHashIndex or
+        // createSortedIndex they are kept current by the table's row operations. Used on their own they follow the
+        // table's row ids like IvfIndex: sync() indexes the rows appended since the last build or sync, update(row,
+        // key) must be called when a row's key is assigned, erase(row) and swapRemove(row) alongside the table's.
+
+        // Equality index, find() is one hash lookup and returns the rows holding a key in ascending order
+        template <class K>
+        class HashIndex
+        {
+          public:
+            template <class STORAGE>
+            void build(const STORAGE& storage)
+            {
+                clear();
+                m_table.reserve(storage.size() / 4);
+                sync(storage);
+            }
+
+            template <class STORAGE>
+            void sync(const STORAGE& storage)
+            {
+                size_t dim = 0;
+                for (const detail::ColumnBlock<K>& block : detail::columnBlocks(storage, dim))
+                {
+                    for (size_t row = std::max(size(), block.first); row < block.first + block.rows; ++row)
+                    {
+                        add(block.data[row - block.first]);
+                    }
+                }
+            }
+
+            // Indexes key as the next row, returns its row id
+            size_t add(const K& key)
+            {
+                const size_t row = m_row_ids.size();
+                const uint32_t id = m_table.insert(key);
+                if (id == m_rows.size())
+                {
+                    m_rows.emplace_back();
+                }
+                m_rows[id].push_back(static_cast<uint32_t>(row));
+                m_row_ids.push_back(id);
+                return row;
+            }
+
+            void update(size_t row, const K& key)
+            {
+                assert(row < size());
+                const uint32_t id = m_table.insert(key);
+                if (id == m_row_ids[row])
+                {
+                    return;
+                }
+                if (id == m_rows.size())
+                {
+                    m_rows.emplace_back();
+                }
+                remove(m_rows[m_row_ids[row]], row);
+                SelectionVector& rows = m_rows[id];
+                rows.insert(std::lower_bound(rows.begin(), rows.end(), row), static_cast<uint32_t>(row));
+                m_row_ids[row] = id;
+            }
+
+            // Drops row from the index, the ids of later rows shift down by one as they do in the table
+            void erase(size_t row)
+            {
+                assert(row < size());
+                remove(m_rows[m_row_ids[row]], row);
+                for (SelectionVector& rows : m_rows)
+                {
+                    for (auto it = std::upper_bound(rows.begin(), rows.end(), row); it != rows.end(); ++it)
+                    {
+                        --*it;
+                    }
+                }
+                m_row_ids.erase(m_row_ids.begin() + static_cast<std::ptrdiff_t>(row));
+            }
+
+            // Drops row from the index and moves the last row into its place, as DataTable::swapRemove does
+            void swapRemove(size_t row)
+            {
+                assert(row < size());
+                const size_t last = size() - 1;
+                remove(m_rows[m_row_ids[row]], row);
+                if (row != last)
+                {
+                    SelectionVector& rows = m_rows[m_row_ids[last]];
+                    remove(rows, last);
+                    rows.insert(std::lower_bound(rows.begin(), rows.end(), row), static_cast<uint32_t>(row));
+                    m_row_ids[row] = m_row_ids[last];
+                }
+                m_row_ids.pop_back();
+            }
+
+            // Rows holding key in ascending order, usable as a RowSelection
+            const SelectionVector& find(const K& key) const
+            {
+                static const SelectionVector none;
+                const uint32_t id = m_table.find(key);
+                return id == KeyHashTable<K>::NOT_FOUND ? none : m_rows[id];
+            }
+
+            // Number of indexed rows
+            size_t size() const { return m_row_ids.size(); }
+
+            void clear()
+            {
+                m_table.clear();
+                m_rows.clear();
+                m_row_ids.clear();
+            }
+
+          private:
+            static void remove(SelectionVector& rows, size_t row)
+            {
+                rows.erase(std::lower_bound(rows.begin(), rows.end(), row));
+            }
+
+            KeyHashTable<K> m_table;
+            // Rows of each key id
+            std::vector<SelectionVector> m_rows;
+            // Key id of each row
+            std::vector<uint32_t> m_row_ids;
+        };
+
+        // Range index, the rows are kept sorted by key so range() is two binary searches. Appending keys in ascending
+        // order, e.g. timestamps, is amortized O(1); other insertions move the entries after them. NaN keys are not
+        // indexed.
+        template <class K>
+        class SortedIndex
+        {
+          public:
+            template <class STORAGE>
+            void build(const STORAGE& storage)
+            {
+                clear();
+                sync(storage);
+            }
+
+            template <class STORAGE>
+            void sync(const STORAGE& storage)
+            {
+                const size_t first = size();
+                const size_t num_entries = m_entries.size();
+                size_t dim = 0;
+                for (const detail::ColumnBlock<K>& block : detail::columnBlocks(storage, dim))
+                {
+                    for (size_t row = std::max(first, block.first); row < block.first + block.rows; ++row)
+                    {
+                        const K& key = block.data[row - block.first];
+                        m_row_keys.push_back(key);
+                        if (key == key)
+                        {
+                            m_entries.push_back(Entry{key, static_cast<uint32_t>(row)});
+                        }
+                    }
+                }
+                // The new rows are sorted on their own and merged, one sort for a bulk append
+                const auto middle = m_entries.begin() + static_cast<std::ptrdiff_t>(num_entries);
+                std::sort(middle, m_entries.end());
+                std::inplace_merge(m_entries.begin(), middle, m_entries.end());
+            }
+
+            // Indexes key as the next row, returns its row id
+            size_t add(const K& key)
+            {
+                const size_t row = size();
+                m_row_keys.push_back(key);
+                insert(key, row);
+                return row;
+            }
+
+            void update(size_t row, const K& key)
+            {
+                assert(row < size());
+                remove(row);
+                m_row_keys[row] = key;
+                insert(key, row);
+            }
+
+            // Drops row from the index, the ids of later rows shift down by one as they do in the table
+            void erase(size_t row)
+            {
+                assert(row < size());
+                remove(row);
+                for (Entry& entry : m_entries)
+                {
+                    if (entry.row > row)
+                    {
+                        --entry.row;
+                    }
+                }
+                m_row_keys.erase(m_row_keys.begin() + static_cast<std::ptrdiff_t>(row));
+            }
+
+            // Drops row from the index and moves the last row into its place, as DataTable::swapRemove does
+            void swapRemove(size_t row)
+            {
+                assert(row < size());
+                const size_t last = size() - 1;
+                remove(row);
+                if (row != last)
+                {
+                    remove(last);
+                    m_row_keys[row] = m_row_keys[last];
+                    insert(m_row_keys[row], row);
+                }
+                m_row_keys.pop_back();
+            }
+
+            // Rows with lo <= key <= hi in ascending row order, usable as a RowSelection
+            SelectionVector range(const K& lo, const K& hi) const
+            {
+                SelectionVector rows;
+                const auto begin = std::lower_bound(m_entries.begin(), m_entries.end(), lo, KeyLess());
+                const auto end = std::upper_bound(begin, m_entries.end(), hi, KeyLess());
+                rows.reserve(static_cast<size_t>(end - begin));
+                for (auto it = begin; it < end; ++it)
+                {
+                    rows.push_back(it->row);
+                }
+                std::sort(rows.begin(), rows.end());
+                return rows;
+            }
+
+            // Rows holding key in ascending row order
+            SelectionVector find(const K& key) const { return range(key, key); }
+
+            // Number of indexed rows
+            size_t size() const { return m_row_keys.size(); }
+
+            void clear()
+            {
+                m_entries.clear();
+                m_row_keys.clear();
+            }
+
+          private:
+            struct Entry
+            {
+                K key;
+                uint32_t row;
+
+                bool operator<(const Entry& other) const
+                {
+                    return key < other.key || (!(other.key < key) && row < other.row);
+                }
+            };
+
+            struct KeyLess
+            {
+                bool operator()(const Entry& entry, const K& key) const { return entry.key < key; }
+
+                bool operator()(const K& key, const Entry& entry) const { return key < entry.key; }
+            };
+
+            void insert(const K& key, size_t row)
+            {
+                if (key == key)
+                {
+                    const Entry entry{key, static_cast<uint32_t>(row)};
+                    m_entries.insert(std::upper_bound(m_entries.begin(), m_entries.end(), entry), entry);
+                }
+            }
+
+            void remove(size_t row)
+            {
+                const K& key = m_row_keys[row];
+                if (key == key)
+                {
+                    const Entry entry{key, static_cast<uint32_t>(row)};
+                    m_entries.erase(std::lower_bound(m_entries.begin(), m_entries.end(), entry));
+                }
+            }
+
+            // Entries ordered by key and row
+            std::vector<Entry> m_entries;
+            // Key of each row, locates a row's entry on update and erase
+            std::vector<K> m_row_keys;
+        };
+
+        namespace detail
+        {
+            // An index declared on a column of TABLE, type erased so a table holds any number of them
+            template <class TABLE>
+            struct DeclaredIndex
+            {
+                virtual ~DeclaredIndex() = default;
+                virtual std::unique_ptr<DeclaredIndex> clone() const = 0;
+                virtual size_t fieldOffset() const = 0;
+                // Indexes the rows appended since the last sync or rebuild
+                virtual void sync(const TABLE& table) = 0;
+                // Reads the key of row again after it was assigned
+                virtual void update(const TABLE& table, size_t row) = 0;
+                virtual void erase(size_t row) = 0;
+                virtual void swapRemove(size_t row) = 0;
+                virtual void rebuild(const TABLE& table) = 0;
+            };
+
+            template <class TABLE, class T, class INDEX>
+            class ColumnIndex : public DeclaredIndex<TABLE>
+            {
+              public:
+                using U = typename TABLE::DType;
+
+                explicit ColumnIndex(T U::*mem_ptr, INDEX index = INDEX()) : m_mem_ptr(mem_ptr), m_index(std::move(index))
+                {
+                }
+
+                std::unique_ptr<DeclaredIndex<TABLE>> clone() const override
+                {
+                    return std::unique_ptr<DeclaredIndex<TABLE>>(new ColumnIndex(*this));
+                }
+
+                size_t fieldOffset() const override { return memberOffset(m_mem_ptr); }
+
+                // A single pushed row is added directly, a bulk append is indexed in one pass
+                void sync(const TABLE& table) override
+                {
+                    const auto& storage = table.storage(m_mem_ptr);
+                    if (storage.size() == m_index.size() + 1)
+                    {
+                        m_index.add(storage[m_index.size()]);
+                    }
+                    else
+                    {
+                        m_index.sync(storage);
+                    }
+                }
+
+                void update(const TABLE& table, size_t row) override
+                {
+                    m_index.update(row, table.storage(m_mem_ptr)[row]);
+                }
+
+                void erase(size_t row) override { m_index.erase(row); }
+
+                void swapRemove(size_t row) override { m_index.swapRemove(row); }
+
+                void rebuild(const TABLE& table) override { m_index.build(table.storage(m_mem_ptr)); }
+
+                const INDEX& index() const { return m_index; }
+
+              private:
+                T U::*m_mem_ptr;
+                INDEX m_index;
+            };
+
+            // The indexes declared on a table, a copy of the table gets copies of its indexes
+            template <class TABLE>
+            class TableIndexes
+            {
+              public:
+                TableIndexes() = default;
+                TableIndexes(TableIndexes&&) = default;
+                TableIndexes& operator=(TableIndexes&&) = default;
+
+                TableIndexes(const TableIndexes& other) { *this = other; }
+
+                TableIndexes& operator=(const TableIndexes& other)
+                {
+                    if (this != &other)
+                    {
+                        m_indexes.clear();
+                        for (const auto& index : other.m_indexes)
+                        {
+                            m_indexes.push_back(index->clone());
+                        }
+                    }
+                    return *this;
+                }
+
+                // The INDEX declared on mem_ptr, nullptr if there is none
+                template <class INDEX, class T, class U>
+                const INDEX* get(T U::*mem_ptr) const
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        const auto* column = dynamic_cast<const ColumnIndex<TABLE, T, INDEX>*>(index.get());
+                        if (column != nullptr && column->fieldOffset() == memberOffset(mem_ptr))
+                        {
+                            return &column->index();
+                        }
+                    }
+                    return nullptr;
+                }
+
+                // Declares index on mem_ptr unless an INDEX is declared there already, index carries the settings
+                template <class INDEX, class T, class U>
+                void add(const TABLE& table, T U::*mem_ptr, INDEX index_settings = INDEX())
+                {
+                    if (get<INDEX>(mem_ptr) == nullptr)
+                    {
+                        std::unique_ptr<DeclaredIndex<TABLE>> index(
+                            new ColumnIndex<TABLE, T, INDEX>(mem_ptr, std::move(index_settings)));
+                        index->rebuild(table);
+                        m_indexes.push_back(std::move(index));
+                    }
+                }
+
+                void remove(size_t field_offset)
+                {
+                    m_indexes.erase(std::remove_if(m_indexes.begin(),
+                                                   m_indexes.end(),
+                                                   [field_offset](const std::unique_ptr<DeclaredIndex<TABLE>>& index) {
+                                                       return index->fieldOffset() == field_offset;
+                                                   }),
+                                    m_indexes.end());
+                }
+
+                void sync(const TABLE& table)
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        index->sync(table);
+                    }
+                }
+
+                void update(const TABLE& table, size_t row)
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        index->update(table, row);
+                    }
+                }
+
+                void erase(size_t row)
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        index->erase(row);
+                    }
+                }
+
+                void swapRemove(size_t row)
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        index->swapRemove(row);
+                    }
+                }
+
+                void rebuild(const TABLE& table)
+                {
+                    for (const auto& index : m_indexes)
+                    {
+                        index->rebuild(table);
+                    }
+                }
+
+              private:
+                std::vector<std::unique_ptr<DeclaredIndex<TABLE>>> m_indexes;
+            };
+        } // namespace detail
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_SECONDARY_INDEX_HPP
@@ -0,0 +1,345 @@
+#ifndef CT_EXT_SIMILARITY_HPP
+#define CT_EXT_SIMILARITY_HPP
+#include "QuantizedDataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        enum class Metric
+        {
+            // Larger is more similar
+            Dot,
+            Cosine,
+            // Squared euclidean distance, smaller is more similar
+            L2
+        };
+
+        struct SearchResult
+        {
+            size_t row;
+            float score;
+        };
+
+        namespace detail
+        {
+#if defined(__AVX512F__)
+            // _mm512_reduce_add_ps trips gcc's uninitialized warning, the masked extract does not
+            inline float horizontalSum16(__m512 v)
+            {
+                const __m512d wide = _mm512_castps_pd(v);
+                const __m256 lo = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, wide, 0));
+                const __m256 hi = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, wide, 1));
+                return horizontalSum8(_mm256_add_ps(lo, hi));
+            }
+#endif
+
+            inline float dotF32(const float* a, const float* b, size_t n)
+            {
+                size_t i = 0;
+                float sum = 0.0f;
+#if defined(__AVX512F__)
+                __m512 acc = _mm512_setzero_ps();
+                for (; i + 16 <= n; i += 16)
+                {
+                    acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc);
+                }
+                sum = horizontalSum16(acc);
+#elif defined(__AVX2__)
+                __m256 acc = _mm256_setzero_ps();
+                for (; i + 8 <= n; i += 8)
+                {
+                    acc = fmadd8(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc);
+                }
+                sum = horizontalSum8(acc);
+#endif
+                for (; i < n; ++i)
+                {
+                    sum += a[i] * b[i];
+                }
+                return sum;
+            }
+
+            inline float l2F32(const float* a, const float* b, size_t n)
+            {
+                size_t i = 0;
+                float sum = 0.0f;
+#if defined(__AVX512F__)
+                __m512 acc = _mm512_setzero_ps();
+                for (; i + 16 <= n; i += 16)
+                {
+                    const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+                    acc = _mm512_fmadd_ps(diff, diff, acc);
+                }
+                sum = horizontalSum16(acc);
+#elif defined(__AVX2__)
+                __m256 acc = _mm256_setzero_ps();
+                for (; i + 8 <= n; i += 8)
+                {
+                    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+                    acc = fmadd8(diff, diff, acc);
+                }
+                sum = horizontalSum8(acc);
+#endif
+                for (; i < n; ++i)
+                {
+                    const float diff = a[i] - b[i];
+                    sum += diff * diff;
+                }
+                return sum;
+            }
+
+            // dot(a, b) and dot(a, a) in one pass over a
+            inline float dotNormF32(const float* a, const float* b, size_t n, float& norm2)
+            {
+                size_t i = 0;
+                float sum = 0.0f;
+                norm2 = 0.0f;
+#if defined(__AVX512F__)
+                __m512 acc = _mm512_setzero_ps();
+                __m512 acc_norm = _mm512_setzero_ps();
+                for (; i + 16 <= n; i += 16)
+                {
+                    const __m512 va = _mm512_loadu_ps(a + i);
+                    acc = _mm512_fmadd_ps(va, _mm512_loadu_ps(b + i), acc);
+                    acc_norm = _mm512_fmadd_ps(va, va, acc_norm);
+                }
+                sum = horizontalSum16(acc);
+                norm2 = horizontalSum16(acc_norm);
+#elif defined(__AVX2__)
+                __m256 acc = _mm256_setzero_ps();
+                __m256 acc_norm = _mm256_setzero_ps();
+                for (; i + 8 <= n; i += 8)
+                {
+                    const __m256 va = _mm256_loadu_ps(a + i);
+                    acc = fmadd8(va, _mm256_loadu_ps(b + i), acc);
+                    acc_norm = fmadd8(va, va, acc_norm);
+                }
+                sum = horizontalSum8(acc);
+                norm2 = horizontalSum8(acc_norm);
+#endif
+                for (; i < n; ++i)
+                {
+                    sum += a[i] * b[i];
+                    norm2 += a[i] * a[i];
+                }
+                return sum;
+            }
+
+            inline float cosine(float dot, float norm2, float query_norm2)
+            {
+                const float denom = std::sqrt(norm2 * query_norm2);
+                return denom > 0.0f ? dot / denom : 0.0f;
+            }
+
+            // Keeps the k best rows seen, the worst of them at the front of the heap
+            class TopKHeap
+            {
+              public:
+                TopKHeap(size_t k, Metric metric) : m_k(k), m_metric(metric) { m_entries.reserve(k); }
+
+                void push(size_t row, float score)
+                {
+                    if (m_k == 0 || std::isnan(score))
+                    {
+                        return;
+                    }
+                    const Entry entry{row, score, m_metric == Metric::L2 ? -score : score};
+                    if (m_entries.size() < m_k)
+                    {
+                        m_entries.push_back(entry);
+                        std::push_heap(m_entries.begin(), m_entries.end(), better);
+                    }
+                    else if (better(entry, m_entries.front()))
+                    {
+                        std::pop_heap(m_entries.begin(), m_entries.end(), better);
+                        m_entries.back() = entry;
+                        std::push_heap(m_entries.begin(), m_entries.end(), better);
+                    }
+                }
+
+                void merge(const TopKHeap& other)
+                {
+                    for (const Entry& entry : other.m_entries)
+                    {
+                        push(entry.row, entry.score);
+                    }
+                }
+
+                // Best first, ties broken by row
+                std::vector<SearchResult> sorted() const
+                {
+                    std::vector<Entry> entries = m_entries;
+                    std::sort(entries.begin(), entries.end(), better);
+                    std::vector<SearchResult> out;
+                    out.reserve(entries.size());
+                    for (const Entry& entry : entries)
+                    {
+                        out.push_back(SearchResult{entry.row, entry.score});
+                    }
+                    return out;
+                }
+
+              private:
+                struct Entry
+                {
+                    size_t row;
+                    float score;
+                    float key;
+                };
+
+                static bool better(const Entry& lhs, const Entry& rhs)
+                {
+                    return lhs.key > rhs.key || (lhs.key == rhs.key && lhs.row < rhs.row);
+                }
+
+                size_t m_k;
+                Metric m_metric;
+                std::vector<Entry> m_entries;
+            };
+
+            // Contiguous rows [first, first + rows) of an embedding column, stride floats apart
+            struct EmbeddingBlock
+            {
+                const float* data;
+                size_t rows;
+                size_t stride;
+                size_t first;
+            };
+
+            template <class STORAGE>
+            std::vector<EmbeddingBlock> embeddingBlocks(const STORAGE& storage, size_t& dim)
+            {
+                static_assert(std::is_same<typename STORAGE::T, float>::value, "Embeddings need a float column");
+                static_assert(STORAGE::data_dim == 1, "Embeddings need a column of 1d arrays");
+                std::vector<EmbeddingBlock> blocks;
+                storage.forEachChunk([&blocks, &dim](mt::Tensor<const float, 2> chunk, size_t first) {
+                    const mt::Shape<2> shape = chunk.getShape();
+                    dim = shape[1];
+                    blocks.push_back(EmbeddingBlock{chunk.data(), shape[0], shape.getStride(0), first});
+                });
+                return blocks;
+            }
+
+            // Splits [0, num_rows) into num_threads contiguous ranges, scan(begin, end, heap) scores each range
+            template <class SCAN>
+            std::vector<SearchResult> selectTopK(size_t num_rows, size_t k, Metric metric, size_t num_threads,
+                                                 const SCAN& scan)
+            {
+                num_threads = std::max<size_t>(1, std::min(num_threads, num_rows));
+                std::vector<TopKHeap> heaps(num_threads, TopKHeap(k, metric));
+                if (num_threads == 1)
+                {
+                    scan(size_t(0), num_rows, heaps[0]);
+                    return heaps[0].sorted();
+                }
+                std::vector<std::thread> threads;
+                threads.reserve(num_threads);
+                for (size_t t = 0; t < num_threads; ++t)
+                {
+                    const size_t begin = num_rows * t / num_threads;
+                    const size_t end = num_rows * (t + 1) / num_threads;
+                    threads.emplace_back([&scan, &heaps, begin, end, t]() { scan(begin, end, heaps[t]); });
+                }
+                for (std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+                for (size_t t = 1; t < num_threads; ++t)
+                {
+                    heaps[0].merge(heaps[t]);
+                }
+                return heaps[0].sorted();
+            }
+        } // namespace detail
+
+        // The k rows of a float array column most similar to query, best first. query holds one value per element
+        // of a row. The rows are streamed chunk by chunk straight from the column tensor, with num_threads > 1 each
+        // thread scans a contiguous range of rows into its own heap.
+        template <class STORAGE>
+        std::vector<SearchResult> topK(const STORAGE& storage, const float* query, size_t k,
+                                       Metric metric = Metric::Dot, size_t num_threads = 1)
+        {
+            size_t dim = 0;
+            const std::vector<detail::EmbeddingBlock> blocks = detail::embeddingBlocks(storage, dim);
+            float query_norm2 = 0.0f;
+            detail::dotNormF32(query, query, dim, query_norm2);
+            auto scan = [&](size_t begin, size_t end, detail::TopKHeap& heap) {
+                for (const detail::EmbeddingBlock& block : blocks)
+                {
+                    const size_t lo = std::max(begin, block.first);
+                    const size_t hi = std::min(end, block.first + block.rows);
+                    for (size_t row = lo; row < hi; ++row)
+                    {
+                        const float* values = block.data + (row - block.first) * block.stride;
+                        float score = 0.0f;
+                        switch (metric)
+                        {
+                        case Metric::Dot:
+                            score = detail::dotF32(values, query, dim);
+                            break;
+                        case Metric::Cosine:
+                        {
+                            float norm2 = 0.0f;
+                            const float dot = detail::dotNormF32(values, query, dim, norm2);
+                            score = detail::cosine(dot, norm2, query_norm2);
+                            break;
+                        }
+                        case Metric::L2:
+                            score = detail::l2F32(values, query, dim);
+                            break;
+                        }
+                        heap.push(row, score);
+                    }
+                }
+            };
+            return detail::selectTopK(storage.size(), k, metric, num_threads, scan);
+        }
+
+        // Scores the codes of a quantized column directly, rows are never decoded to floats
+        template <class T_>
+        std::vector<SearchResult> topK(const QuantizedDataTableStorage<T_>& storage, const float* query, size_t k,
+                                       Metric metric = Metric::Dot, size_t num_threads = 1)
+        {
+            const size_t dim = storage.dim();
+            // |row|^2 is the squared distance to the origin
+            const std::vector<float> origin(dim, 0.0f);
+            float query_norm2 = 0.0f;
+            detail::dotNormF32(query, query, dim, query_norm2);
+            auto scan = [&](size_t begin, size_t end, detail::TopKHeap& heap) {
+                for (size_t row = begin; row < end; ++row)
+                {
+                    const auto codes = storage[row];
+                    float score = 0.0f;
+                    switch (metric)
+                    {
+                    case Metric::Dot:
+                        score = codes.dot(query);
+                        break;
+                    case Metric::Cosine:
+                        score = detail::cosine(codes.dot(query), codes.l2(origin.data()), query_norm2);
+                        break;
+                    case Metric::L2:
+                        score = codes.l2(query);
+                        break;
+                    }
+                    heap.push(row, score);
+                }
+            };
+            return detail::selectTopK(storage.size(), k, metric, num_threads, scan);
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_SIMILARITY_HPP
@@ -0,0 +1,533 @@
+#ifndef CT_EXT_SORT_HPP
+#define CT_EXT_SORT_HPP
+#include "Aggregate.hpp"
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        enum class SortOrder
+        {
+            Ascending,
+            Descending
+        };
+
+        namespace detail
+        {
+            // Unsigned key whose unsigned order is the order of the values, signed integers are offset by their
+            // minimum
+            template <class T, class E = void>
+            struct RadixKey;
+
+            template <class T>
+            struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value>::type>
+            {
+                using type = typename std::conditional<sizeof(T) <= 4, uint32_t, uint64_t>::type;
+
+                static type get(T value)
+                {
+                    return static_cast<type>(static_cast<type>(value) - static_cast<type>(std::numeric_limits<T>::min()));
+                }
+            };
+
+            // Positive floats get the sign bit set and negative floats are inverted, NaNs map to the largest key so
+            // they sort last
+            template <class T>
+            struct RadixKey<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+            {
+                using type = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+
+                static type get(T value)
+                {
+                    if (value != value)
+                    {
+                        return ~type(0);
+                    }
+                    type bits = 0;
+                    std::memcpy(&bits, &value, sizeof(T));
+                    const type sign = type(1) << (sizeof(type) * 8 - 1);
+                    return (bits & sign) != 0 ? ~bits : bits | sign;
+                }
+            };
+
+            template <class T>
+            using IsRadixKey = std::integral_constant<bool,
+                                                      std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+            // Stable LSD radix sort of order by keys[row], whose values fit in the low bits bits. Digits are 11 bits
+            // so 32 bit keys take three passes; all histograms are built in one pass and a digit that is the same for
+            // every row is skipped.
+            template <class K>
+            void radixSortOrder(const std::vector<K>& keys, std::vector<uint32_t>& order, uint32_t bits)
+            {
+                enum : uint32_t
+                {
+                    DIGIT_BITS = 11,
+                    NUM_BUCKETS = 1 << DIGIT_BITS,
+                    MASK = NUM_BUCKETS - 1
+                };
+                struct Item
+                {
+                    K key;
+                    uint32_t row;
+                };
+                const size_t n = order.size();
+                const uint32_t num_digits = (bits + DIGIT_BITS - 1) / DIGIT_BITS;
+                if (n < 2 || num_digits == 0)
+                {
+                    return;
+                }
+                std::unique_ptr<Item[]> items(new Item[n]);
+                std::unique_ptr<Item[]> scratch(new Item[n]);
+                std::vector<size_t> counts(num_digits * NUM_BUCKETS, 0);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const K key = keys[order[i]];
+                    items[i] = Item{key, order[i]};
+                    for (uint32_t digit = 0; digit < num_digits; ++digit)
+                    {
+                        ++counts[digit * NUM_BUCKETS + ((key >> (digit * DIGIT_BITS)) & MASK)];
+                    }
+                }
+                for (uint32_t digit = 0; digit < num_digits; ++digit)
+                {
+                    size_t* count = counts.data() + digit * NUM_BUCKETS;
+                    const uint32_t shift = digit * DIGIT_BITS;
+                    if (count[(items[0].key >> shift) & MASK] == n)
+                    {
+                        continue;
+                    }
+                    size_t offset = 0;
+                    for (size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+                    {
+                        const size_t c = count[bucket];
+                        count[bucket] = offset;
+                        offset += c;
+                    }
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        scratch[count[(items[i].key >> shift) & MASK]++] = items[i];
+                    }
+                    items.swap(scratch);
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    order[i] = items[i].row;
+                }
+            }
+
+            // Stable merge sort of order by less(row_a, row_b): num_threads runs are sorted in parallel, then merged
+            // pairwise with the merges of one level in parallel
+            template <class LESS>
+            void mergeSortOrder(std::vector<uint32_t>& order, const LESS& less, size_t num_threads)
+            {
+                const size_t n = order.size();
+                const size_t num_runs = std::max<size_t>(1, std::min(num_threads, n / 4096));
+                std::vector<size_t> bounds(num_runs + 1);
+                for (size_t run = 0; run <= num_runs; ++run)
+                {
+                    bounds[run] = run * n / num_runs;
+                }
+                const auto at = [&order](size_t i) { return order.begin() + static_cast<std::ptrdiff_t>(i); };
+                parallelFor(num_runs, num_threads, [&](size_t run) {
+                    std::stable_sort(at(bounds[run]), at(bounds[run + 1]), less);
+                });
+                for (size_t width = 1; width < num_runs; width *= 2)
+                {
+                    const size_t num_merges = (num_runs + 2 * width - 1) / (2 * width);
+                    parallelFor(num_merges, num_threads, [&](size_t merge) {
+                        const size_t first = merge * 2 * width;
+                        const size_t middle = std::min(first + width, num_runs);
+                        const size_t last = std::min(first + 2 * width, num_runs);
+                        std::inplace_merge(at(bounds[first]), at(bounds[middle]), at(bounds[last]), less);
+                    });
+                }
+            }
+
+            // The values of a column as MEMBERs, read through copyTo so any storage works
+            template <class MEMBER, class STORAGE>
+            std::unique_ptr<MEMBER[]> copyColumn(STORAGE& storage)
+            {
+                std::unique_ptr<MEMBER[]> values(new MEMBER[storage.size()]);
+                if (storage.size() != 0)
+                {
+                    storage.copyTo(values.get(), storage.size());
+                }
+                return values;
+            }
+
+            // Radix keys of a column shifted down by the smallest key, bits is set to the width of the largest
+            template <class MEMBER, class STORAGE>
+            std::vector<typename RadixKey<typename DataDimensionality<MEMBER>::DType>::type>
+            radixKeys(STORAGE& storage, uint32_t& bits)
+            {
+                using Value = typename DataDimensionality<MEMBER>::DType;
+                using Key = typename RadixKey<Value>::type;
+                const std::unique_ptr<MEMBER[]> values = copyColumn<MEMBER>(storage);
+                std::vector<Key> keys(storage.size());
+                Key lo = ~Key(0);
+                Key hi = 0;
+                for (size_t row = 0; row < keys.size(); ++row)
+                {
+                    const Key key = RadixKey<Value>::get(static_cast<Value>(values[row]));
+                    keys[row] = key;
+                    lo = std::min(lo, key);
+                    hi = std::max(hi, key);
+                }
+                bits = 0;
+                for (Key range = keys.empty() ? 0 : hi - lo; range != 0; range >>= 1)
+                {
+                    ++bits;
+                }
+                for (Key& key : keys)
+                {
+                    key -= lo;
+                }
+                return keys;
+            }
+
+            template <class MEMBER, class STORAGE>
+            void stableSortOrder(STORAGE& storage, std::vector<uint32_t>& order, size_t, std::true_type)
+            {
+                uint32_t bits = 0;
+                const auto keys = radixKeys<MEMBER>(storage, bits);
+                radixSortOrder(keys, order, bits);
+            }
+
+            template <class MEMBER, class STORAGE>
+            void stableSortOrder(STORAGE& storage, std::vector<uint32_t>& order, size_t num_threads, std::false_type)
+            {
+                const std::unique_ptr<MEMBER[]> values = copyColumn<MEMBER>(storage);
+                const MEMBER* data = values.get();
+                mergeSortOrder(order, [data](uint32_t lhs, uint32_t rhs) { return data[lhs] < data[rhs]; }, num_threads);
+            }
+
+            // Stable sort of order by the values of a scalar column, radix sorted for integer and floating point values
+            template <class MEMBER, class STORAGE>
+            void stableSortOrder(STORAGE& storage, std::vector<uint32_t>& order, size_t num_threads)
+            {
+                static_assert(DataDimensionality<MEMBER>::value == 0, "Sort keys must be scalar columns");
+                stableSortOrder<MEMBER>(
+                    storage, order, num_threads, IsRadixKey<typename DataDimensionality<MEMBER>::DType>());
+            }
+
+            template <class TABLE>
+            void sortOrderByKeys(TABLE&, std::vector<uint32_t>&, size_t)
+            {
+            }
+
+            // Stable sorts from the last key to the first leave the rows ordered by all keys
+            template <class TABLE, class U, class T, class... REST>
+            void sortOrderByKeys(TABLE& table, std::vector<uint32_t>& order, size_t num_threads, T U::*key,
+                                 REST... rest)
+            {
+                sortOrderByKeys(table, order, num_threads, rest...);
+                stableSortOrder<T>(table.storage(key), order, num_threads);
+            }
+
+            template <class... T>
+            struct AllRadixKeys : std::true_type
+            {
+            };
+
+            template <class T, class... REST>
+            struct AllRadixKeys<T, REST...>
+                : std::integral_constant<bool,
+                                         IsRadixKey<typename DataDimensionality<T>::DType>::value &&
+                                             AllRadixKeys<REST...>::value>
+            {
+            };
+
+            template <class TABLE>
+            bool packKeys(TABLE&, std::vector<uint64_t>&, uint32_t&)
+            {
+                return true;
+            }
+
+            // Packs the radix keys of the columns into packed, the last key in the low bits. Returns false if they do
+            // not fit in 64 bits.
+            template <class TABLE, class U, class T, class... REST>
+            bool packKeys(TABLE& table, std::vector<uint64_t>& packed, uint32_t& bits, T U::*key, REST... rest)
+            {
+                if (!packKeys(table, packed, bits, rest...))
+                {
+                    return false;
+                }
+                uint32_t width = 0;
+                const auto keys = radixKeys<T>(table.storage(key), width);
+                if (bits + width > 64)
+                {
+                    return false;
+                }
+                for (size_t row = 0; row < keys.size() && width != 0; ++row)
+                {
+                    packed[row] |= static_cast<uint64_t>(keys[row]) << bits;
+                }
+                bits += width;
+                return true;
+            }
+
+            template <class TABLE, class... U, class... T>
+            void sortOrder(TABLE& table, std::vector<uint32_t>& order, size_t num_threads, std::false_type,
+                           T U::*... keys)
+            {
+                sortOrderByKeys(table, order, num_threads, keys...);
+            }
+
+            // Integer and floating point keys whose value ranges fit in 64 bits together are packed into one key,
+            // sorted by a single radix sort
+            template <class TABLE, class... U, class... T>
+            void sortOrder(TABLE& table, std::vector<uint32_t>& order, size_t num_threads, std::true_type,
+                           T U::*... keys)
+            {
+                std::vector<uint64_t> packed(order.size(), 0);
+                uint32_t bits = 0;
+                if (!packKeys(table, packed, bits, keys...))
+                {
+                    sortOrderByKeys(table, order, num_threads, keys...);
+                }
+                else if (bits <= 32)
+                {
+                    radixSortOrder(std::vector<uint32_t>(packed.begin(), packed.end()), order, bits);
+                }
+                else
+                {
+                    radixSortOrder(packed, order, bits);
+                }
+            }
+
+            // Stable sort of order by the key columns of table, the first key first
+            template <class TABLE, class... U, class... T>
+            void sortOrder(TABLE& table, std::vector<uint32_t>& order, size_t num_threads, T U::*... keys)
+            {
+                sortOrder(table, order, num_threads, AllRadixKeys<T...>(), keys...);
+            }
+
+            template <class MEMBER, class STORAGE>
+            auto permuteColumn(STORAGE& storage, const std::vector<uint32_t>& order, int)
+                -> decltype(storage.permute(order))
+            {
+                return storage.permute(order);
+            }
+
+            // Storages without a permute member are rebuilt through copyTo and append. The values are read from a
+            // copy of the storage since array and ragged values are views into the storage they were read from.
+            template <class MEMBER, class STORAGE>
+            void permuteColumn(STORAGE& storage, const std::vector<uint32_t>& order, long)
+            {
+                STORAGE source = storage;
+                const std::unique_ptr<MEMBER[]> values = copyColumn<MEMBER>(source);
+                std::unique_ptr<MEMBER[]> permuted(new MEMBER[order.size()]);
+                for (size_t i = 0; i < order.size(); ++i)
+                {
+                    permuted[i] = values[order[i]];
+                }
+                storage.clear();
+                storage.append(permuted.get(), order.size());
+            }
+
+            // Row i of the column becomes row order[i] of the column before
+            template <class MEMBER, class STORAGE>
+            void permuteColumn(STORAGE& storage, const std::vector<uint32_t>& order)
+            {
+                assert(order.size() == storage.size());
+                permuteColumn<MEMBER>(storage, order, 0);
+            }
+
+            template <class OP>
+            struct BetterCompare;
+
+            template <>
+            struct BetterCompare<MinOp>
+            {
+                static constexpr const CompareOp value = CompareOp::Less;
+            };
+
+            template <>
+            struct BetterCompare<MaxOp>
+            {
+                static constexpr const CompareOp value = CompareOp::Greater;
+            };
+
+            // Collects the n best values of the rows it sees as candidate (value, row) pairs. Once n candidates are
+            // held, the n-th best is the threshold and only values better than it are appended, tested 64 at a time
+            // with the SIMD compares of the filters. The candidates are cut back to n with nth_element whenever they
+            // have grown enough to pay for it. NaNs are never collected.
+            template <class OP, class T>
+            class TopNAccumulator
+            {
+              public:
+                enum : size_t
+                {
+                    MIN_SLACK = 4096
+                };
+
+                explicit TopNAccumulator(size_t n) : m_n(n) { assert(n > 0); }
+
+                // Rows must be added in ascending order, a later row never displaces an equal value
+                void addSpan(const T* values, size_t count, size_t first_row)
+                {
+                    size_t i = 0;
+                    for (; i < count && !m_full; ++i)
+                    {
+                        if (values[i] == values[i])
+                        {
+                            append(values[i], first_row + i);
+                        }
+                    }
+                    for (; i < count; i += 64)
+                    {
+                        const size_t run = std::min<size_t>(64, count - i);
+                        for (uint64_t mask = compareWord<BetterCompare<OP>::value>(values + i, run, m_threshold);
+                             mask != 0;
+                             mask &= mask - 1)
+                        {
+                            const size_t j = i + static_cast<size_t>(countTrailingZeros64(mask));
+                            append(values[j], first_row + j);
+                        }
+                    }
+                }
+
+                // addSpan for each zone map block of the span whose bound could beat the threshold
+                void addSpan(const T* values, size_t count, size_t first_row, const ZoneMap<T>& zones)
+                {
+                    const size_t BLOCK_ROWS = ZoneMap<T>::BLOCK_ROWS;
+                    const size_t last_row = first_row + count;
+                    for (size_t begin = first_row; begin < last_row;)
+                    {
+                        const size_t block = begin / BLOCK_ROWS;
+                        const size_t end = std::min(last_row, (block + 1) * BLOCK_ROWS);
+                        if (!m_full || OP::better(OP::zoneBound(zones, block), m_threshold))
+                        {
+                            addSpan(values + (begin - first_row), end - begin, begin);
+                        }
+                        begin = end;
+                    }
+                }
+
+                void merge(const TopNAccumulator& other)
+                {
+                    for (const Candidate& candidate : other.m_candidates)
+                    {
+                        if (!m_full || better(candidate, m_threshold_candidate))
+                        {
+                            append(candidate.value, candidate.row);
+                        }
+                    }
+                }
+
+                // Rows of the best values, best first, ties broken by row
+                std::vector<uint32_t> rows()
+                {
+                    shrink();
+                    std::sort(m_candidates.begin(), m_candidates.end(), better);
+                    std::vector<uint32_t> out(m_candidates.size());
+                    for (size_t i = 0; i < out.size(); ++i)
+                    {
+                        out[i] = m_candidates[i].row;
+                    }
+                    return out;
+                }
+
+              private:
+                struct Candidate
+                {
+                    T value;
+                    uint32_t row;
+                };
+
+                static bool better(const Candidate& lhs, const Candidate& rhs)
+                {
+                    return OP::better(lhs.value, rhs.value) || (lhs.value == rhs.value && lhs.row < rhs.row);
+                }
+
+                void append(const T& value, size_t row)
+                {
+                    m_candidates.push_back(Candidate{value, static_cast<uint32_t>(row)});
+                    if ((!m_full && m_candidates.size() == m_n) ||
+                        m_candidates.size() >= m_n + std::max<size_t>(m_n, MIN_SLACK))
+                    {
+                        shrink();
+                    }
+                }
+
+                // Keeps the n best candidates and makes the worst of them the threshold
+                void shrink()
+                {
+                    if (m_candidates.size() < m_n)
+                    {
+                        return;
+                    }
+                    const auto nth = m_candidates.begin() + static_cast<std::ptrdiff_t>(m_n - 1);
+                    std::nth_element(m_candidates.begin(), nth, m_candidates.end(), better);
+                    m_candidates.resize(m_n);
+                    m_threshold_candidate = *nth;
+                    m_threshold = nth->value;
+                    m_full = true;
+                }
+
+                size_t m_n;
+                bool m_full = false;
+                T m_threshold = T();
+                Candidate m_threshold_candidate{};
+                std::vector<Candidate> m_candidates;
+            };
+
+            template <class OP, class STORAGE>
+            std::vector<uint32_t> topN(const STORAGE& storage, size_t n, const RowSelection& rows, size_t num_threads)
+            {
+                using T = typename STORAGE::T;
+                static_assert(STORAGE::data_dim == 0, "topN needs a scalar column");
+                size_t dim = 0;
+                const std::vector<ColumnBlock<T>> blocks = columnBlocks(storage, dim);
+                const size_t num_rows = storage.size();
+                using Acc = TopNAccumulator<OP, T>;
+                const ZoneMap<T>* zones = zoneMapOf(storage);
+                auto scan = [&](size_t first, size_t last, Acc& acc) {
+                    forEachSelectedSpan(blocks, rows, num_rows, first, last, [&acc, zones](const ColumnBlock<T>& span) {
+                        if (zones != nullptr)
+                        {
+                            acc.addSpan(span.data, span.rows, span.first, *zones);
+                        }
+                        else
+                        {
+                            acc.addSpan(span.data, span.rows, span.first);
+                        }
+                    });
+                };
+                return reduceRows(rows, num_rows, num_threads, Acc(n), scan).rows();
+            }
+        } // namespace detail
+
+        // Rows of the n best values of the selected rows of a scalar column, the largest first for
+        // SortOrder::Descending and the smallest first for Ascending, ties broken by row. NaNs are skipped so fewer
+        // than n rows come back if the selection holds fewer other values. Only the key column is read and never
+        // sorted as a whole: a threshold on the n-th best value seen so far filters the rows, zone map blocks that
+        // cannot beat it are skipped, and num_threads > 1 splits the selection into contiguous ranges.
+        template <class STORAGE>
+        std::vector<uint32_t> topN(const STORAGE& storage, size_t n, SortOrder order = SortOrder::Descending,
+                                   const RowSelection& rows = RowSelection(), size_t num_threads = 1)
+        {
+            if (n == 0)
+            {
+                return std::vector<uint32_t>();
+            }
+            if (order == SortOrder::Ascending)
+            {
+                return detail::topN<detail::MinOp>(storage, n, rows, num_threads);
+            }
+            return detail::topN<detail::MaxOp>(storage, n, rows, num_threads);
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_SORT_HPP
@@ -0,0 +1,462 @@
+#ifndef CT_EXT_STRING_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_STRING_DATA_TABLE_STORAGE_HPP
+#include "DataTableStorage.hpp"
+
+#include <ct/types/TArrayView.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        using StringRef = TArrayView<const char>;
+
+        // Member type for strings stored back to back in one byte buffer of the column
+        struct ArenaString : std::string
+        {
+            template <class... ARGS>
+            ArenaString(ARGS&&... args) : std::string(std::forward<ARGS>(args)...)
+            {
+            }
+
+            ArenaString(StringRef view) : std::string(view.data(), view.size()) {}
+        };
+
+        // Member type for low cardinality strings, such as class names. Each row holds a 32 bit code into a
+        // deduplicated dictionary of the column.
+        struct DictString : std::string
+        {
+            template <class... ARGS>
+            DictString(ARGS&&... args) : std::string(std::forward<ARGS>(args)...)
+            {
+            }
+
+            DictString(StringRef view) : std::string(view.data(), view.size()) {}
+        };
+
+        inline bool operator==(StringRef lhs, const std::string& rhs)
+        {
+            return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0;
+        }
+
+        inline bool operator!=(StringRef lhs, const std::string& rhs) { return !(lhs == rhs); }
+
+        // Strings packed back to back, string i spans [offsets[i], offsets[i + 1]) of the bytes
+        class StringArena
+        {
+          public:
+            StringArena() : m_offsets(1, 0) {}
+
+            StringRef operator[](size_t idx) const
+            {
+                return StringRef(m_bytes.data() + m_offsets[idx], length(idx));
+            }
+
+            size_t size() const { return m_offsets.size() - 1; }
+
+            size_t length(size_t idx) const { return static_cast<size_t>(m_offsets[idx + 1] - m_offsets[idx]); }
+
+            size_t numBytes() const { return m_bytes.size(); }
+
+            const std::vector<char>& bytes() const { return m_bytes; }
+
+            const std::vector<uint64_t>& offsets() const { return m_offsets; }
+
+            void reserve(size_t size) { m_offsets.reserve(size + 1); }
+
+            void reserveBytes(size_t bytes) { m_bytes.reserve(bytes); }
+
+            // New strings are empty
+            void resize(size_t size) { m_offsets.resize(size + 1, m_offsets.back()); }
+
+            void clear()
+            {
+                m_bytes.clear();
+                m_offsets.assign(1, 0);
+            }
+
+            void push_back(const char* str, size_t len)
+            {
+                m_bytes.insert(m_bytes.end(), str, str + len);
+                m_offsets.push_back(m_bytes.size());
+            }
+
+            // Replaces string idx, a string of a different length moves the bytes of the later strings
+            void assign(size_t idx, const char* str, size_t len)
+            {
+                // str may point into the arena
+                const std::vector<char> bytes(str, str + len);
+                const int64_t delta = static_cast<int64_t>(len) - static_cast<int64_t>(length(idx));
+                const auto first = m_bytes.begin() + static_cast<std::ptrdiff_t>(m_offsets[idx]);
+                m_bytes.insert(m_bytes.erase(first, first + static_cast<std::ptrdiff_t>(length(idx))), bytes.begin(), bytes.end());
+                for (size_t i = idx + 1; i < m_offsets.size(); ++i)
+                {
+                    m_offsets[i] = static_cast<uint64_t>(static_cast<int64_t>(m_offsets[i]) + delta);
+                }
+            }
+
+            void erase(size_t idx)
+            {
+                const uint64_t len = m_offsets[idx + 1] - m_offsets[idx];
+                m_bytes.erase(m_bytes.begin() + static_cast<std::ptrdiff_t>(m_offsets[idx]),
+                              m_bytes.begin() + static_cast<std::ptrdiff_t>(m_offsets[idx + 1]));
+                m_offsets.erase(m_offsets.begin() + static_cast<std::ptrdiff_t>(idx) + 1);
+                for (size_t i = idx + 1; i < m_offsets.size(); ++i)
+                {
+                    m_offsets[i] -= len;
+                }
+            }
+
+          private:
+            std::vector<char> m_bytes;
+            std::vector<uint64_t> m_offsets;
+        };
+
+        namespace detail
+        {
+            // FNV-1a
+            inline uint64_t hashBytes(const char* str, size_t len)
+            {
+                uint64_t hash = 14695981039346656037ull;
+                for (size_t i = 0; i < len; ++i)
+                {
+                    hash = (hash ^ static_cast<uint8_t>(str[i])) * 1099511628211ull;
+                }
+                return hash;
+            }
+
+            inline mt::Shape<2> stringShape(size_t len)
+            {
+                mt::Shape<2> shape;
+                shape.setShape(0, 1);
+                shape.setShape(1, static_cast<uint32_t>(len));
+                shape.calculateStride();
+                return shape;
+            }
+        } // namespace detail
+
+        // Deduplicated strings, codes are assigned in insertion order and stay valid for the life of the dictionary
+        class StringDictionary
+        {
+          public:
+            enum : uint32_t
+            {
+                NOT_FOUND = ~uint32_t(0)
+            };
+
+            StringRef operator[](uint32_t code) const { return m_strings[code]; }
+
+            size_t size() const { return m_strings.size(); }
+
+            const StringArena& strings() const { return m_strings; }
+
+            // Code of str, NOT_FOUND if it has not been inserted
+            uint32_t find(const char* str, size_t len) const
+            {
+                if (m_slots.empty())
+                {
+                    return NOT_FOUND;
+                }
+                const size_t mask = m_slots.size() - 1;
+                for (size_t slot = detail::hashBytes(str, len) & mask;; slot = (slot + 1) & mask)
+                {
+                    const uint32_t code = m_slots[slot];
+                    if (code == NOT_FOUND || equals(code, str, len))
+                    {
+                        return code;
+                    }
+                }
+            }
+
+            uint32_t find(const std::string& str) const { return find(str.data(), str.size()); }
+
+            // Code of str, inserting it if missing
+            uint32_t insert(const char* str, size_t len)
+            {
+                if ((m_strings.size() + 1) * 2 > m_slots.size())
+                {
+                    rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+                }
+                const size_t mask = m_slots.size() - 1;
+                size_t slot = detail::hashBytes(str, len) & mask;
+                for (; m_slots[slot] != NOT_FOUND; slot = (slot + 1) & mask)
+                {
+                    if (equals(m_slots[slot], str, len))
+                    {
+                        return m_slots[slot];
+                    }
+                }
+                const uint32_t code = static_cast<uint32_t>(m_strings.size());
+                m_strings.push_back(str, len);
+                m_slots[slot] = code;
+                return code;
+            }
+
+            uint32_t insert(const std::string& str) { return insert(str.data(), str.size()); }
+
+            void clear()
+            {
+                m_strings.clear();
+                m_slots.clear();
+            }
+
+          private:
+            bool equals(uint32_t code, const char* str, size_t len) const
+            {
+                const StringRef entry = m_strings[code];
+                return entry.size() == len && std::memcmp(entry.data(), str, len) == 0;
+            }
+
+            void rehash(size_t num_slots)
+            {
+                m_slots.assign(num_slots, uint32_t(NOT_FOUND));
+                const size_t mask = num_slots - 1;
+                for (uint32_t code = 0; code < m_strings.size(); ++code)
+                {
+                    const StringRef entry = m_strings[code];
+                    size_t slot = detail::hashBytes(entry.data(), entry.size()) & mask;
+                    while (m_slots[slot] != NOT_FOUND)
+                    {
+                        slot = (slot + 1) & mask;
+                    }
+                    m_slots[slot] = code;
+                }
+            }
+
+            StringArena m_strings;
+            std::vector<uint32_t> m_slots;
+        };
+
+        // String column in a single byte arena with per row offsets, one allocation for all rows instead of one per
+        // row. Rows are read as views into the arena. assign replaces a row in place, a string of a different length
+        // moves the bytes of the later rows and invalidates views into them.
+        template <class T_>
+        struct StringDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 1;
+            static constexpr const uint8_t storage_dim = 2;
+
+            using T = char;
+
+            StringRef operator[](size_t idx) const { return m_strings[idx]; }
+
+            // The bytes of row idx as a 1 x length tensor
+            mt::Tensor<char, 2> data(size_t idx = 0)
+            {
+                return mt::Tensor<char, 2>(const_cast<char*>(begin(idx)), shape(idx));
+            }
+
+            mt::Tensor<const char, 2> data(size_t idx = 0) const
+            {
+                return mt::Tensor<const char, 2>(begin(idx), shape(idx));
+            }
+
+            size_t size() const { return m_strings.size(); }
+
+            size_t length(size_t idx) const { return m_strings.length(idx); }
+
+            const StringArena& strings() const { return m_strings; }
+
+            void reserve(size_t size) { m_strings.reserve(size); }
+
+            void reserveBytes(size_t bytes) { m_strings.reserveBytes(bytes); }
+
+            // New rows are empty
+            void resize(size_t size) { m_strings.resize(size); }
+
+            void clear() { m_strings.clear(); }
+
+            void push_back(const T_& val) { m_strings.push_back(val.data(), val.size()); }
+
+            // Appends n rows spaced stride bytes apart, the arena is sized once for all rows
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                size_t bytes = m_strings.numBytes();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    bytes += reinterpret_cast<const T_*>(src + i * stride)->size();
+                }
+                m_strings.reserveBytes(bytes);
+                m_strings.reserve(size() + n);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const StringRef str = m_strings[start + i];
+                    reinterpret_cast<T_*>(dst + i * stride)->assign(str.data(), str.size());
+                }
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            void assign(size_t idx, const T_& val) { m_strings.assign(idx, val.data(), val.size()); }
+
+            void erase(uint32_t index) { m_strings.erase(index); }
+
+          private:
+            const char* begin(size_t idx) const
+            {
+                return m_strings.bytes().data() + (idx < size() ? m_strings.offsets()[idx] : m_strings.numBytes());
+            }
+
+            mt::Shape<2> shape(size_t idx) const { return detail::stringShape(idx < size() ? length(idx) : 0); }
+
+            StringArena m_strings;
+        };
+
+        // Dictionary encoded string column. The rows are a dense column of 32 bit codes, equality filters and group
+        // bys compare codes after a single dictionary lookup of the key.
+        template <class T_>
+        struct DictDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 0;
+            static constexpr const uint8_t storage_dim = 1;
+
+            using T = uint32_t;
+
+            enum : uint32_t
+            {
+                NOT_FOUND = StringDictionary::NOT_FOUND
+            };
+
+            StringRef operator[](size_t idx) const { return m_dictionary[m_codes[idx]]; }
+
+            // The codes starting at row idx
+            mt::Tensor<uint32_t, 1> data(size_t idx = 0) { return m_codes.data(idx); }
+            mt::Tensor<const uint32_t, 1> data(size_t idx = 0) const { return m_codes.data(idx); }
+
+            size_t size() const { return m_codes.size(); }
+
+            uint32_t code(size_t idx) const { return codes()[idx]; }
+
+            const uint32_t* codes() const { return m_codes.data().data(); }
+
+            const StringDictionary& dictionary() const { return m_dictionary; }
+
+            // Code of str, NOT_FOUND if no row has ever held it
+            uint32_t find(const std::string& str) const { return m_dictionary.find(str); }
+
+            // Calls fn(row) for every row equal to str
+            template <class F>
+            void forEachEqual(const std::string& str, F&& fn) const
+            {
+                const uint32_t key = find(str);
+                if (key == NOT_FOUND)
+                {
+                    return;
+                }
+                const uint32_t* ptr = codes();
+                const size_t n = size();
+                for (size_t row = 0; row < n; ++row)
+                {
+                    if (ptr[row] == key)
+                    {
+                        fn(row);
+                    }
+                }
+            }
+
+            void reserve(size_t size) { m_codes.reserve(size); }
+
+            // New rows are empty strings
+            void resize(size_t size)
+            {
+                const size_t start = m_codes.size();
+                m_codes.resize(size);
+                if (size > start)
+                {
+                    const uint32_t empty = m_dictionary.insert("", 0);
+                    uint32_t* ptr = m_codes.data().data();
+                    std::fill(ptr + start, ptr + size, empty);
+                }
+            }
+
+            void clear()
+            {
+                m_codes.clear();
+                m_dictionary.clear();
+            }
+
+            void push_back(const T_& val) { m_codes.push_back(m_dictionary.insert(val.data(), val.size())); }
+
+            void assign(size_t idx, const T_& val)
+            {
+                m_codes.data().data()[idx] = m_dictionary.insert(val.data(), val.size());
+            }
+
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                m_codes.reserve(size() + n);
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                assert(start + n <= size());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const StringRef str = (*this)[start + i];
+                    reinterpret_cast<T_*>(dst + i * stride)->assign(str.data(), str.size());
+                }
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            // The dictionary keeps the string of an erased row
+            void erase(uint32_t index) { m_codes.erase(index); }
+
+          private:
+            DataTableStorage<uint32_t> m_codes;
+            StringDictionary m_dictionary;
+        };
+
+        template <class T_>
+        struct HasDenseRows<StringDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class T_>
+        struct HasDenseRows<DictDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <>
+        struct ColumnStorage<ArenaString, void>
+        {
+            using type = StringDataTableStorage<ArenaString>;
+        };
+
+        template <>
+        struct ColumnStorage<DictString, void>
+        {
+            using type = DictDataTableStorage<DictString>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_STRING_DATA_TABLE_STORAGE_HPP
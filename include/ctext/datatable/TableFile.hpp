@@ -0,0 +1,461 @@
+#ifndef CT_EXT_TABLE_FILE_HPP
+#define CT_EXT_TABLE_FILE_HPP
+#include "../DataTable.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // On disk layout of a table snapshot:
+        //   TableFileHeader
+        //   TableColumnHeader for every column in declaration order
+        //   column data blocks, each starting on a 64 byte boundary
+        // A data block is the rows of the column back to back with the row stride of the column, thus a block can be
+        // read into a column with one read or used in place from a mapping of the file.
+        struct TableFileHeader
+        {
+            static constexpr const uint64_t magic_value = 0x4C42545458455443ULL; // "CTEXTTBL"
+            static constexpr const uint32_t current_version = 1;
+
+            uint64_t magic;
+            uint32_t version;
+            uint32_t num_columns;
+            uint64_t num_rows;
+            uint64_t row_size;
+        };
+
+        struct TableColumnHeader
+        {
+            static constexpr const size_t max_dims = 7;
+
+            uint64_t data_offset;
+            uint64_t data_bytes;
+            uint64_t field_offset;
+            uint32_t element_size;
+            uint32_t data_dim;
+            uint32_t shape[max_dims];
+            uint32_t row_stride;
+            char name[64];
+        };
+
+        static_assert(sizeof(TableFileHeader) == 32, "The table header is part of the file format");
+        static_assert(sizeof(TableColumnHeader) == 128, "The column header is part of the file format");
+
+        namespace detail
+        {
+            static constexpr const uint64_t table_file_alignment = 64;
+
+            inline uint64_t alignFileOffset(uint64_t offset)
+            {
+                return (offset + table_file_alignment - 1) / table_file_alignment * table_file_alignment;
+            }
+
+            inline std::string toString(StringView name)
+            {
+                std::ostringstream ss;
+                ss << name;
+                return ss.str();
+            }
+
+            inline void checkColumn(const TableColumnHeader& header,
+                                    const std::string& name,
+                                    size_t field_offset,
+                                    size_t element_size,
+                                    uint8_t data_dim)
+            {
+                if (header.field_offset != field_offset || header.element_size != element_size ||
+                    header.data_dim != data_dim)
+                {
+                    throw std::runtime_error("Column " + name + " does not match the reflected layout of the table");
+                }
+            }
+
+            inline const TableColumnHeader& findColumn(const std::vector<TableColumnHeader>& headers,
+                                                       const std::string& name)
+            {
+                for (const TableColumnHeader& header : headers)
+                {
+                    if (std::strncmp(header.name, name.c_str(), sizeof(header.name)) == 0)
+                    {
+                        return header;
+                    }
+                }
+                throw std::runtime_error("Column " + name + " is missing from the table file");
+            }
+
+            template <index_t I>
+            constexpr size_t numColumns(Indexer<I>)
+            {
+                return static_cast<size_t>(I) + 1;
+            }
+
+            template <class U>
+            void checkTableHeader(const TableFileHeader& header, size_t num_columns)
+            {
+                if (header.magic != TableFileHeader::magic_value)
+                {
+                    throw std::runtime_error("Not a table file");
+                }
+                if (header.version != TableFileHeader::current_version)
+                {
+                    throw std::runtime_error("Unsupported table file version " + std::to_string(header.version));
+                }
+                if (header.row_size != sizeof(U) || header.num_columns != num_columns)
+                {
+                    throw std::runtime_error("Table file does not match the reflected layout of the table");
+                }
+            }
+
+            // Throws unless the column holds num_rows rows whose row stride covers their elements and which fit in
+            // the column's data block, so a corrupt header can not point a read or a view past the block
+            inline void checkColumnExtent(const TableColumnHeader& header, const std::string& name, uint64_t num_rows)
+            {
+                const std::runtime_error corrupt("Column " + name + " does not fit its data block");
+                if (header.data_dim >= TableColumnHeader::max_dims || header.shape[0] != num_rows)
+                {
+                    throw corrupt;
+                }
+                uint64_t row_elements = 1;
+                for (uint32_t i = 1; i <= header.data_dim; ++i)
+                {
+                    row_elements *= header.shape[i];
+                    if (row_elements > header.row_stride)
+                    {
+                        throw corrupt;
+                    }
+                }
+                const uint64_t row_bytes = uint64_t(header.row_stride) * header.element_size;
+                if (row_bytes != 0 && num_rows > header.data_bytes / row_bytes)
+                {
+                    throw corrupt;
+                }
+            }
+
+            struct DescribeColumn
+            {
+                template <class S>
+                void operator()(StringView name, size_t field_offset, const S& storage)
+                {
+                    static_assert(S::storage_dim <= TableColumnHeader::max_dims, "Too many dimensions for a column");
+                    const std::string member = toString(name);
+                    if (member.size() >= sizeof(TableColumnHeader::name))
+                    {
+                        throw std::runtime_error("Member name too long for a table file: " + member);
+                    }
+                    TableColumnHeader header;
+                    std::memset(&header, 0, sizeof(header));
+                    const auto shape = storage.shape();
+                    for (uint8_t i = 0; i < S::storage_dim; ++i)
+                    {
+                        header.shape[i] = shape[i];
+                    }
+                    header.row_stride = static_cast<uint32_t>(shape.getStride(0));
+                    header.element_size = sizeof(typename S::T);
+                    header.data_dim = S::data_dim;
+                    header.field_offset = field_offset;
+                    header.data_bytes = uint64_t(shape[0]) * header.row_stride * header.element_size;
+                    std::memcpy(header.name, member.c_str(), member.size() + 1);
+                    headers.push_back(header);
+                }
+
+                std::vector<TableColumnHeader> headers;
+            };
+
+            struct WriteColumn
+            {
+                template <class S>
+                void operator()(StringView, size_t, const S& storage)
+                {
+                    const TableColumnHeader& header = headers[column++];
+                    pad(header.data_offset);
+                    storage.forEachChunk([this](mt::Tensor<const typename S::T, S::storage_dim> chunk, size_t) {
+                        const size_t bytes = size_t(chunk.getShape()[0]) * chunk.getShape().getStride(0) *
+                                             sizeof(typename S::T);
+                        os.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(bytes));
+                        offset += bytes;
+                    });
+                }
+
+                void pad(uint64_t to)
+                {
+                    static const char zeros[table_file_alignment] = {};
+                    os.write(zeros, static_cast<std::streamsize>(to - offset));
+                    offset = to;
+                }
+
+                std::ostream& os;
+                const std::vector<TableColumnHeader>& headers;
+                uint64_t offset;
+                size_t column;
+            };
+
+            struct ReadColumn
+            {
+                template <class S>
+                void operator()(StringView name, size_t field_offset, S& storage)
+                {
+                    using T = typename S::T;
+                    const std::string member = toString(name);
+                    const TableColumnHeader& header = findColumn(headers, member);
+                    checkColumn(header, member, field_offset, sizeof(T), S::data_dim);
+                    checkColumnExtent(header, member, num_rows);
+
+                    mt::Shape<S::storage_dim> shape;
+                    for (uint8_t i = 1; i < S::storage_dim; ++i)
+                    {
+                        shape.setShape(i, header.shape[i]);
+                    }
+                    shape.calculateStride();
+                    storage.clear();
+                    storage.resizeSubarray(shape);
+                    storage.resize(num_rows);
+
+                    const uint64_t file_row_bytes = uint64_t(header.row_stride) * sizeof(T);
+                    storage.forEachChunk([&](mt::Tensor<T, S::storage_dim> chunk, size_t first_row) {
+                        const size_t rows = chunk.getShape()[0];
+                        const size_t row_stride = chunk.getShape().getStride(0);
+                        is.seekg(static_cast<std::streamoff>(header.data_offset + first_row * file_row_bytes));
+                        if (row_stride == header.row_stride)
+                        {
+                            read(chunk.data(), rows * file_row_bytes);
+                            return;
+                        }
+                        // Row padding differs between the saving and the loading storage
+                        const size_t row_bytes = std::min<size_t>(row_stride, header.row_stride) * sizeof(T);
+                        for (size_t row = 0; row < rows; ++row)
+                        {
+                            read(chunk.data() + row * row_stride, row_bytes);
+                            is.seekg(static_cast<std::streamoff>(file_row_bytes - row_bytes), std::ios::cur);
+                        }
+                    });
+                }
+
+                void read(void* dst, size_t bytes)
+                {
+                    if (!is.read(static_cast<char*>(dst), static_cast<std::streamsize>(bytes)))
+                    {
+                        throw std::runtime_error("Table file is truncated");
+                    }
+                }
+
+                std::istream& is;
+                const std::vector<TableColumnHeader>& headers;
+                size_t num_rows;
+            };
+
+            template <class U, index_t I>
+            void checkReflectedColumn(const std::vector<TableColumnHeader>& headers, Indexer<I> idx)
+            {
+                const auto accessor = Reflect<U>::getPtr(idx);
+                using Member = typename std::decay<decltype(accessor.get(std::declval<const U&>()))>::type;
+                const std::string member = toString(accessor.getName());
+                checkColumn(findColumn(headers, member),
+                            member,
+                            memberOffset(accessor.m_ptr),
+                            sizeof(typename DataDimensionality<Member>::DType),
+                            DataDimensionality<Member>::value);
+            }
+
+            template <class U>
+            void checkReflectedColumns(const std::vector<TableColumnHeader>& headers, Indexer<0> idx)
+            {
+                checkReflectedColumn<U>(headers, idx);
+            }
+
+            template <class U, index_t I>
+            void checkReflectedColumns(const std::vector<TableColumnHeader>& headers, Indexer<I> idx)
+            {
+                checkReflectedColumn<U>(headers, idx);
+                checkReflectedColumns<U>(headers, --idx);
+            }
+        } // namespace detail
+
+        // Writes a snapshot of table, every column is written as one block with its shape
+        template <class U, template <class...> class STORAGE_POLICY>
+        void saveTable(const DataTable<U, STORAGE_POLICY>& table, std::ostream& os)
+        {
+            detail::DescribeColumn describe;
+            table.forEachColumn(describe);
+            std::vector<TableColumnHeader>& headers = describe.headers;
+
+            TableFileHeader header;
+            std::memset(&header, 0, sizeof(header));
+            header.magic = TableFileHeader::magic_value;
+            header.version = TableFileHeader::current_version;
+            header.num_columns = static_cast<uint32_t>(headers.size());
+            header.num_rows = table.size();
+            header.row_size = sizeof(U);
+
+            const uint64_t headers_end = sizeof(TableFileHeader) + headers.size() * sizeof(TableColumnHeader);
+            uint64_t offset = headers_end;
+            for (TableColumnHeader& column : headers)
+            {
+                column.data_offset = detail::alignFileOffset(offset);
+                offset = column.data_offset + column.data_bytes;
+            }
+
+            os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            os.write(reinterpret_cast<const char*>(headers.data()),
+                     static_cast<std::streamsize>(headers.size() * sizeof(TableColumnHeader)));
+            detail::WriteColumn write{os, headers, headers_end, 0};
+            table.forEachColumn(write);
+            if (!os)
+            {
+                throw std::runtime_error("Failed to write table file");
+            }
+        }
+
+        template <class U, template <class...> class STORAGE_POLICY>
+        void saveTable(const DataTable<U, STORAGE_POLICY>& table, const std::string& path)
+        {
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+            if (!ofs)
+            {
+                throw std::runtime_error("Unable to open " + path + " for writing");
+            }
+            saveTable(table, ofs);
+        }
+
+        // Replaces the content of table with a snapshot written by saveTable. The snapshot may come from a table
+        // with a different storage policy, the reflected layout of U must match.
+        template <class U, template <class...> class STORAGE_POLICY>
+        void loadTable(DataTable<U, STORAGE_POLICY>& table, std::istream& is)
+        {
+            TableFileHeader header;
+            if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            {
+                throw std::runtime_error("Table file is truncated");
+            }
+            detail::checkTableHeader<U>(header, detail::numColumns(Reflect<U>::end()));
+            std::vector<TableColumnHeader> headers(header.num_columns);
+            if (!is.read(reinterpret_cast<char*>(headers.data()),
+                         static_cast<std::streamsize>(headers.size() * sizeof(TableColumnHeader))))
+            {
+                throw std::runtime_error("Table file is truncated");
+            }
+            detail::ReadColumn read{is, headers, static_cast<size_t>(header.num_rows)};
+            table.forEachColumn(read);
+            table.reindex();
+        }
+
+        template <class U, template <class...> class STORAGE_POLICY>
+        void loadTable(DataTable<U, STORAGE_POLICY>& table, const std::string& path)
+        {
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs)
+            {
+                throw std::runtime_error("Unable to open " + path + " for reading");
+            }
+            loadTable(table, ifs);
+        }
+
+        // Read only, zero copy access to a table file. The file is mapped and columns are returned as tensors into
+        // the mapping, pages are loaded by the kernel on first access.
+        template <class U>
+        class TableFileView
+        {
+          public:
+            explicit TableFileView(const std::string& path)
+            {
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+                }
+                struct stat st;
+                if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TableFileHeader))
+                {
+                    ::close(fd);
+                    throw std::runtime_error(path + " is not a table file");
+                }
+                m_bytes = static_cast<size_t>(st.st_size);
+                void* base = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (base == MAP_FAILED)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Unable to map " + path);
+                }
+                m_base = static_cast<const uint8_t*>(base);
+                try
+                {
+                    detail::checkTableHeader<U>(header(), detail::numColumns(Reflect<U>::end()));
+                    if (m_bytes < sizeof(TableFileHeader) + header().num_columns * sizeof(TableColumnHeader))
+                    {
+                        throw std::runtime_error(path + " is truncated");
+                    }
+                    const TableColumnHeader* first =
+                        reinterpret_cast<const TableColumnHeader*>(m_base + sizeof(TableFileHeader));
+                    m_columns.assign(first, first + header().num_columns);
+                    for (const TableColumnHeader& column : m_columns)
+                    {
+                        if (column.data_bytes > m_bytes || column.data_offset > m_bytes - column.data_bytes)
+                        {
+                            throw std::runtime_error(path + " is truncated");
+                        }
+                        const std::string name(column.name, strnlen(column.name, sizeof(column.name)));
+                        detail::checkColumnExtent(column, name, header().num_rows);
+                    }
+                    detail::checkReflectedColumns<U>(m_columns, Reflect<U>::end());
+                }
+                catch (...)
+                {
+                    ::munmap(const_cast<uint8_t*>(m_base), m_bytes);
+                    throw;
+                }
+            }
+
+            TableFileView(const TableFileView&) = delete;
+            TableFileView& operator=(const TableFileView&) = delete;
+
+            ~TableFileView() { ::munmap(const_cast<uint8_t*>(m_base), m_bytes); }
+
+            size_t size() const { return header().num_rows; }
+
+            template <class T>
+            ConstTensorOf_t<T> column(T U::*mem_ptr) const
+            {
+                using DType = typename DataDimensionality<T>::DType;
+                constexpr uint8_t storage_dim = DataDimensionality<T>::value + 1;
+                const size_t offset = memberOffset(mem_ptr);
+                for (const TableColumnHeader& column : m_columns)
+                {
+                    if (column.field_offset == offset)
+                    {
+                        mt::Shape<storage_dim> shape;
+                        for (uint8_t i = 0; i < storage_dim; ++i)
+                        {
+                            shape.setShape(i, column.shape[i]);
+                        }
+                        shape.calculateStride();
+                        shape.setStride(0, column.row_stride);
+                        const DType* ptr = reinterpret_cast<const DType*>(m_base + column.data_offset);
+                        return ConstTensorOf_t<T>(ptr, shape);
+                    }
+                }
+                throw std::runtime_error("Member is not a column of the table file");
+            }
+
+          private:
+            const TableFileHeader& header() const { return *reinterpret_cast<const TableFileHeader*>(m_base); }
+
+            const uint8_t* m_base = nullptr;
+            size_t m_bytes = 0;
+            std::vector<TableColumnHeader> m_columns;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_TABLE_FILE_HPP
@@ -0,0 +1,187 @@
+#ifndef CT_EXT_DATA_TABLE_TRANSPOSE_HPP
+#define CT_EXT_DATA_TABLE_TRANSPOSE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace ct
+{
+    namespace ext
+    {
+        namespace detail
+        {
+            // Copies n elements of SIZE bytes between two buffers with arbitrary byte strides.
+            // The unrolled loop lets the compiler use wide moves for the fixed size memcpy.
+            template <size_t SIZE>
+            void stridedCopy(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    std::memcpy(dst + (i + 0) * dst_stride, src + (i + 0) * src_stride, SIZE);
+                    std::memcpy(dst + (i + 1) * dst_stride, src + (i + 1) * src_stride, SIZE);
+                    std::memcpy(dst + (i + 2) * dst_stride, src + (i + 2) * src_stride, SIZE);
+                    std::memcpy(dst + (i + 3) * dst_stride, src + (i + 3) * src_stride, SIZE);
+                }
+                for (; i < n; ++i)
+                {
+                    std::memcpy(dst + i * dst_stride, src + i * src_stride, SIZE);
+                }
+            }
+
+            // The vector paths address lanes with 32 bit byte offsets, so the whole vector must fit
+            inline bool fitsGatherIndex(size_t stride, size_t lanes)
+            {
+                return stride * (lanes - 1) <= static_cast<size_t>(std::numeric_limits<int32_t>::max());
+            }
+
+            template <size_t SIZE>
+            struct StridedTranspose
+            {
+                static void gather(const uint8_t* src, size_t stride, size_t n, uint8_t* dst)
+                {
+                    stridedCopy<SIZE>(src, stride, dst, SIZE, n);
+                }
+
+                static void scatter(const uint8_t* src, size_t n, uint8_t* dst, size_t stride)
+                {
+                    stridedCopy<SIZE>(src, SIZE, dst, stride, n);
+                }
+            };
+
+            template <>
+            struct StridedTranspose<4>
+            {
+                static void gather(const uint8_t* src, size_t stride, size_t n, uint8_t* dst)
+                {
+                    size_t i = 0;
+#if defined(__AVX512F__)
+                    if (fitsGatherIndex(stride, 16))
+                    {
+                        const __m512i idx = _mm512_mullo_epi32(
+                            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                            _mm512_set1_epi32(static_cast<int32_t>(stride)));
+                        // The masked form avoids gcc's maybe-uninitialized warning on the unmasked intrinsic
+                        const __m512i zero = _mm512_setzero_si512();
+                        for (; i + 16 <= n; i += 16)
+                        {
+                            const __m512i v = _mm512_mask_i32gather_epi32(zero, 0xFFFF, idx, src + i * stride, 1);
+                            _mm512_storeu_si512(dst + i * 4, v);
+                        }
+                    }
+#elif defined(__AVX2__)
+                    if (fitsGatherIndex(stride, 8))
+                    {
+                        const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                               _mm256_set1_epi32(static_cast<int32_t>(stride)));
+                        for (; i + 8 <= n; i += 8)
+                        {
+                            const __m256i v =
+                                _mm256_i32gather_epi32(reinterpret_cast<const int*>(src + i * stride), idx, 1);
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), v);
+                        }
+                    }
+#endif
+                    stridedCopy<4>(src + i * stride, stride, dst + i * 4, 4, n - i);
+                }
+
+                static void scatter(const uint8_t* src, size_t n, uint8_t* dst, size_t stride)
+                {
+                    size_t i = 0;
+#if defined(__AVX512F__)
+                    if (fitsGatherIndex(stride, 16))
+                    {
+                        const __m512i idx = _mm512_mullo_epi32(
+                            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                            _mm512_set1_epi32(static_cast<int32_t>(stride)));
+                        for (; i + 16 <= n; i += 16)
+                        {
+                            const __m512i v = _mm512_loadu_si512(src + i * 4);
+                            _mm512_i32scatter_epi32(dst + i * stride, idx, v, 1);
+                        }
+                    }
+#endif
+                    stridedCopy<4>(src + i * 4, 4, dst + i * stride, stride, n - i);
+                }
+            };
+
+            template <>
+            struct StridedTranspose<8>
+            {
+                static void gather(const uint8_t* src, size_t stride, size_t n, uint8_t* dst)
+                {
+                    size_t i = 0;
+#if defined(__AVX512F__)
+                    if (fitsGatherIndex(stride, 8))
+                    {
+                        const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                               _mm256_set1_epi32(static_cast<int32_t>(stride)));
+                        const __m512i zero = _mm512_setzero_si512();
+                        for (; i + 8 <= n; i += 8)
+                        {
+                            const __m512i v = _mm512_mask_i32gather_epi64(zero, 0xFF, idx, src + i * stride, 1);
+                            _mm512_storeu_si512(dst + i * 8, v);
+                        }
+                    }
+#elif defined(__AVX2__)
+                    if (fitsGatherIndex(stride, 4))
+                    {
+                        const __m128i idx =
+                            _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int32_t>(stride)));
+                        for (; i + 4 <= n; i += 4)
+                        {
+                            const __m256i v =
+                                _mm256_i32gather_epi64(reinterpret_cast<const long long*>(src + i * stride), idx, 1);
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 8), v);
+                        }
+                    }
+#endif
+                    stridedCopy<8>(src + i * stride, stride, dst + i * 8, 8, n - i);
+                }
+
+                static void scatter(const uint8_t* src, size_t n, uint8_t* dst, size_t stride)
+                {
+                    size_t i = 0;
+#if defined(__AVX512F__)
+                    if (fitsGatherIndex(stride, 8))
+                    {
+                        const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                               _mm256_set1_epi32(static_cast<int32_t>(stride)));
+                        for (; i + 8 <= n; i += 8)
+                        {
+                            const __m512i v = _mm512_loadu_si512(src + i * 8);
+                            _mm512_i32scatter_epi64(dst + i * stride, idx, v, 1);
+                        }
+                    }
+#endif
+                    stridedCopy<8>(src + i * 8, 8, dst + i * stride, stride, n - i);
+                }
+            };
+        } // namespace detail
+
+        // AoS -> SoA, copies n elements spaced stride bytes apart in src into the contiguous dst
+        template <class T>
+        void stridedGather(const void* src, size_t stride, size_t n, T* dst)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Transpose kernels require trivially copyable types");
+            detail::StridedTranspose<sizeof(T)>::gather(
+                static_cast<const uint8_t*>(src), stride, n, reinterpret_cast<uint8_t*>(dst));
+        }
+
+        // SoA -> AoS, copies n contiguous elements of src into dst spaced stride bytes apart
+        template <class T>
+        void stridedScatter(const T* src, size_t n, void* dst, size_t stride)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Transpose kernels require trivially copyable types");
+            detail::StridedTranspose<sizeof(T)>::scatter(
+                reinterpret_cast<const uint8_t*>(src), n, static_cast<uint8_t*>(dst), stride);
+        }
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_DATA_TABLE_TRANSPOSE_HPP
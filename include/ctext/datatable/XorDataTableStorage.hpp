@@ -0,0 +1,533 @@
+#ifndef CT_EXT_XOR_DATA_TABLE_STORAGE_HPP
+#define CT_EXT_XOR_DATA_TABLE_STORAGE_HPP
+#include "BitVector.hpp"
+#include "DataTableStorage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Member type for float time series compressed with the Gorilla XOR scheme
+        template <class T>
+        struct XorCompressed
+        {
+            static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                          "XorCompressed columns hold float or double");
+
+            XorCompressed(T value = T()) : m_value(value) {}
+
+            operator T() const { return m_value; }
+
+            T m_value;
+        };
+
+        template <class T>
+        struct DataDimensionality<XorCompressed<T>, void>
+        {
+            static constexpr const uint8_t value = 0;
+            using DType = T;
+            using TensorView = mt::Tensor<DType, value + 1>;
+            using ConstTensorView = mt::Tensor<const DType, value + 1>;
+        };
+
+        namespace detail
+        {
+            inline uint64_t maskBits(uint64_t value, uint32_t bits)
+            {
+                return bits >= 64 ? value : value & ((uint64_t(1) << bits) - 1);
+            }
+
+            class BitWriter
+            {
+              public:
+                explicit BitWriter(std::vector<uint64_t>& words) : m_words(words) {}
+
+                // Writes the low bits of value
+                void write(uint64_t value, uint32_t bits)
+                {
+                    if (bits == 0)
+                    {
+                        return;
+                    }
+                    m_words.resize((m_pos + bits + 63) / 64, 0);
+                    const uint32_t shift = m_pos % 64;
+                    m_words[m_pos / 64] |= value << shift;
+                    if (shift + bits > 64)
+                    {
+                        m_words[m_pos / 64 + 1] |= value >> (64 - shift);
+                    }
+                    m_pos += bits;
+                }
+
+                size_t position() const { return m_pos; }
+
+              private:
+                std::vector<uint64_t>& m_words;
+                size_t m_pos = 0;
+            };
+
+            class BitReader
+            {
+              public:
+                explicit BitReader(const uint64_t* words = nullptr) : m_words(words) {}
+
+                uint64_t read(uint32_t bits)
+                {
+                    if (bits == 0)
+                    {
+                        return 0;
+                    }
+                    const uint32_t shift = m_pos % 64;
+                    uint64_t value = m_words[m_pos / 64] >> shift;
+                    if (shift + bits > 64)
+                    {
+                        value |= m_words[m_pos / 64 + 1] << (64 - shift);
+                    }
+                    m_pos += bits;
+                    return maskBits(value, bits);
+                }
+
+              private:
+                const uint64_t* m_words;
+                size_t m_pos = 0;
+            };
+
+            template <class T>
+            struct XorTraits;
+
+            template <>
+            struct XorTraits<float>
+            {
+                using Bits = uint32_t;
+                static constexpr const uint32_t WIDTH = 32;
+                static constexpr const uint32_t LENGTH_BITS = 5;
+            };
+
+            template <>
+            struct XorTraits<double>
+            {
+                using Bits = uint64_t;
+                static constexpr const uint32_t WIDTH = 64;
+                static constexpr const uint32_t LENGTH_BITS = 6;
+            };
+
+            template <class T>
+            uint64_t floatBits(T value)
+            {
+                typename XorTraits<T>::Bits bits;
+                std::memcpy(&bits, &value, sizeof(T));
+                return bits;
+            }
+
+            template <class T>
+            T bitsFloat(uint64_t bits)
+            {
+                const typename XorTraits<T>::Bits narrow = static_cast<typename XorTraits<T>::Bits>(bits);
+                T value;
+                std::memcpy(&value, &narrow, sizeof(T));
+                return value;
+            }
+
+            // Encodes values as in Gorilla (Pelkonen et al. 2015): the first value raw, then the XOR with the previous
+            // value as '0' when equal, '10' + meaningful bits when they fit the previous leading / trailing zero window,
+            // else '11' + 5 bit leading zero count + meaningful bit count + meaningful bits.
+            template <class T>
+            size_t xorEncode(const T* values, size_t n, std::vector<uint64_t>& words)
+            {
+                using Traits = XorTraits<T>;
+                BitWriter writer(words);
+                uint64_t prev = 0;
+                uint32_t prev_leading = Traits::WIDTH;
+                uint32_t prev_trailing = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const uint64_t cur = floatBits(values[i]);
+                    if (i == 0)
+                    {
+                        writer.write(cur, Traits::WIDTH);
+                        prev = cur;
+                        continue;
+                    }
+                    const uint64_t x = cur ^ prev;
+                    prev = cur;
+                    if (x == 0)
+                    {
+                        writer.write(0, 1);
+                        continue;
+                    }
+                    const uint32_t leading = std::min<uint32_t>(countLeadingZeros64(x) - (64 - Traits::WIDTH), 31);
+                    const uint32_t trailing = countTrailingZeros64(x);
+                    if (leading >= prev_leading && trailing >= prev_trailing)
+                    {
+                        writer.write(0b01, 2);
+                        writer.write(x >> prev_trailing, Traits::WIDTH - prev_leading - prev_trailing);
+                    }
+                    else
+                    {
+                        const uint32_t length = Traits::WIDTH - leading - trailing;
+                        writer.write(0b11, 2);
+                        writer.write(leading, 5);
+                        writer.write(length - 1, Traits::LENGTH_BITS);
+                        writer.write(x >> trailing, length);
+                        prev_leading = leading;
+                        prev_trailing = trailing;
+                    }
+                }
+                return writer.position();
+            }
+        } // namespace detail
+
+        // Streaming decoder over one encoded segment
+        template <class T>
+        class XorDecoder
+        {
+          public:
+            XorDecoder() = default;
+
+            XorDecoder(const uint64_t* words, size_t count) : m_reader(words), m_remaining(count) {}
+
+            size_t remaining() const { return m_remaining; }
+
+            T next()
+            {
+                using Traits = detail::XorTraits<T>;
+                assert(m_remaining > 0);
+                --m_remaining;
+                if (m_first)
+                {
+                    m_first = false;
+                    m_prev = m_reader.read(Traits::WIDTH);
+                }
+                else if (m_reader.read(1) != 0)
+                {
+                    if (m_reader.read(1) != 0)
+                    {
+                        const uint32_t leading = static_cast<uint32_t>(m_reader.read(5));
+                        m_length = static_cast<uint32_t>(m_reader.read(Traits::LENGTH_BITS)) + 1;
+                        m_trailing = Traits::WIDTH - leading - m_length;
+                    }
+                    m_prev ^= m_reader.read(m_length) << m_trailing;
+                }
+                return detail::bitsFloat<T>(m_prev);
+            }
+
+            void skip(size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    next();
+                }
+            }
+
+          private:
+            detail::BitReader m_reader;
+            size_t m_remaining = 0;
+            uint64_t m_prev = 0;
+            uint32_t m_length = 0;
+            uint32_t m_trailing = 0;
+            bool m_first = true;
+        };
+
+        // Append only float column made of XOR compressed sealed segments followed by a raw hot segment. New rows go
+        // to the hot segment, seal() compresses it into a new sealed segment. Sealed rows are decoded by streaming
+        // through their segment, so random access costs O(segment length), scans should use the iterators or decode.
+        template <class T_>
+        struct XorDataTableStorage
+        {
+            static constexpr const uint8_t data_dim = 0;
+            static constexpr const uint8_t storage_dim = 1;
+
+            using T = typename DataDimensionality<T_>::DType;
+
+            class const_iterator
+            {
+              public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T*;
+                using reference = T;
+
+                // Positioned at any row, a sealed row is reached by skipping through its segment
+                const_iterator(const XorDataTableStorage* storage, size_t row) : m_storage(storage), m_row(row)
+                {
+                    if (m_row < m_storage->sealedRows())
+                    {
+                        m_segment = m_storage->segmentOf(m_row);
+                        m_decoder = m_storage->decoder(m_segment);
+                        m_decoder.skip(m_row - m_storage->m_starts[m_segment]);
+                    }
+                    load();
+                }
+
+                T operator*() const { return m_value; }
+
+                const_iterator& operator++()
+                {
+                    ++m_row;
+                    load();
+                    return *this;
+                }
+
+                bool operator==(const const_iterator& other) const { return m_row == other.m_row; }
+                bool operator!=(const const_iterator& other) const { return m_row != other.m_row; }
+
+              private:
+                void load()
+                {
+                    if (m_row >= m_storage->size())
+                    {
+                        return;
+                    }
+                    if (m_row >= m_storage->sealedRows())
+                    {
+                        m_value = m_storage->m_hot[m_row - m_storage->sealedRows()];
+                        return;
+                    }
+                    if (m_decoder.remaining() == 0)
+                    {
+                        m_decoder = m_storage->decoder(++m_segment);
+                    }
+                    m_value = m_decoder.next();
+                }
+
+                const XorDataTableStorage* m_storage;
+                size_t m_row;
+                size_t m_segment = 0;
+                XorDecoder<T> m_decoder;
+                T m_value = T();
+            };
+
+            T_ operator[](size_t idx) const { return T_(get(idx)); }
+
+            T get(size_t idx) const
+            {
+                if (idx >= sealedRows())
+                {
+                    return m_hot[idx - sealedRows()];
+                }
+                const size_t s = segmentOf(idx);
+                XorDecoder<T> dec = decoder(s);
+                dec.skip(idx - m_starts[s]);
+                return dec.next();
+            }
+
+            // The raw rows of the hot segment, starting at row idx or at the first hot row
+            mt::Tensor<T, 1> data(size_t idx = 0)
+            {
+                const size_t offset = idx > sealedRows() ? idx - sealedRows() : 0;
+                return mt::Tensor<T, 1>(m_hot.data() + offset, m_hot.size() - std::min(offset, m_hot.size()));
+            }
+
+            mt::Tensor<const T, 1> data(size_t idx = 0) const
+            {
+                const size_t offset = idx > sealedRows() ? idx - sealedRows() : 0;
+                return mt::Tensor<const T, 1>(m_hot.data() + offset, m_hot.size() - std::min(offset, m_hot.size()));
+            }
+
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, size()); }
+
+            size_t size() const { return m_sealed_rows + m_hot.size(); }
+
+            size_t sealedRows() const { return m_sealed_rows; }
+
+            size_t numSegments() const { return m_segments.size(); }
+
+            // Decoder positioned at the first row of sealed segment s
+            XorDecoder<T> decoder(size_t s) const
+            {
+                return XorDecoder<T>(m_segments[s].words.data(), m_segments[s].rows);
+            }
+
+            // Bytes used by the sealed segments and the hot rows
+            size_t memoryBytes() const
+            {
+                size_t bytes = m_hot.size() * sizeof(T);
+                for (const Segment& segment : m_segments)
+                {
+                    bytes += segment.words.size() * sizeof(uint64_t) + sizeof(Segment);
+                }
+                return bytes;
+            }
+
+            // Compresses the hot rows into a new sealed segment
+            void seal()
+            {
+                if (m_hot.empty())
+                {
+                    return;
+                }
+                pushSegment(m_hot.data(), m_hot.size());
+                m_hot.clear();
+            }
+
+            // Decodes rows [start, start + n), streaming through each sealed segment once
+            void decode(size_t start, size_t n, T* out) const
+            {
+                assert(start + n <= size());
+                size_t i = 0;
+                for (size_t s = start < sealedRows() ? segmentOf(start) : m_segments.size(); s < m_segments.size() && i < n;
+                     ++s)
+                {
+                    XorDecoder<T> dec = decoder(s);
+                    const size_t row = start + i;
+                    dec.skip(row - m_starts[s]);
+                    for (; i < n && dec.remaining() > 0; ++i)
+                    {
+                        out[i] = dec.next();
+                    }
+                }
+                for (; i < n; ++i)
+                {
+                    out[i] = m_hot[start + i - sealedRows()];
+                }
+            }
+
+            void reserve(size_t size) { m_hot.reserve(size > sealedRows() ? size - sealedRows() : 0); }
+
+            // New rows are zero and hot
+            void resize(size_t size)
+            {
+                if (size < sealedRows())
+                {
+                    truncateSealed(size);
+                }
+                m_hot.resize(size - sealedRows(), T());
+            }
+
+            void clear()
+            {
+                m_segments.clear();
+                m_starts.clear();
+                m_hot.clear();
+                m_sealed_rows = 0;
+            }
+
+            void push_back(const T_& val) { m_hot.push_back(static_cast<T>(val)); }
+
+            void append(const T_* first, size_t n, size_t stride = sizeof(T_))
+            {
+                m_hot.reserve(m_hot.size() + n);
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    push_back(*reinterpret_cast<const T_*>(src + i * stride));
+                }
+            }
+
+            void copyTo(T_* first, size_t n, size_t stride = sizeof(T_), size_t start = 0) const
+            {
+                std::vector<T> rows(n);
+                decode(start, n, rows.data());
+                uint8_t* dst = reinterpret_cast<uint8_t*>(first);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    *reinterpret_cast<T_*>(dst + i * stride) = T_(rows[i]);
+                }
+            }
+
+            template <class SHAPE>
+            void resizeSubarray(SHAPE)
+            {
+            }
+
+            // Erasing a sealed row decodes and encodes its segment again
+            void erase(uint32_t index)
+            {
+                if (index >= sealedRows())
+                {
+                    m_hot.erase(m_hot.begin() + static_cast<std::ptrdiff_t>(index - sealedRows()));
+                    return;
+                }
+                const size_t s = segmentOf(index);
+                std::vector<T> rows(m_segments[s].rows);
+                decode(m_starts[s], rows.size(), rows.data());
+                rows.erase(rows.begin() + static_cast<std::ptrdiff_t>(index - m_starts[s]));
+                m_segments[s].words.clear();
+                m_segments[s].rows = rows.size();
+                detail::xorEncode(rows.data(), rows.size(), m_segments[s].words);
+                for (size_t i = s + 1; i < m_starts.size(); ++i)
+                {
+                    --m_starts[i];
+                }
+                --m_sealed_rows;
+                if (rows.empty())
+                {
+                    m_segments.erase(m_segments.begin() + static_cast<std::ptrdiff_t>(s));
+                    m_starts.erase(m_starts.begin() + static_cast<std::ptrdiff_t>(s));
+                }
+            }
+
+          private:
+            struct Segment
+            {
+                std::vector<uint64_t> words;
+                size_t rows = 0;
+            };
+
+            size_t segmentOf(size_t idx) const
+            {
+                return static_cast<size_t>(std::upper_bound(m_starts.begin(), m_starts.end(), idx) - m_starts.begin()) -
+                       1;
+            }
+
+            void pushSegment(const T* rows, size_t n)
+            {
+                Segment segment;
+                segment.rows = n;
+                detail::xorEncode(rows, n, segment.words);
+                segment.words.shrink_to_fit();
+                m_segments.push_back(std::move(segment));
+                m_starts.push_back(m_sealed_rows);
+                m_sealed_rows += n;
+            }
+
+            // Keeps the first size rows, the segment holding row size is encoded again, the hot rows are dropped
+            void truncateSealed(size_t size)
+            {
+                const size_t s = segmentOf(size);
+                std::vector<T> rows(size - m_starts[s]);
+                decode(m_starts[s], rows.size(), rows.data());
+                m_segments.resize(s);
+                m_starts.resize(s);
+                m_sealed_rows = size - rows.size();
+                m_hot.clear();
+                if (!rows.empty())
+                {
+                    pushSegment(rows.data(), rows.size());
+                }
+            }
+
+            std::vector<Segment> m_segments;
+            std::vector<size_t> m_starts;
+            std::vector<T> m_hot;
+            size_t m_sealed_rows = 0;
+        };
+
+        template <class T_>
+        struct HasDenseRows<XorDataTableStorage<T_>> : std::false_type
+        {
+        };
+
+        template <class T_>
+        struct IsAppendOnly<XorDataTableStorage<T_>> : std::true_type
+        {
+        };
+
+        template <class T>
+        struct ColumnStorage<XorCompressed<T>>
+        {
+            using type = XorDataTableStorage<XorCompressed<T>>;
+        };
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_XOR_DATA_TABLE_STORAGE_HPP
@@ -0,0 +1,126 @@
+#ifndef CT_EXT_ZONE_MAP_HPP
+#define CT_EXT_ZONE_MAP_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ct
+{
+    namespace ext
+    {
+        // Per block summary of a scalar column: the smallest and largest value of every BLOCK_ROWS rows and whether
+        // the block holds a NaN. The bounds ignore NaNs and only have to enclose the values, so a block whose values
+        // are overwritten may keep wider bounds than it needs. A block of NaNs only has bounds max < min.
+        template <class T>
+        class ZoneMap
+        {
+          public:
+            enum : size_t
+            {
+                BLOCK_ROWS = 4096
+            };
+
+            // Number of rows summarized
+            size_t size() const { return m_size; }
+
+            size_t numBlocks() const { return m_min.size(); }
+
+            const T& min(size_t block) const { return m_min[block]; }
+
+            const T& max(size_t block) const { return m_max[block]; }
+
+            bool hasNan(size_t block) const { return m_nan[block] != 0; }
+
+            // Summarizes n more rows
+            void extend(const T* values, size_t n)
+            {
+                for (size_t i = 0; i < n;)
+                {
+                    const size_t block = m_size / BLOCK_ROWS;
+                    if (block == m_min.size())
+                    {
+                        m_min.push_back(std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                                             : std::numeric_limits<T>::max());
+                        m_max.push_back(std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                                             : std::numeric_limits<T>::lowest());
+                        m_nan.push_back(0);
+                    }
+                    const size_t count = std::min(n - i, BLOCK_ROWS - m_size % BLOCK_ROWS);
+                    // Comparisons with NaN are false, so NaNs leave the bounds alone without a branch
+                    T lo = m_min[block];
+                    T hi = m_max[block];
+                    bool nan = false;
+                    for (size_t j = i; j < i + count; ++j)
+                    {
+                        const T value = values[j];
+                        lo = value < lo ? value : lo;
+                        hi = value > hi ? value : hi;
+                        nan |= value != value;
+                    }
+                    m_min[block] = lo;
+                    m_max[block] = hi;
+                    m_nan[block] |= nan;
+                    i += count;
+                    m_size += count;
+                }
+            }
+
+            // Widens the bounds of the block holding row to include value
+            void widen(size_t row, const T& value)
+            {
+                const size_t block = row / BLOCK_ROWS;
+                if (value != value)
+                {
+                    m_nan[block] = 1;
+                    return;
+                }
+                m_min[block] = std::min(m_min[block], value);
+                m_max[block] = std::max(m_max[block], value);
+            }
+
+            // Forgets rows from row on, the rows of the block holding row that are kept must be summarized again with
+            // extend
+            void truncate(size_t row)
+            {
+                const size_t block = std::min(row, m_size) / BLOCK_ROWS;
+                m_min.resize(block);
+                m_max.resize(block);
+                m_nan.resize(block);
+                m_size = block * BLOCK_ROWS;
+            }
+
+            void clear() { truncate(0); }
+
+          private:
+            size_t m_size = 0;
+            std::vector<T> m_min;
+            std::vector<T> m_max;
+            std::vector<uint8_t> m_nan;
+        };
+
+        namespace detail
+        {
+            template <class STORAGE>
+            auto zoneMapOf(const STORAGE& storage, int) -> decltype(storage.zoneMap())
+            {
+                return storage.zoneMap();
+            }
+
+            template <class STORAGE>
+            const ZoneMap<typename STORAGE::T>* zoneMapOf(const STORAGE&, long)
+            {
+                return nullptr;
+            }
+
+            // The zone map of a storage, nullptr if it has none or it is out of date
+            template <class STORAGE>
+            const ZoneMap<typename STORAGE::T>* zoneMapOf(const STORAGE& storage)
+            {
+                return zoneMapOf(storage, 0);
+            }
+        } // namespace detail
+    } // namespace ext
+} // namespace ct
+#endif // CT_EXT_ZONE_MAP_HPP
@@ -1,6 +1,13 @@
 #ifndef CT_EXT_DATA_TABLE_PRINT_HPP
 #define CT_EXT_DATA_TABLE_PRINT_HPP
+#include "Filter.hpp"
 #include "IDataTable.hpp"
+#include "NullableDataTableStorage.hpp"
+#include "QuantizedDataTableStorage.hpp"
+
+#include <ct/types/TArrayView.hpp>
+
+#include <ostream>
 
 namespace ct
 {
@@ -35,63 +42,80 @@ namespace ct
             printTableHeaderRecurse<T>(os, ct::Reflect<T>::end());
         }
 
-        template <class T, index_t I, class PTR>
-        void printTableElement(std::ostream& os, const ext::IDataTable<T>& table, size_t i, Indexer<I>, PTR ptr)
+        template <class V>
+        void printValue(std::ostream& os, const V& value, long)
         {
-            auto begin = table.begin(ptr.m_ptr);
-            if (I != 0)
-            {
-                os << ", ";
-            }
-            os << begin[i];
+            os << value;
         }
 
-        template <class T, index_t I, class DTYPE, class U, Flag_t FLAGS, class MDATA>
-        void printTableElement(std::ostream& os,
-                               const ext::IDataTable<T>& table,
-                               size_t i,
-                               Indexer<I>,
-                               MemberObjectPointer<TArrayView<DTYPE> U::*, FLAGS, MDATA> ptr)
+        template <class V>
+        void printValues(std::ostream& os, const V& values)
         {
-            auto tensor = table.begin(ptr.m_ptr);
-            if (I != 0)
-            {
-                os << ", ";
-            }
-            auto shape = tensor.getShape();
-            for (size_t j = 0; j < shape[1]; ++j)
+            for (size_t j = 0; j < values.size(); ++j)
             {
                 if (j != 0)
                 {
                     os << ' ';
                 }
-                os << tensor(i, j);
+                os << values[j];
+            }
+        }
+
+        template <class V>
+        auto printValue(std::ostream& os, const V& values, int)
+            -> EnableIf<IsBase<Base<TArrayViewTag>, Derived<V>>::value>
+        {
+            printValues(os, values);
+        }
+
+        template <class Q>
+        void printValue(std::ostream& os, const Quantized<Q>& values, int)
+        {
+            printValues(os, values);
+        }
+
+        template <class V>
+        void printValue(std::ostream& os, const Nullable<V>& value, int)
+        {
+            if (value.isNull())
+            {
+                os << "null";
+                return;
             }
+            printValue(os, *value, 0);
         }
 
         template <class T, index_t I>
-        void printTableElement(std::ostream& os, const ext::IDataTable<T>& table, size_t i, Indexer<I> idx)
+        void printTableElement(std::ostream& os, const T& row, Indexer<I> idx)
         {
-            printTableElement(os, table, i, idx, Reflect<T>::getPtr(idx));
+            if (I != 0)
+            {
+                os << ", ";
+            }
+            printValue(os, Reflect<T>::getPtr(idx).get(row), 0);
         }
 
         template <class T>
-        void printTableElementRecurse(std::ostream& os, const ext::IDataTable<T>& table, size_t i, Indexer<0> idx)
+        void printTableElementRecurse(std::ostream& os, const T& row, Indexer<0> idx)
         {
-            printTableElement(os, table, i, idx);
+            printTableElement(os, row, idx);
         }
 
         template <class T, index_t I>
-        void printTableElementRecurse(std::ostream& os, const ext::IDataTable<T>& table, size_t i, Indexer<I> idx)
+        void printTableElementRecurse(std::ostream& os, const T& row, Indexer<I> idx)
         {
-            printTableElementRecurse(os, table, i, --idx);
-            printTableElement(os, table, i, idx);
+            printTableElementRecurse(os, row, --idx);
+            printTableElement(os, row, idx);
         }
 
+        // Rows are read through populateData, so packed, encoded and offset columns without a pointer range print
+        // like any other. populateData is not const since array members view the column, the row is only read.
         template <class T>
         void printTableElement(std::ostream& os, const ext::IDataTable<T>& table, size_t i)
         {
-            printTableElementRecurse(os, table, i, Reflect<T>::end());
+            T row;
+            const_cast<ext::IDataTable<T>&>(table).populateData(row, i);
+            printTableElementRecurse(os, row, Reflect<T>::end());
         }
 
         template <class T>
@@ -102,10 +126,37 @@ namespace ct
             auto size = table.size();
             for (size_t i = 0; i < size; ++i)
             {
+                if (table.isTombstone(i))
+                {
+                    continue;
+                }
                 printTableElement(os, table, i);
-                std::cout << std::endl;
+                os << std::endl;
             }
         }
+
+        // Prints only the selected rows, e.g. the output of a filter. Tombstoned rows are skipped like in a scan.
+        template <class T>
+        void printTable(std::ostream& os, const ext::IDataTable<T>& table, const SelectionVector& selection)
+        {
+            printTableHeader<T>(os);
+            os << std::endl;
+            for (uint32_t i : selection)
+            {
+                if (table.isTombstone(i))
+                {
+                    continue;
+                }
+                printTableElement(os, table, i);
+                os << std::endl;
+            }
+        }
+
+        template <class T>
+        void printTable(std::ostream& os, const ext::IDataTable<T>& table, const BitVector& selection)
+        {
+            printTable(os, table, toSelection(selection));
+        }
     } // namespace ext
 } // namespace ct
 
@@ -1,12 +1,26 @@
 
 #include "ctext/DataTable.hpp"
+#include "ctext/datatable/IvfIndex.hpp"
+#include "ctext/datatable/MmapStorage.hpp"
+#include "ctext/datatable/SecondaryIndex.hpp"
+#include "ctext/datatable/TableFile.hpp"
 #include <ct/reflect/compare.hpp>
 #include <ct/reflect/print.hpp>
 #include <ct/static_asserts.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 #include <gtest/gtest.h>
 
@@ -291,6 +305,149 @@ TEST(datatable, push)
     }
 }
 
+TEST(datatable, append)
+{
+    std::vector<TestB> vec;
+    auto val = TestData<TestB>::init();
+    for (size_t i = 0; i < 20; ++i)
+    {
+        vec.push_back(val);
+        inc(val);
+    }
+
+    ct::ext::DataTable<TestB> table;
+    table.append(vec.data(), 5);
+    table.append(vec.data() + 5, 0);
+    EXPECT_EQ(table.size(), 5);
+    table.append(vec.data() + 5, vec.size() - 5);
+    EXPECT_EQ(table.size(), 20);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(table.access(i), vec[i]);
+    }
+}
+
+TEST(datatable, append_dyn_array)
+{
+    std::vector<float> embeddings(40);
+    for (size_t i = 0; i < embeddings.size(); ++i)
+    {
+        embeddings[i] = static_cast<float>(i);
+    }
+    std::vector<DynStruct> vec(2);
+    for (size_t i = 0; i < vec.size(); ++i)
+    {
+        vec[i].x = static_cast<float>(i);
+        vec[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * 20, 20);
+    }
+
+    ext::DataTable<DynStruct> table(vec);
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.storage(&DynStruct::embeddings).shape()[1], 20);
+    for (size_t i = 0; i < vec.size(); ++i)
+    {
+        EXPECT_EQ(table.access(&DynStruct::x, i), vec[i].x);
+        auto emb = table.access(&DynStruct::embeddings, i);
+        for (size_t j = 0; j < emb.size(); ++j)
+        {
+            EXPECT_EQ(emb[int64_t(j)], embeddings[i * 20 + j]);
+        }
+    }
+}
+
+template <class T>
+void testTranspose(size_t n)
+{
+    struct Row
+    {
+        char pad[3];
+        T val;
+        double other;
+    };
+    std::vector<Row> rows(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        rows[i].val = static_cast<T>(i * 3 + 1);
+    }
+    std::vector<T> column(n);
+    ct::ext::stridedGather(&rows[0].val, sizeof(Row), n, column.data());
+    for (size_t i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(column[i], rows[i].val);
+        column[i] = static_cast<T>(i * 2);
+    }
+    ct::ext::stridedScatter(column.data(), n, &rows[0].val, sizeof(Row));
+    for (size_t i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(rows[i].val, static_cast<T>(i * 2));
+    }
+}
+
+TEST(datatable, transpose_kernels)
+{
+    for (size_t n : {1, 7, 16, 33, 1000})
+    {
+        testTranspose<float>(n);
+        testTranspose<int32_t>(n);
+        testTranspose<double>(n);
+        testTranspose<uint16_t>(n);
+    }
+}
+
+TEST(datatable, copy_to)
+{
+    std::vector<TestB> vec;
+    auto val = TestData<TestB>::init();
+    for (size_t i = 0; i < 100; ++i)
+    {
+        vec.push_back(val);
+        inc(val);
+    }
+    ct::ext::DataTable<TestB> table(vec);
+
+    std::vector<TestB> out;
+    table.copyTo(out);
+    ASSERT_EQ(out.size(), vec.size());
+    for (size_t i = 0; i < vec.size(); ++i)
+    {
+        EXPECT_EQ(out[i], vec[i]);
+    }
+
+    TestB partial[3];
+    table.copyTo(partial, 3, 50);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(partial[i], vec[50 + i]);
+    }
+}
+
+TEST(datatable, copy_to_dyn_array)
+{
+    std::vector<float> embeddings(40);
+    for (size_t i = 0; i < embeddings.size(); ++i)
+    {
+        embeddings[i] = static_cast<float>(i);
+    }
+    std::vector<DynStruct> vec(2);
+    for (size_t i = 0; i < vec.size(); ++i)
+    {
+        vec[i].x = static_cast<float>(i);
+        vec[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * 20, 20);
+    }
+    ext::DataTable<DynStruct> table(vec);
+
+    std::vector<DynStruct> out;
+    table.copyTo(out);
+    ASSERT_EQ(out.size(), 2);
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        EXPECT_EQ(out[i].x, vec[i].x);
+        EXPECT_EQ(out[i].embeddings.data(), table.access(&DynStruct::embeddings, i).data());
+        EXPECT_EQ(out[i].embeddings.size(), 20);
+        EXPECT_EQ(out[i].embeddings[0], embeddings[i * 20]);
+    }
+}
+
 TEST(datatable, dyn_array_init)
 {
     std::vector<float> embeddings;
@@ -583,6 +740,2590 @@ TEST(datatable, shared_ptr)
     ASSERT_EQ(new_storage.data().data(), storage.data().data());
 }
 
+TEST(datatable, aligned)
+{
+    ct::ext::DataTable<TestB, ct::ext::AlignedStoragePolicy> table =
+        createAndFillTable<TestB, ct::ext::AlignedStoragePolicy>(20);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.begin(&TestB::x)) % 64, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.begin(&TestB::y)) % 64, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.begin(&TestB::z)) % 64, 0);
+    TestB val = TestData<TestB>::init();
+    for (size_t i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(table.access(i), val);
+        inc(val);
+    }
+}
+
+TEST(datatable, aligned_dyn_array)
+{
+    std::vector<float> embeddings(20);
+    ext::DataTable<DynStruct, ct::ext::AlignedStoragePolicy> table;
+    for (int i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < embeddings.size(); ++j)
+        {
+            embeddings[j] = static_cast<float>(i * 100 + j);
+        }
+        table.push_back(DynStruct{0.1F, 0.2F, 0.3F, 0.4F, {embeddings.data(), 20}});
+    }
+    // 20 floats are padded to 32 so every row starts on a cache line
+    EXPECT_EQ(table.storage(&DynStruct::embeddings).shape()[1], 20);
+    EXPECT_EQ(table.storage(&DynStruct::embeddings).shape().getStride(0), 32);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto emb = table.access(&DynStruct::embeddings, i);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(emb.data()) % 64, 0);
+        ASSERT_EQ(emb.size(), 20);
+        for (size_t j = 0; j < emb.size(); ++j)
+        {
+            EXPECT_EQ(emb[int64_t(j)], static_cast<float>(i * 100 + j));
+        }
+    }
+    table.storage(&DynStruct::embeddings).erase(1);
+    EXPECT_EQ(table.access(&DynStruct::embeddings, 1)[0], 200.0F);
+}
+
+TEST(datatable, arena)
+{
+    using Table = ct::ext::DataTable<TestB, ct::ext::ArenaStoragePolicy>;
+    Table table;
+    table.reserve(20);
+    TestB val = TestData<TestB>::init();
+    table.push_back(val);
+    const size_t block_size = table.arena().blockSize();
+    const float* x = table.begin(&TestB::x);
+    const float* y = table.begin(&TestB::y);
+    const float* z = table.begin(&TestB::z);
+    // All three columns were reserved into one block
+    const auto lo = std::min({x, y, z});
+    const auto hi = std::max({x, y, z});
+    EXPECT_LT(static_cast<size_t>(reinterpret_cast<const uint8_t*>(hi) - reinterpret_cast<const uint8_t*>(lo)),
+              block_size);
+    EXPECT_GE(block_size, 3 * 20 * sizeof(float));
+    for (size_t i = 1; i < 20; ++i)
+    {
+        inc(val);
+        table.push_back(val);
+    }
+    EXPECT_EQ(table.begin(&TestB::x), x);
+    EXPECT_EQ(table.arena().blockSize(), block_size);
+
+    // Growing past the reservation regrows every column together
+    for (size_t i = 20; i < 1000; ++i)
+    {
+        inc(val);
+        table.push_back(val);
+    }
+    val = TestData<TestB>::init();
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(table.access(i), val);
+        inc(val);
+    }
+
+    Table copy = table;
+    EXPECT_NE(copy.begin(&TestB::x), table.begin(&TestB::x));
+    copy.access(&TestB::x, 0) = 100;
+    EXPECT_EQ(table.access(&TestB::x, 0), TestData<TestB>::init().x);
+    EXPECT_EQ(copy.access(5), table.access(5));
+}
+
+TEST(datatable, arena_dyn_array)
+{
+    std::vector<float> embeddings(20);
+    ext::DataTable<DynStruct, ct::ext::ArenaStoragePolicy> table;
+    for (int i = 0; i < 50; ++i)
+    {
+        for (size_t j = 0; j < embeddings.size(); ++j)
+        {
+            embeddings[j] = static_cast<float>(i * 100 + j);
+        }
+        table.push_back(DynStruct{float(i), 0.2F, 0.3F, 0.4F, {embeddings.data(), 20}});
+    }
+    for (size_t i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(table.access(&DynStruct::x, i), float(i));
+        auto emb = table.access(&DynStruct::embeddings, i);
+        ASSERT_EQ(emb.size(), 20);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(emb.data()) % 64, 0);
+        EXPECT_EQ(emb[19], static_cast<float>(i * 100 + 19));
+    }
+}
+
+TEST(datatable, chunked)
+{
+    using Table = ct::ext::DataTable<TestB, ct::ext::ChunkedStoragePolicy>;
+    const size_t page_rows = Table::StorageType<float>::page_rows;
+    const size_t num_rows = 2 * page_rows + 100;
+    Table table;
+    TestB val = TestData<TestB>::init();
+    table.push_back(val);
+    const float* first = &table.access(&TestB::x, 0);
+    std::vector<TestB> rows;
+    for (size_t i = 1; i < num_rows; ++i)
+    {
+        inc(val);
+        rows.push_back(val);
+    }
+    table.append(rows);
+    // Growing only adds pages, the first row never moves
+    EXPECT_EQ(&table.access(&TestB::x, 0), first);
+    ASSERT_EQ(table.size(), num_rows);
+    EXPECT_EQ(table.access(page_rows), rows[page_rows - 1]);
+    EXPECT_EQ(table.access(num_rows - 1), rows.back());
+    // end and view stop at the end of the first page
+    EXPECT_EQ(table.end(&TestB::x) - table.begin(&TestB::x), static_cast<std::ptrdiff_t>(page_rows));
+    const auto y_view = table.view(&TestB::y);
+    EXPECT_EQ(std::distance(y_view.begin(), y_view.end()), static_cast<std::ptrdiff_t>(page_rows));
+
+    size_t num_chunks = 0;
+    size_t num_visited = 0;
+    double sum = 0;
+    table.forEachChunk(&TestB::y, [&](mt::Tensor<const float, 1> chunk, size_t first_row) {
+        EXPECT_EQ(first_row, num_visited);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(chunk.data()) % 64, 0);
+        for (size_t i = 0; i < chunk.getShape()[0]; ++i)
+        {
+            sum += chunk[i];
+        }
+        num_visited += chunk.getShape()[0];
+        ++num_chunks;
+    });
+    EXPECT_EQ(num_chunks, 3);
+    EXPECT_EQ(num_visited, num_rows);
+    double expected = 0;
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        expected += table.access(&TestB::y, i);
+    }
+    EXPECT_EQ(sum, expected);
+
+    std::vector<TestB> out;
+    table.copyTo(out);
+    EXPECT_EQ(out.front(), TestData<TestB>::init());
+    EXPECT_TRUE(std::equal(rows.begin(), rows.end(), out.begin() + 1));
+
+    ct::ext::DataTable<TestB> contiguous(out);
+    num_chunks = 0;
+    contiguous.forEachChunk(&TestB::x, [&](mt::Tensor<float, 1> chunk, size_t) {
+        EXPECT_EQ(chunk.getShape()[0], num_rows);
+        ++num_chunks;
+    });
+    EXPECT_EQ(num_chunks, 1);
+}
+
+TEST(datatable, chunked_dyn_array)
+{
+    ct::ext::ChunkedDataTableStorage<TArrayView<float>, 4> storage;
+    std::vector<float> embeddings(5);
+    std::vector<TArrayView<float>> views;
+    for (int i = 0; i < 10; ++i)
+    {
+        for (size_t j = 0; j < embeddings.size(); ++j)
+        {
+            embeddings[j] = static_cast<float>(i * 100 + j);
+        }
+        storage.push_back(TArrayView<float>(embeddings.data(), embeddings.size()));
+        views.push_back(TArrayView<float>(storage.data(i).data(), embeddings.size()));
+    }
+    EXPECT_EQ(storage.numChunks(), 3);
+    // Views taken while the column grew are still valid
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        ASSERT_EQ(views[i].data(), storage.data(i).data());
+        EXPECT_EQ(views[i][4], static_cast<float>(i * 100 + 4));
+    }
+    storage.erase(1);
+    EXPECT_EQ(storage.size(), 9);
+    EXPECT_EQ(storage.data(3)[0][0], 400.0F);
+
+    // Longer rows relayout the column, existing rows keep their values
+    std::vector<float> longer(8, -1.0F);
+    storage.push_back(TArrayView<float>(longer.data(), longer.size()));
+    EXPECT_EQ(storage.data(0)[0][4], 4.0F);
+    EXPECT_EQ(storage.data(8)[0][3], 903.0F);
+    EXPECT_EQ(storage.data(9)[0][7], -1.0F);
+}
+
+struct SwappedDynStruct
+{
+    REFLECT_INTERNAL_BEGIN(SwappedDynStruct)
+        REFLECT_INTERNAL_MEMBER(float, y)
+        REFLECT_INTERNAL_MEMBER(float, x)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, mmap)
+{
+    char tmpl[] = "/tmp/ctext_mmap_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    const std::string dir = tmpl;
+    std::vector<float> embeddings(20);
+    {
+        ext::DataTable<DynStruct, ct::ext::MmapStoragePolicy> table;
+        table.push_back(DynStruct{-1.0F, 0.2F, 0.3F, 0.4F, {embeddings.data(), 20}});
+        // Rows added before mapping are moved into the files
+        ct::ext::mapTable(table, dir);
+        for (int i = 0; i < 100; ++i)
+        {
+            for (size_t j = 0; j < embeddings.size(); ++j)
+            {
+                embeddings[j] = static_cast<float>(i * 100 + j);
+            }
+            table.push_back(DynStruct{float(i), 0.2F, 0.3F, 0.4F, {embeddings.data(), 20}});
+        }
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(table.begin(&DynStruct::x)) % 64, 0);
+        ext::DataTable<DynStruct, ct::ext::MmapStoragePolicy> copy = table;
+        EXPECT_EQ(copy.access(&DynStruct::x, 50), 49.0F);
+        table.sync();
+    }
+    {
+        ext::DataTable<DynStruct, ct::ext::MmapStoragePolicy> table;
+        ct::ext::mapTable(table, dir);
+        ASSERT_EQ(table.size(), 101);
+        EXPECT_EQ(table.access(&DynStruct::x, 0), -1.0F);
+        for (size_t i = 1; i < table.size(); ++i)
+        {
+            EXPECT_EQ(table.access(&DynStruct::x, i), float(i - 1));
+            auto emb = table.access(&DynStruct::embeddings, i);
+            ASSERT_EQ(emb.size(), 20);
+            EXPECT_EQ(emb[19], static_cast<float>((i - 1) * 100 + 19));
+        }
+    }
+    {
+        ext::DataTable<SwappedDynStruct, ct::ext::MmapStoragePolicy> table;
+        EXPECT_THROW(ct::ext::mapTable(table, dir), std::runtime_error);
+    }
+    for (const char* name : {"x", "y", "w", "h", "embeddings"})
+    {
+        EXPECT_EQ(std::remove((dir + "/" + name + ".col").c_str()), 0);
+    }
+    rmdir(tmpl);
+}
+
+TEST(datatable, table_file)
+{
+    std::vector<float> embeddings(20);
+    ext::DataTable<DynStruct> table;
+    for (int i = 0; i < 100; ++i)
+    {
+        for (size_t j = 0; j < embeddings.size(); ++j)
+        {
+            embeddings[j] = static_cast<float>(i * 100 + j);
+        }
+        table.push_back(DynStruct{float(i), 0.2F, 0.3F, float(i) * 2, {embeddings.data(), 20}});
+    }
+    char path[] = "/tmp/ctext_table_XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ct::ext::saveTable(table, path);
+
+    // Aligned and chunked storage pad rows differently than the saving table
+    ext::DataTable<DynStruct, ct::ext::AlignedStoragePolicy> aligned;
+    ct::ext::loadTable(aligned, path);
+    ext::DataTable<DynStruct, ct::ext::ChunkedStoragePolicy> chunked;
+    ct::ext::loadTable(chunked, path);
+    ext::DataTable<DynStruct> loaded;
+    loaded.push_back(DynStruct{-1.0F, 0.2F, 0.3F, 0.4F, {embeddings.data(), 20}});
+    ct::ext::loadTable(loaded, path);
+    ASSERT_EQ(aligned.size(), 100);
+    ASSERT_EQ(chunked.size(), 100);
+    ASSERT_EQ(loaded.size(), 100);
+
+    ct::ext::TableFileView<DynStruct> view(path);
+    ASSERT_EQ(view.size(), 100);
+    auto h = view.column(&DynStruct::h);
+    auto emb = view.column(&DynStruct::embeddings);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(h.data()) % 64, 0);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(h[i], float(i) * 2);
+        EXPECT_EQ(loaded.access(&DynStruct::h, i), float(i) * 2);
+        EXPECT_EQ(aligned.access(&DynStruct::x, i), float(i));
+        EXPECT_EQ(chunked.access(&DynStruct::x, i), float(i));
+        for (size_t j = 0; j < 20; ++j)
+        {
+            const float expected = static_cast<float>(i * 100 + j);
+            EXPECT_EQ(emb[i][j], expected);
+            EXPECT_EQ(loaded.access(&DynStruct::embeddings, i)[j], expected);
+            EXPECT_EQ(aligned.access(&DynStruct::embeddings, i)[j], expected);
+            EXPECT_EQ(chunked.access(&DynStruct::embeddings, i)[j], expected);
+        }
+    }
+
+    ext::DataTable<SwappedDynStruct> swapped;
+    EXPECT_THROW(ct::ext::loadTable(swapped, path), std::runtime_error);
+    EXPECT_THROW(ct::ext::TableFileView<SwappedDynStruct>{path}, std::runtime_error);
+
+    // Corrupt headers must not lead a read or a view past the data blocks
+    std::string bytes;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    const auto rewrite = [&path](const std::string& content) {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(content.data(), static_cast<std::streamsize>(content.size()));
+    };
+    std::string corrupt = bytes;
+    const uint32_t row_stride = 1u << 30;
+    std::memcpy(&corrupt[sizeof(ct::ext::TableFileHeader) + offsetof(ct::ext::TableColumnHeader, row_stride)],
+                &row_stride,
+                sizeof(row_stride));
+    rewrite(corrupt);
+    EXPECT_THROW(ct::ext::loadTable(loaded, path), std::runtime_error);
+    EXPECT_THROW(ct::ext::TableFileView<DynStruct>{path}, std::runtime_error);
+    rewrite(bytes.substr(0, sizeof(ct::ext::TableFileHeader) + sizeof(ct::ext::TableColumnHeader)));
+    EXPECT_THROW(ct::ext::TableFileView<DynStruct>{path}, std::runtime_error);
+    std::remove(path);
+}
+
+struct Keypoints
+{
+    REFLECT_INTERNAL_BEGIN(Keypoints)
+        REFLECT_INTERNAL_MEMBER(float, score)
+        REFLECT_INTERNAL_MEMBER(ct::ext::RaggedView<float>, points)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, ragged)
+{
+    std::vector<float> points(100);
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = float(i);
+    }
+    ext::DataTable<Keypoints> table;
+    table.push_back(Keypoints{0.0F, {points.data(), 3}});
+    std::vector<Keypoints> rows;
+    for (size_t i = 1; i < 10; ++i)
+    {
+        rows.push_back(Keypoints{float(i), {points.data() + i, i * 5}});
+    }
+    table.append(rows);
+    ASSERT_EQ(table.size(), 10);
+    const auto& storage = table.storage(&Keypoints::points);
+    // No padding to the longest row
+    EXPECT_EQ(storage.numValues(), 3 + 5 * 45);
+    EXPECT_EQ(table.access(&Keypoints::points, 0).size(), 3);
+    for (size_t i = 1; i < 10; ++i)
+    {
+        auto view = table.access(&Keypoints::points, i);
+        ASSERT_EQ(view.size(), i * 5);
+        EXPECT_EQ(view[0], float(i));
+        EXPECT_EQ(view[i * 5 - 1], float(i * 6 - 1));
+        Keypoints row = table[i];
+        EXPECT_EQ(row.score, float(i));
+        EXPECT_EQ(row.points.data(), view.data());
+    }
+
+    std::vector<Keypoints> out;
+    table.copyTo(out);
+    EXPECT_EQ(out[4].points.size(), 20);
+    EXPECT_EQ(out[4].points[0], 4.0F);
+
+    table.storage(&Keypoints::points).erase(1);
+    EXPECT_EQ(table.storage(&Keypoints::points).size(), 9);
+    EXPECT_EQ(table.storage(&Keypoints::points)[1][0], 2.0F);
+    EXPECT_EQ(table.storage(&Keypoints::points).numValues(), 3 + 5 * 44);
+}
+
+struct Detection
+{
+    REFLECT_INTERNAL_BEGIN(Detection)
+        REFLECT_INTERNAL_MEMBER(float, x)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Nullable<float>, conf)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, nullable)
+{
+    ext::DataTable<Detection> table;
+    std::vector<Detection> rows;
+    float expected_sum = 0;
+    for (size_t i = 0; i < 200; ++i)
+    {
+        Detection det{float(i), {}};
+        if (i % 3 == 0 && (i < 64 || i >= 128))
+        {
+            det.conf = float(i);
+            expected_sum += float(i);
+        }
+        rows.push_back(det);
+    }
+    table.append(rows.data(), 100);
+    for (size_t i = 100; i < rows.size(); ++i)
+    {
+        table.push_back(rows[i]);
+    }
+    auto& conf = table.storage(&Detection::conf);
+    ASSERT_EQ(conf.size(), 200);
+    EXPECT_EQ(conf.countNull(), 200 - (22 + 24));
+    EXPECT_EQ(conf.sumValid(), expected_sum);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ASSERT_EQ(table.access(&Detection::conf, i), rows[i].conf);
+        EXPECT_EQ(Detection(table[i]).conf.isNull(), rows[i].conf.isNull());
+    }
+    size_t visited = 0;
+    conf.forEachValid([&](size_t row, float value) {
+        EXPECT_EQ(row % 3, 0);
+        EXPECT_EQ(value, float(row));
+        ++visited;
+    });
+    EXPECT_EQ(visited, 46);
+
+    conf.assign(1, 5.0F);
+    conf.setNull(0);
+    EXPECT_EQ(*table.access(&Detection::conf, 1), 5.0F);
+    EXPECT_TRUE(table.access(&Detection::conf, 0).isNull());
+    conf.erase(1);
+    EXPECT_TRUE(conf.isNull(0));
+    EXPECT_TRUE(conf.isNull(1));
+    EXPECT_EQ(*conf[2], 3.0F);
+    EXPECT_EQ(*conf[197], 198.0F);
+    EXPECT_EQ(conf.countNull(), 199 - 45);
+}
+
+struct Entity
+{
+    REFLECT_INTERNAL_BEGIN(Entity)
+        REFLECT_INTERNAL_MEMBER(float, x)
+        REFLECT_INTERNAL_MEMBER(bool, active)
+        REFLECT_INTERNAL_MEMBER(bool, visible)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, bit_packed_bool)
+{
+    ext::DataTable<Entity> table;
+    std::vector<Entity> rows;
+    size_t expected = 0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        rows.push_back(Entity{float(i), i % 2 == 0, i % 3 == 0});
+        expected += (i % 6 == 0) ? 1 : 0;
+    }
+    table.push_back(rows[0]);
+    table.append(rows.data() + 1, rows.size() - 1);
+    ASSERT_EQ(table.size(), 1000);
+    const auto& active = table.storage(&Entity::active);
+    EXPECT_EQ(active.bits().numWords(), 16);
+    EXPECT_EQ(active.count(), 500);
+
+    ct::ext::BitVector selected = active.bits() & table.storage(&Entity::visible).bits();
+    EXPECT_EQ(selected.count(), expected);
+    selected.forEachSet([](size_t row) { EXPECT_EQ(row % 6, 0); });
+
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ASSERT_EQ(table.access(&Entity::active, i), rows[i].active);
+        Entity row = table[i];
+        EXPECT_EQ(row.visible, rows[i].visible);
+    }
+    table.access(&Entity::active, 1) = true;
+    EXPECT_TRUE(table.access(&Entity::active, 1));
+    std::vector<Entity> out;
+    table.copyTo(out);
+    EXPECT_TRUE(out[1].active);
+    EXPECT_FALSE(out[3].active);
+    EXPECT_TRUE(out[999].visible);
+
+    table.storage(&Entity::active).erase(0);
+    EXPECT_TRUE(table.access(&Entity::active, 0));
+    EXPECT_FALSE(table.access(&Entity::active, 2));
+    EXPECT_EQ(table.storage(&Entity::active).count(), 500);
+
+    // Packed bits have no bool pointer range, the interface reports the column as missing
+    static_assert(!ct::ext::HasDenseRows<ext::DataTable<Entity>::StorageType<bool>>::value, "");
+    const ct::ext::IDataTable<Entity>& base = table;
+    EXPECT_EQ(base.begin(&Entity::active), nullptr);
+    EXPECT_EQ(base.view(&Entity::active).begin(), base.view(&Entity::active).end());
+}
+
+struct Label
+{
+    REFLECT_INTERNAL_BEGIN(Label)
+        REFLECT_INTERNAL_MEMBER(int, id)
+        REFLECT_INTERNAL_MEMBER(ct::ext::ArenaString, text)
+        REFLECT_INTERNAL_MEMBER(ct::ext::DictString, cls)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, string_columns)
+{
+    const char* classes[] = {"person", "car", "bicycle"};
+    ext::DataTable<Label> table;
+    std::vector<Label> rows;
+    for (int i = 0; i < 300; ++i)
+    {
+        rows.push_back(Label{i, std::string(size_t(i % 17), 'a' + char(i % 26)), classes[i % 3]});
+    }
+    table.push_back(rows[0]);
+    table.append(rows.data() + 1, rows.size() - 1);
+    ASSERT_EQ(table.size(), 300);
+
+    const auto& text = table.storage(&Label::text);
+    EXPECT_EQ(text.strings().numBytes(), text.strings().offsets().back());
+    const auto& cls = table.storage(&Label::cls);
+    EXPECT_EQ(cls.dictionary().size(), 3);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ASSERT_TRUE(text[i] == rows[i].text);
+        ASSERT_TRUE(cls[i] == rows[i].cls);
+        EXPECT_EQ(cls.code(i), i % 3);
+        Label row = table[i];
+        EXPECT_EQ(row.text, rows[i].text);
+        EXPECT_EQ(row.cls, rows[i].cls);
+    }
+
+    size_t cars = 0;
+    cls.forEachEqual("car", [&cars](size_t row) {
+        EXPECT_EQ(row % 3, 1);
+        ++cars;
+    });
+    EXPECT_EQ(cars, 100);
+    EXPECT_EQ(cls.find("truck"), ext::StringDictionary::NOT_FOUND);
+
+    std::vector<Label> out;
+    table.copyTo(out);
+    EXPECT_EQ(out[299].text, rows[299].text);
+    EXPECT_EQ(out[299].cls, std::string("bicycle"));
+
+    table.storage(&Label::text).erase(1);
+    table.storage(&Label::cls).erase(1);
+    EXPECT_TRUE(text[1] == rows[2].text);
+    EXPECT_TRUE(cls[1] == rows[2].cls);
+    table.storage(&Label::cls).assign(0, ext::DictString("truck"));
+    EXPECT_EQ(cls.code(0), 3);
+}
+
+struct Sample
+{
+    REFLECT_INTERNAL_BEGIN(Sample)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Packed<int64_t>, id)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Packed<int32_t>, level)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, packed_integers)
+{
+    ext::DataTable<Sample> table;
+    std::vector<Sample> rows;
+    for (int64_t i = 0; i < 5000; ++i)
+    {
+        rows.push_back(Sample{1000000000000 + 3 * i, int32_t((i * 7919) % 200) - 100});
+    }
+    table.push_back(rows[0]);
+    table.append(rows.data() + 1, rows.size() - 1);
+    ASSERT_EQ(table.size(), 5000);
+
+    const auto& ids = table.storage(&Sample::id);
+    const auto& levels = table.storage(&Sample::level);
+    ASSERT_EQ(ids.numBlocks(), 4);
+    EXPECT_EQ(ids.blockWidth(0), 0);
+    EXPECT_EQ(levels.blockWidth(0), 8);
+    EXPECT_LT(levels.memoryBytes(), 5000 * sizeof(int32_t) / 2);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ASSERT_EQ(table.access(&Sample::id, i), rows[i].id.m_value);
+        ASSERT_EQ(table.access(&Sample::level, i), rows[i].level.m_value);
+    }
+
+    std::vector<int32_t> decoded(3000);
+    levels.decode(1024, decoded.size(), decoded.data());
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        ASSERT_EQ(decoded[i], rows[1024 + i].level.m_value);
+    }
+
+    const ct::ext::BitVector negative = levels.filterRange(-50, -1);
+    size_t expected = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        const bool in_range = rows[i].level >= -50 && rows[i].level <= -1;
+        ASSERT_EQ(negative.test(i), in_range);
+        expected += in_range;
+    }
+    EXPECT_EQ(negative.count(), expected);
+    EXPECT_EQ(ids.filterRange(1000000000000, 1000000000000 + 3 * 2047).count(), 2048);
+    static_assert(!ct::ext::HasDenseRows<ext::DataTable<Sample>::StorageType<ct::ext::Packed<int64_t>>>::value, "");
+    const ct::ext::IDataTable<Sample>& base = table;
+    EXPECT_EQ(base.begin(&Sample::id), nullptr);
+
+    table.storage(&Sample::level).assign(5, ct::ext::Packed<int32_t>(1 << 20));
+    EXPECT_EQ(table.access(&Sample::level, 5), 1 << 20);
+    EXPECT_EQ(levels.blockWidth(0), 21);
+    EXPECT_EQ(table.access(&Sample::level, 4000), rows[4000].level.m_value);
+
+    table.storage(&Sample::id).erase(10);
+    table.storage(&Sample::level).erase(10);
+    EXPECT_EQ(table.size(), 4999);
+    EXPECT_EQ(table.access(&Sample::id, 10), rows[11].id.m_value);
+    EXPECT_EQ(table.access(&Sample::level, 4998), rows[4999].level.m_value);
+    Sample row = table[3000];
+    EXPECT_EQ(row.id, rows[3001].id);
+}
+
+struct Telemetry
+{
+    REFLECT_INTERNAL_BEGIN(Telemetry)
+        REFLECT_INTERNAL_MEMBER(ct::ext::XorCompressed<float>, temperature)
+        REFLECT_INTERNAL_MEMBER(ct::ext::XorCompressed<double>, pressure)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, xor_compressed_floats)
+{
+    ext::DataTable<Telemetry> table;
+    std::vector<Telemetry> rows;
+    for (int i = 0; i < 4000; ++i)
+    {
+        rows.push_back(Telemetry{20.0f + float(i / 50) * 0.25f, 1013.25 + double((i * 37) % 11) * 0.5});
+    }
+    table.append(rows.data(), 2500);
+    table.storage(&Telemetry::temperature).seal();
+    table.storage(&Telemetry::pressure).seal();
+    table.append(rows.data() + 2500, 1000);
+    table.storage(&Telemetry::temperature).seal();
+    table.storage(&Telemetry::pressure).seal();
+    table.append(rows.data() + 3500, 500);
+    ASSERT_EQ(table.size(), 4000);
+
+    const auto& temperature = table.storage(&Telemetry::temperature);
+    const auto& pressure = table.storage(&Telemetry::pressure);
+    EXPECT_EQ(temperature.numSegments(), 2);
+    EXPECT_EQ(temperature.sealedRows(), 3500);
+    EXPECT_LT(temperature.memoryBytes(), 3500 * sizeof(float) / 4 + 500 * sizeof(float));
+    EXPECT_LT(pressure.memoryBytes(), 3500 * sizeof(double) / 2 + 500 * sizeof(double));
+
+    size_t row = 0;
+    for (float value : temperature)
+    {
+        ASSERT_EQ(value, rows[row].temperature.m_value);
+        ++row;
+    }
+    EXPECT_EQ(row, 4000);
+    using XorIterator = ext::DataTable<Telemetry>::StorageType<ct::ext::XorCompressed<float>>::const_iterator;
+    for (size_t start : {size_t(0), size_t(1700), size_t(2500), size_t(3600)})
+    {
+        row = start;
+        for (XorIterator it(&temperature, start); it != temperature.end(); ++it, ++row)
+        {
+            ASSERT_EQ(*it, rows[row].temperature.m_value);
+        }
+        EXPECT_EQ(row, 4000);
+    }
+    static_assert(!ct::ext::HasDenseRows<ext::DataTable<Telemetry>::StorageType<ct::ext::XorCompressed<float>>>::value,
+                  "");
+    static_assert(ext::DataTable<Telemetry>::has_append_only_column, "");
+    const ct::ext::IDataTable<Telemetry>& base = table;
+    EXPECT_EQ(base.view(&Telemetry::temperature).begin(), nullptr);
+    std::vector<double> decoded(2000);
+    pressure.decode(1200, decoded.size(), decoded.data());
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        ASSERT_EQ(decoded[i], rows[1200 + i].pressure.m_value);
+    }
+    EXPECT_EQ(table.access(&Telemetry::pressure, 2501), rows[2501].pressure.m_value);
+    EXPECT_EQ(table.access(&Telemetry::temperature, 3999), rows[3999].temperature.m_value);
+
+    table.storage(&Telemetry::temperature).erase(2600);
+    table.storage(&Telemetry::pressure).erase(2600);
+    EXPECT_EQ(table.size(), 3999);
+    std::vector<Telemetry> out;
+    table.copyTo(out);
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        const size_t src = i < 2600 ? i : i + 1;
+        ASSERT_EQ(out[i].temperature.m_value, rows[src].temperature.m_value);
+        ASSERT_EQ(out[i].pressure.m_value, rows[src].pressure.m_value);
+    }
+
+    table.storage(&Telemetry::pressure).resize(100);
+    EXPECT_EQ(pressure.size(), 100);
+    EXPECT_EQ(pressure.get(99), rows[99].pressure.m_value);
+}
+
+struct QuantizedEmbedding
+{
+    REFLECT_INTERNAL_BEGIN(QuantizedEmbedding)
+        REFLECT_INTERNAL_MEMBER(int, id)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Quantized<ct::ext::Half>, fp16)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Quantized<ct::ext::BFloat16>, bf16)
+        REFLECT_INTERNAL_MEMBER(ct::ext::Quantized<int8_t>, int8)
+    REFLECT_INTERNAL_END;
+};
+
+TEST(datatable, quantized_embeddings)
+{
+    const size_t dim = 37;
+    std::vector<QuantizedEmbedding> rows;
+    std::vector<std::vector<float>> reference;
+    for (int i = 0; i < 50; ++i)
+    {
+        std::vector<float> values(dim);
+        for (size_t j = 0; j < dim; ++j)
+        {
+            values[j] = std::sin(float(i * 7 + j) * 0.37f) * float(1 + i % 5);
+        }
+        reference.push_back(values);
+        rows.push_back(QuantizedEmbedding{i, values, values, values});
+    }
+    ext::DataTable<QuantizedEmbedding> table;
+    table.push_back(rows[0]);
+    table.append(rows.data() + 1, rows.size() - 1);
+    ASSERT_EQ(table.size(), 50);
+    EXPECT_EQ(table.storage(&QuantizedEmbedding::fp16).dim(), dim);
+
+    std::vector<float> query(dim);
+    for (size_t j = 0; j < dim; ++j)
+    {
+        query[j] = std::cos(float(j) * 0.21f);
+    }
+    std::vector<float> dots(rows.size());
+    std::vector<float> dists(rows.size());
+    table.storage(&QuantizedEmbedding::int8).dot(query.data(), dots.data());
+    table.storage(&QuantizedEmbedding::int8).l2(query.data(), dists.data());
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        const float max_abs = float(1 + i % 5);
+        const auto fp16 = table.access(&QuantizedEmbedding::fp16, i);
+        const auto bf16 = table.access(&QuantizedEmbedding::bf16, i);
+        const auto int8 = table.access(&QuantizedEmbedding::int8, i);
+        float dot = 0.0f;
+        float dist = 0.0f;
+        for (size_t j = 0; j < dim; ++j)
+        {
+            ASSERT_NEAR(fp16[j], reference[i][j], max_abs / 1024.0f);
+            ASSERT_NEAR(bf16[j], reference[i][j], max_abs / 128.0f);
+            ASSERT_NEAR(int8[j], reference[i][j], max_abs / 254.0f + 1e-6f);
+            dot += int8[j] * query[j];
+            dist += (int8[j] - query[j]) * (int8[j] - query[j]);
+        }
+        EXPECT_NEAR(dots[i], dot, 1e-3f * max_abs * dim);
+        EXPECT_NEAR(dists[i], dist, 1e-3f * max_abs * max_abs * dim);
+        EXPECT_NEAR(fp16.dot(query.data()), bf16.dot(query.data()), 0.05f * max_abs * dim);
+
+        QuantizedEmbedding row = table[i];
+        ASSERT_EQ(row.fp16.size(), dim);
+        EXPECT_EQ(row.fp16[3], fp16[3]);
+        EXPECT_EQ(row.int8[5], int8[5]);
+    }
+
+    table.storage(&QuantizedEmbedding::bf16).erase(0);
+    EXPECT_EQ(table.storage(&QuantizedEmbedding::bf16).size(), 49);
+    EXPECT_NEAR(table.access(&QuantizedEmbedding::bf16, 0)[1], reference[1][1], 2.0f / 128.0f);
+
+    // Rows of another length are rejected and leave the column unchanged
+    auto& int8 = table.storage(&QuantizedEmbedding::int8);
+    const ct::ext::Quantized<int8_t> shorter(dim - 1, 1.0f);
+    EXPECT_THROW(int8.assign(0, shorter), std::invalid_argument);
+    EXPECT_THROW(int8.push_back(shorter), std::invalid_argument);
+    EXPECT_EQ(int8.size(), 50);
+}
+
+template <class TABLE, class T>
+std::vector<ct::ext::SearchResult> bruteForceTopK(const TABLE& table, T mem_ptr, const std::vector<float>& query,
+                                                  size_t k, ct::ext::Metric metric)
+{
+    std::vector<ct::ext::SearchResult> all;
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        const auto row = table.access(mem_ptr, i);
+        double dot = 0, norm = 0, qnorm = 0, dist = 0;
+        for (size_t j = 0; j < query.size(); ++j)
+        {
+            const double v = row[int64_t(j)];
+            dot += v * query[j];
+            norm += v * v;
+            qnorm += double(query[j]) * query[j];
+            dist += (v - query[j]) * (v - query[j]);
+        }
+        const double score =
+            metric == ct::ext::Metric::Dot ? dot : metric == ct::ext::Metric::L2 ? dist : dot / std::sqrt(norm * qnorm);
+        all.push_back(ct::ext::SearchResult{i, float(score)});
+    }
+    std::sort(all.begin(), all.end(), [metric](const ct::ext::SearchResult& a, const ct::ext::SearchResult& b) {
+        return metric == ct::ext::Metric::L2 ? a.score < b.score : a.score > b.score;
+    });
+    all.resize(k);
+    return all;
+}
+
+TEST(datatable, top_k_similarity)
+{
+    const size_t dim = 45;
+    std::vector<float> embeddings(1000 * dim);
+    for (size_t i = 0; i < embeddings.size(); ++i)
+    {
+        embeddings[i] = std::sin(float(i) * 0.731f + float(i % 7));
+    }
+    std::vector<DynStruct> rows(1000);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        rows[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * dim, dim);
+    }
+    ext::DataTable<DynStruct> table;
+    table.append(rows.data(), rows.size());
+    ext::DataTable<DynStruct, ext::AlignedStoragePolicy> aligned;
+    aligned.append(rows.data(), rows.size());
+
+    std::vector<float> query(embeddings.begin() + 321 * dim, embeddings.begin() + 322 * dim);
+    query[0] += 0.1f;
+    for (ext::Metric metric : {ext::Metric::Dot, ext::Metric::Cosine, ext::Metric::L2})
+    {
+        const auto expected = bruteForceTopK(table, &DynStruct::embeddings, query, 10, metric);
+        const auto single = table.topK(&DynStruct::embeddings, query.data(), 10, metric);
+        const auto threaded = table.topK(&DynStruct::embeddings, query.data(), 10, metric, 4);
+        const auto padded = aligned.topK(&DynStruct::embeddings, query.data(), 10, metric, 3);
+        ASSERT_EQ(single.size(), 10);
+        ASSERT_EQ(threaded.size(), 10);
+        for (size_t i = 0; i < 10; ++i)
+        {
+            EXPECT_EQ(single[i].row, expected[i].row);
+            EXPECT_NEAR(single[i].score, expected[i].score, 1e-3f);
+            EXPECT_EQ(threaded[i].row, single[i].row);
+            EXPECT_EQ(padded[i].row, single[i].row);
+        }
+    }
+    EXPECT_EQ(table.topK(&DynStruct::embeddings, query.data(), 1, ext::Metric::L2)[0].row, 321);
+    EXPECT_EQ(table.topK(&DynStruct::embeddings, query.data(), 2000).size(), 1000);
+    // Tombstoned rows are never returned, the next best rows take their place
+    const auto before = table.topK(&DynStruct::embeddings, query.data(), 5, ext::Metric::L2);
+    table.tombstone(321);
+    table.tombstone(before[2].row);
+    const auto after = table.topK(&DynStruct::embeddings, query.data(), 5, ext::Metric::L2, 2);
+    ASSERT_EQ(after.size(), 5);
+    EXPECT_EQ(after[0].row, before[1].row);
+    EXPECT_EQ(after[1].row, before[3].row);
+    EXPECT_EQ(after[2].row, before[4].row);
+    EXPECT_EQ(table.topK(&DynStruct::embeddings, query.data(), 2000).size(), 998);
+
+    std::vector<QuantizedEmbedding> quantized(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        std::vector<float> values(embeddings.begin() + i * dim, embeddings.begin() + (i + 1) * dim);
+        quantized[i] = QuantizedEmbedding{int(i), values, values, values};
+    }
+    ext::DataTable<QuantizedEmbedding> quantized_table;
+    quantized_table.append(quantized.data(), quantized.size());
+    EXPECT_EQ(quantized_table.topK(&QuantizedEmbedding::fp16, query.data(), 1, ext::Metric::Cosine)[0].row, 321);
+    EXPECT_EQ(quantized_table.topK(&QuantizedEmbedding::int8, query.data(), 1, ext::Metric::L2, 2)[0].row, 321);
+}
+
+// Points scattered around num_clusters random centers
+std::vector<float> clusteredEmbeddings(size_t num_rows, size_t dim, size_t num_clusters, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal;
+    std::vector<float> centers(num_clusters * dim);
+    for (float& v : centers)
+    {
+        v = normal(rng) * 4.0f;
+    }
+    std::vector<float> out(num_rows * dim);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        const size_t cluster = rng() % num_clusters;
+        for (size_t d = 0; d < dim; ++d)
+        {
+            out[i * dim + d] = centers[cluster * dim + d] + normal(rng);
+        }
+    }
+    return out;
+}
+
+double ivfRecall(const ext::IvfIndex& index, const ext::DataTable<DynStruct>& table, const std::vector<float>& queries,
+                 size_t k, size_t nprobe)
+{
+    const size_t dim = index.dim();
+    size_t hits = 0;
+    const size_t num_queries = queries.size() / dim;
+    for (size_t q = 0; q < num_queries; ++q)
+    {
+        const auto exact = table.topK(&DynStruct::embeddings, queries.data() + q * dim, k, ext::Metric::L2);
+        const auto approx = index.search(queries.data() + q * dim, k, nprobe);
+        for (const auto& result : approx)
+        {
+            hits += std::any_of(exact.begin(), exact.end(),
+                                [&result](const ext::SearchResult& other) { return other.row == result.row; });
+        }
+    }
+    return double(hits) / double(num_queries * k);
+}
+
+TEST(datatable, ivf_index)
+{
+    const size_t dim = 16;
+    std::vector<float> embeddings = clusteredEmbeddings(5100, dim, 50, 7);
+    std::vector<DynStruct> rows(5100);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        rows[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * dim, dim);
+    }
+    ext::DataTable<DynStruct> table;
+    table.append(rows.data(), 5000);
+    const auto& column = table.storage(&DynStruct::embeddings);
+
+    ext::IvfIndex index(32);
+    index.build(column);
+    ASSERT_EQ(index.size(), 5000);
+    ASSERT_EQ(index.numLists(), 32);
+    size_t listed = 0;
+    for (size_t l = 0; l < index.numLists(); ++l)
+    {
+        listed += index.listSize(l);
+    }
+    EXPECT_EQ(listed, 5000);
+
+    const std::vector<float> queries = clusteredEmbeddings(50, dim, 50, 7);
+    EXPECT_GE(ivfRecall(index, table, queries, 10, 4), 0.9);
+    EXPECT_EQ(ivfRecall(index, table, queries, 10, index.numLists()), 1.0);
+
+    table.append(rows.data() + 5000, 100);
+    index.sync(column);
+    ASSERT_EQ(index.size(), 5100);
+    EXPECT_EQ(index.search(embeddings.data() + 5050 * dim, 1, 1)[0].row, 5050);
+
+    table.storage(&DynStruct::embeddings).erase(10);
+    index.erase(10);
+    EXPECT_EQ(index.size(), 5099);
+    EXPECT_EQ(index.search(embeddings.data() + 11 * dim, 1, 1)[0].row, 10);
+    EXPECT_EQ(index.search(embeddings.data() + 5050 * dim, 1, 1)[0].row, 5049);
+
+    std::stringstream ss;
+    index.save(ss);
+    ext::IvfIndex loaded;
+    loaded.load(ss);
+    ASSERT_EQ(loaded.size(), index.size());
+    ASSERT_EQ(loaded.dim(), dim);
+    const auto expected = index.search(queries.data(), 10, 4);
+    const auto actual = loaded.search(queries.data(), 10, 4);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i)
+    {
+        EXPECT_EQ(actual[i].row, expected[i].row);
+        EXPECT_EQ(actual[i].score, expected[i].score);
+    }
+    std::stringstream bad("not an index");
+    EXPECT_THROW(loaded.load(bad), std::runtime_error);
+
+    // A failed load leaves the index as it was
+    const std::string bytes = ss.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    EXPECT_THROW(loaded.load(truncated), std::runtime_error);
+    std::string corrupt = bytes;
+    const uint32_t metric = 7;
+    std::memcpy(&corrupt[offsetof(ct::ext::IvfFileHeader, metric)], &metric, sizeof(metric));
+    std::stringstream bad_metric(corrupt);
+    EXPECT_THROW(loaded.load(bad_metric), std::runtime_error);
+    corrupt = bytes;
+    const uint64_t row = 1u << 20;
+    const size_t first_row =
+        sizeof(ct::ext::IvfFileHeader) + loaded.numLists() * dim * sizeof(float) + sizeof(uint64_t);
+    std::memcpy(&corrupt[first_row], &row, sizeof(row));
+    std::stringstream bad_row(corrupt);
+    EXPECT_THROW(loaded.load(bad_row), std::runtime_error);
+    corrupt = bytes;
+    const uint64_t num_lists = uint64_t(1) << 40;
+    std::memcpy(&corrupt[offsetof(ct::ext::IvfFileHeader, num_lists)], &num_lists, sizeof(num_lists));
+    std::stringstream bad_lists(corrupt);
+    EXPECT_THROW(loaded.load(bad_lists), std::runtime_error);
+    corrupt = bytes;
+    const uint64_t huge_dim = ~uint64_t(0) / 2;
+    std::memcpy(&corrupt[offsetof(ct::ext::IvfFileHeader, dim)], &huge_dim, sizeof(huge_dim));
+    std::stringstream bad_dim(corrupt);
+    EXPECT_THROW(loaded.load(bad_dim), std::runtime_error);
+    ASSERT_EQ(loaded.size(), index.size());
+    EXPECT_EQ(loaded.search(queries.data(), 10, 4)[0].row, expected[0].row);
+
+    // Declared on a table the index follows the table's mutations
+    ext::DataTable<DynStruct> declared;
+    declared.append(rows.data(), 5000);
+    declared.createIvfIndex(&DynStruct::embeddings, 32);
+    EXPECT_THROW(table.search(&DynStruct::embeddings, queries.data(), 1), std::runtime_error);
+    declared.append(rows.data() + 5000, 100);
+    EXPECT_EQ(declared.search(&DynStruct::embeddings, embeddings.data() + 5050 * dim, 1, 1)[0].row, 5050);
+    declared.erase(10);
+    EXPECT_EQ(declared.search(&DynStruct::embeddings, embeddings.data() + 11 * dim, 1, 1)[0].row, 10);
+    declared.swapRemove(0);
+    EXPECT_EQ(declared.search(&DynStruct::embeddings, embeddings.data() + 5099 * dim, 1, 1)[0].row, 0);
+    declared.assign(1, rows[5050]);
+    const auto moved = declared.search(&DynStruct::embeddings, embeddings.data() + 5050 * dim, 2, 1);
+    ASSERT_EQ(moved.size(), 2);
+    EXPECT_EQ(std::min(moved[0].row, moved[1].row), 1);
+    EXPECT_EQ(std::max(moved[0].row, moved[1].row), 5049);
+    declared.tombstone(0);
+    EXPECT_NE(declared.search(&DynStruct::embeddings, embeddings.data() + 5099 * dim, 1, 1)[0].row, 0);
+    declared.compact();
+    EXPECT_EQ(declared.search(&DynStruct::embeddings, embeddings.data() + 5050 * dim, 1)[0].score, 0.0f);
+
+    // An index declared on an empty table is trained on the first rows appended
+    ext::DataTable<DynStruct> empty;
+    empty.createIvfIndex(&DynStruct::embeddings, 8);
+    empty.append(rows.data(), 100);
+    EXPECT_EQ(empty.search(&DynStruct::embeddings, embeddings.data() + 42 * dim, 1, 8)[0].row, 42);
+}
+
+TEST(IvfIndexPerformance, recall_and_latency)
+{
+    const size_t dim = 32;
+    const size_t num_rows = 20000;
+    std::vector<float> embeddings = clusteredEmbeddings(num_rows, dim, 200, 11);
+    std::vector<DynStruct> rows(num_rows);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        rows[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * dim, dim);
+    }
+    ext::DataTable<DynStruct> table;
+    table.append(rows.data(), rows.size());
+    ext::IvfIndex index(128);
+    double build_time = 0;
+    {
+        TimeIt timer(build_time);
+        index.build(table.storage(&DynStruct::embeddings), 5);
+    }
+    const std::vector<float> queries = clusteredEmbeddings(100, dim, 200, 11);
+    double brute_time = 0;
+    {
+        TimeIt timer(brute_time);
+        for (size_t q = 0; q < 100; ++q)
+        {
+            table.topK(&DynStruct::embeddings, queries.data() + q * dim, 10, ext::Metric::L2);
+        }
+    }
+    std::cout << "ivf build " << build_time << " ms, brute force " << brute_time / 100 << " ms/query" << std::endl;
+    for (size_t nprobe : {1, 4, 16})
+    {
+        double ivf_time = 0;
+        {
+            TimeIt timer(ivf_time);
+            for (size_t q = 0; q < 100; ++q)
+            {
+                index.search(queries.data() + q * dim, 10, nprobe);
+            }
+        }
+        const double recall = ivfRecall(index, table, queries, 10, nprobe);
+        std::cout << "nprobe " << nprobe << ": recall@10 " << recall << ", " << ivf_time / 100 << " ms/query"
+                  << std::endl;
+        if (nprobe == 16)
+        {
+            EXPECT_GE(recall, 0.95);
+        }
+    }
+}
+
+struct Reading
+{
+    REFLECT_INTERNAL_BEGIN(Reading)
+        REFLECT_INTERNAL_MEMBER(int32_t, id)
+        REFLECT_INTERNAL_MEMBER(float, value)
+        REFLECT_INTERNAL_MEMBER(double, weight)
+    REFLECT_INTERNAL_END;
+};
+
+template <class T>
+bool referenceCompare(T a, ct::ext::CompareOp op, T b)
+{
+    switch (op)
+    {
+    case ct::ext::CompareOp::Less:
+        return a < b;
+    case ct::ext::CompareOp::LessEqual:
+        return a <= b;
+    case ct::ext::CompareOp::Greater:
+        return a > b;
+    case ct::ext::CompareOp::GreaterEqual:
+        return a >= b;
+    case ct::ext::CompareOp::Equal:
+        return a == b;
+    case ct::ext::CompareOp::NotEqual:
+        break;
+    }
+    return a != b;
+}
+
+template <class TABLE>
+void checkFilters(const TABLE& table, const std::vector<Reading>& rows)
+{
+    using ct::ext::CompareOp;
+    const CompareOp ops[] = {CompareOp::Less,
+                             CompareOp::LessEqual,
+                             CompareOp::Greater,
+                             CompareOp::GreaterEqual,
+                             CompareOp::Equal,
+                             CompareOp::NotEqual};
+    for (CompareOp op : ops)
+    {
+        const ct::ext::BitVector by_id = table.where(&Reading::id, op, 50);
+        const ct::ext::BitVector by_value = table.where(&Reading::value, op, 0.5f);
+        const ct::ext::BitVector by_weight = table.where(&Reading::weight, op, 2.0);
+        ASSERT_EQ(by_id.size(), rows.size());
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            ASSERT_EQ(by_id.test(i), referenceCompare(rows[i].id, op, 50)) << i;
+            ASSERT_EQ(by_value.test(i), referenceCompare(rows[i].value, op, 0.5f)) << i;
+            ASSERT_EQ(by_weight.test(i), referenceCompare(rows[i].weight, op, 2.0)) << i;
+        }
+    }
+
+    const ct::ext::BitVector between = table.whereBetween(&Reading::value, 0.25f, 0.75f);
+    const std::vector<int32_t> few = {3, 7, 7, 11};
+    std::vector<int32_t> many;
+    for (int32_t i = 0; i < 100; i += 3)
+    {
+        many.push_back(i);
+    }
+    const ct::ext::BitVector in_few = table.whereIn(&Reading::id, few);
+    const ct::ext::BitVector in_many = table.whereIn(&Reading::id, many);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        ASSERT_EQ(between.test(i), rows[i].value >= 0.25f && rows[i].value <= 0.75f) << i;
+        ASSERT_EQ(in_few.test(i), std::find(few.begin(), few.end(), rows[i].id) != few.end()) << i;
+        ASSERT_EQ(in_many.test(i), rows[i].id % 3 == 0) << i;
+    }
+}
+
+TEST(datatable, filter)
+{
+    std::vector<Reading> rows;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        const float value = i % 97 == 0 ? std::nanf("") : dist(rng);
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 100), value, static_cast<double>(i % 5)});
+    }
+    ext::DataTable<Reading> table(rows);
+    checkFilters(table, rows);
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(rows);
+    checkFilters(chunked, rows);
+
+    // Predicates combine as bitmaps, the selection vector lists the surviving rows in order
+    const ext::BitVector hits = table.where(&Reading::id, ext::CompareOp::Less, 10) &
+                                ~table.where(&Reading::value, ext::CompareOp::Greater, 0.5f);
+    const ext::SelectionVector selection = ext::toSelection(hits);
+    ASSERT_EQ(selection.size(), hits.count());
+    EXPECT_TRUE(std::is_sorted(selection.begin(), selection.end()));
+    for (uint32_t row : selection)
+    {
+        EXPECT_LT(rows[row].id, 10);
+        EXPECT_FALSE(rows[row].value > 0.5f);
+    }
+    EXPECT_EQ(ext::toBitmap(selection, table.size()), hits);
+
+    std::stringstream ss;
+    ext::printTable(ss, table, ext::SelectionVector{1, 3});
+    std::string line;
+    size_t num_lines = 0;
+    while (std::getline(ss, line))
+    {
+        ++num_lines;
+    }
+    EXPECT_EQ(num_lines, 3);
+
+    // Tombstoned rows are not printed
+    table.tombstone(3);
+    const auto countLines = [](std::stringstream& printed) {
+        std::string printed_line;
+        size_t count = 0;
+        while (std::getline(printed, printed_line))
+        {
+            ++count;
+        }
+        return count;
+    };
+    std::stringstream selected;
+    ext::printTable(selected, table, ext::SelectionVector{1, 3});
+    EXPECT_EQ(countLines(selected), 2);
+    std::stringstream all;
+    ext::printTable(all, table);
+    EXPECT_EQ(countLines(all), table.size());
+
+    // Bit packed, string and ragged columns print through the rows
+    ext::DataTable<Entity> entities;
+    entities.push_back(Entity{1.5f, true, false});
+    std::stringstream bits;
+    bits << entities;
+    EXPECT_EQ(bits.str(), "x, active, visible\n1.5, 1, 0\n");
+    ext::DataTable<Label> labels;
+    labels.push_back(Label{7, "seven", "odd"});
+    std::stringstream strings;
+    strings << labels;
+    EXPECT_EQ(strings.str(), "id, text, cls\n7, seven, odd\n");
+    std::vector<float> points = {1.0f, 2.0f};
+    ext::DataTable<Keypoints> keypoints;
+    keypoints.push_back(Keypoints{0.5f, {points.data(), 2}});
+    std::stringstream ragged;
+    ragged << keypoints;
+    EXPECT_EQ(ragged.str(), "score, points\n0.5, 1 2\n");
+}
+
+TEST(datatable, aggregate)
+{
+    std::vector<Reading> rows;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (size_t i = 0; i < 9000; ++i)
+    {
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 2001) - 1000, dist(rng), 1e8 + static_cast<double>(i % 7)});
+    }
+    rows[4321].value = std::nanf("");
+    rows[77].id = -5000;
+    rows[8000].id = -5000;
+    ext::DataTable<Reading> table(rows);
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(rows);
+
+    int64_t id_sum = 0;
+    double weight_sum = 0;
+    for (const Reading& row : rows)
+    {
+        id_sum += row.id;
+        weight_sum += row.weight;
+    }
+    const double weight_mean = weight_sum / static_cast<double>(rows.size());
+    double weight_var = 0;
+    for (const Reading& row : rows)
+    {
+        weight_var += (row.weight - weight_mean) * (row.weight - weight_mean);
+    }
+    weight_var /= static_cast<double>(rows.size());
+    for (size_t threads : {1, 4})
+    {
+        EXPECT_EQ(table.sum(&Reading::id, {}, threads), id_sum);
+        EXPECT_EQ(chunked.sum(&Reading::id, {}, threads), id_sum);
+        EXPECT_DOUBLE_EQ(table.mean(&Reading::weight, {}, threads), weight_mean);
+        // Large offset with a small spread, the two pass variance keeps its precision
+        EXPECT_NEAR(table.variance(&Reading::weight, {}, threads), weight_var, 1e-6);
+        EXPECT_NEAR(chunked.variance(&Reading::weight, {}, threads), weight_var, 1e-6);
+        EXPECT_EQ(table.min(&Reading::id, {}, threads), -5000);
+        EXPECT_EQ(table.argmin(&Reading::id, {}, threads), 77);
+        EXPECT_EQ(chunked.argmin(&Reading::id, {}, threads), 77);
+        EXPECT_TRUE(std::isnan(table.sum(&Reading::value, {}, threads)));
+    }
+    const float* values = &table.access(&Reading::value, 0);
+    const size_t expected_argmax = static_cast<size_t>(std::max_element(values, values + 4321) - values);
+    const size_t after_nan = static_cast<size_t>(std::max_element(values + 4322, values + rows.size()) - values);
+    const size_t argmax = values[after_nan] > values[expected_argmax] ? after_nan : expected_argmax;
+    EXPECT_EQ(table.argmax(&Reading::value), argmax);
+    EXPECT_EQ(chunked.argmax(&Reading::value, {}, 3), argmax);
+    EXPECT_EQ(table.max(&Reading::value), values[argmax]);
+
+    // Bitmaps and selection vectors restrict the rows
+    const ext::BitVector positive = table.where(&Reading::id, ext::CompareOp::Greater, 0);
+    const ext::SelectionVector selection = ext::toSelection(positive);
+    int64_t positive_sum = 0;
+    double positive_value_sum = 0;
+    for (uint32_t row : selection)
+    {
+        positive_sum += rows[row].id;
+        positive_value_sum += rows[row].value;
+    }
+    EXPECT_EQ(table.sum(&Reading::id, positive), positive_sum);
+    EXPECT_EQ(chunked.sum(&Reading::id, selection, 4), positive_sum);
+    EXPECT_GT(table.min(&Reading::id, selection), 0);
+    EXPECT_TRUE(positive.test(table.argmin(&Reading::id, positive, 2)));
+    if (!positive.test(4321))
+    {
+        EXPECT_NEAR(table.sum(&Reading::value, positive, 2), positive_value_sum, 1e-3);
+    }
+    EXPECT_TRUE(std::isnan(table.mean(&Reading::id, ext::SelectionVector())));
+    EXPECT_EQ(table.argmin(&Reading::id, ext::SelectionVector()), table.size());
+
+    // Pairwise summation of many small floats stays close to the exact sum
+    std::vector<Reading> small(1 << 20, Reading{0, 0.1f, 0.0});
+    ext::DataTable<Reading> small_table(small);
+    EXPECT_NEAR(small_table.sum(&Reading::value), static_cast<double>(0.1f) * small.size(), 1e-6);
+
+    const size_t dim = 6;
+    std::vector<float> embeddings(500 * dim);
+    std::vector<DynStruct> dyn(500);
+    std::vector<double> expected_mean(dim, 0.0);
+    for (size_t i = 0; i < dyn.size(); ++i)
+    {
+        for (size_t d = 0; d < dim; ++d)
+        {
+            embeddings[i * dim + d] = static_cast<float>(i % 10) + static_cast<float>(d);
+            expected_mean[d] += embeddings[i * dim + d] / 500.0;
+        }
+        dyn[i].embeddings = ct::TArrayView<float>(embeddings.data() + i * dim, dim);
+    }
+    ext::DataTable<DynStruct> dyn_table;
+    dyn_table.append(dyn.data(), dyn.size());
+    const std::vector<double> mean = dyn_table.meanPerDimension(&DynStruct::embeddings, {}, 3);
+    ASSERT_EQ(mean.size(), dim);
+    for (size_t d = 0; d < dim; ++d)
+    {
+        EXPECT_NEAR(mean[d], expected_mean[d], 1e-9);
+    }
+    const ext::SelectionVector first_rows = {0, 1, 2};
+    const std::vector<double> first_sum = dyn_table.sumPerDimension(&DynStruct::embeddings, first_rows);
+    EXPECT_EQ(first_sum[0], 3.0);
+    EXPECT_EQ(first_sum[5], 18.0);
+}
+
+struct ReadingStats
+{
+    REFLECT_INTERNAL_BEGIN(ReadingStats)
+        REFLECT_INTERNAL_MEMBER(int32_t, id)
+        REFLECT_INTERNAL_MEMBER(double, total)
+        REFLECT_INTERNAL_MEMBER(uint64_t, rows)
+        REFLECT_INTERNAL_MEMBER(double, mean_weight)
+        REFLECT_INTERNAL_MEMBER(float, lo)
+        REFLECT_INTERNAL_MEMBER(float, hi)
+    REFLECT_INTERNAL_END;
+};
+
+template <class TABLE>
+void checkGroupBy(const TABLE& table, const std::vector<Reading>& rows, size_t num_threads)
+{
+    struct Expected
+    {
+        double total = 0;
+        uint64_t rows = 0;
+        double weight = 0;
+        float lo = std::numeric_limits<float>::infinity();
+        float hi = -std::numeric_limits<float>::infinity();
+    };
+    std::map<int32_t, Expected> expected;
+    for (const Reading& row : rows)
+    {
+        Expected& group = expected[row.id];
+        group.total += row.value;
+        ++group.rows;
+        group.weight += row.weight;
+        group.lo = std::min(group.lo, row.value);
+        group.hi = std::max(group.hi, row.value);
+    }
+    ext::DataTable<ReadingStats> stats = table.groupBy(&Reading::id, num_threads)
+                                             .template aggregate<ReadingStats>(ext::agg::sum(&Reading::value),
+                                                                               ext::agg::count(),
+                                                                               ext::agg::mean(&Reading::weight),
+                                                                               ext::agg::min(&Reading::value),
+                                                                               ext::agg::max(&Reading::value));
+    ASSERT_EQ(stats.size(), expected.size());
+    uint64_t total_rows = 0;
+    for (size_t i = 0; i < stats.size(); ++i)
+    {
+        const ReadingStats group = stats[i];
+        ASSERT_EQ(expected.count(group.id), 1);
+        const Expected& ref = expected[group.id];
+        EXPECT_NEAR(group.total, ref.total, 1e-9);
+        EXPECT_EQ(group.rows, ref.rows);
+        EXPECT_NEAR(group.mean_weight, ref.weight / static_cast<double>(ref.rows), 1e-9);
+        EXPECT_EQ(group.lo, ref.lo);
+        EXPECT_EQ(group.hi, ref.hi);
+        total_rows += group.rows;
+    }
+    EXPECT_EQ(total_rows, rows.size());
+}
+
+TEST(datatable, group_by)
+{
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Reading> rows;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 37) - 18, dist(rng), static_cast<double>(i % 3)});
+    }
+    ext::DataTable<Reading> table(rows);
+    checkGroupBy(table, rows, 1);
+    // Groups are listed in order of first occurrence when the table is not partitioned
+    EXPECT_EQ(table.groupBy(&Reading::id).aggregate<ReadingStats>(ext::agg::sum(&Reading::value),
+                                                                   ext::agg::count(),
+                                                                   ext::agg::mean(&Reading::weight),
+                                                                   ext::agg::min(&Reading::value),
+                                                                   ext::agg::max(&Reading::value))
+                  .access(&ReadingStats::id, 0),
+              rows[0].id);
+
+    // Enough rows and keys for radix partitioning
+    for (size_t i = 0; i < 200000; ++i)
+    {
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 50000), dist(rng), static_cast<double>(i % 7)});
+    }
+    ext::DataTable<Reading> large(rows);
+    checkGroupBy(large, rows, 1);
+    checkGroupBy(large, rows, 4);
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(rows);
+    checkGroupBy(chunked, rows, 3);
+
+    // Tombstoned rows are left out, a key with only tombstoned rows forms no group
+    std::vector<Reading> live;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (i % 5 == 0 || rows[i].id == rows[1].id)
+        {
+            large.tombstone(i);
+        }
+        else
+        {
+            live.push_back(rows[i]);
+        }
+    }
+    checkGroupBy(large, live, 1);
+    checkGroupBy(large, live, 4);
+}
+
+template <class TABLE>
+void checkExtrema(const TABLE& table, const std::vector<Reading>& rows)
+{
+    size_t lo = 0;
+    size_t hi = 0;
+    for (size_t i = 1; i < rows.size(); ++i)
+    {
+        lo = rows[i].value < rows[lo].value || std::isnan(rows[lo].value) ? i : lo;
+        hi = rows[i].value > rows[hi].value || std::isnan(rows[hi].value) ? i : hi;
+    }
+    EXPECT_EQ(table.argmin(&Reading::value), lo);
+    EXPECT_EQ(table.argmax(&Reading::value), hi);
+    EXPECT_EQ(table.min(&Reading::value), rows[lo].value);
+    EXPECT_EQ(table.max(&Reading::value), rows[hi].value);
+    const auto by_id = [](const Reading& a, const Reading& b) { return a.id < b.id; };
+    EXPECT_EQ(table.argmin(&Reading::id, {}, 3),
+              static_cast<size_t>(std::min_element(rows.begin(), rows.end(), by_id) - rows.begin()));
+}
+
+TEST(datatable, zone_map)
+{
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<Reading> rows;
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        const float value = i % 5000 == 7 ? std::numeric_limits<float>::quiet_NaN() : dist(rng);
+        rows.push_back(Reading{static_cast<int32_t>(i / 250), value, static_cast<double>(i / 4096)});
+    }
+    ext::DataTable<Reading> table(rows);
+    table.storage(&Reading::id).buildZoneMap();
+    table.storage(&Reading::value).buildZoneMap();
+    table.storage(&Reading::weight).buildZoneMap();
+    const ext::ZoneMap<int32_t>* zones = table.storage(&Reading::id).zoneMap();
+    ASSERT_NE(zones, nullptr);
+    EXPECT_EQ(zones->numBlocks(), 5);
+    EXPECT_EQ(zones->min(1), 16);
+    EXPECT_EQ(zones->max(1), 32);
+    EXPECT_TRUE(table.storage(&Reading::value).zoneMap()->hasNan(0));
+    checkFilters(table, rows);
+    checkExtrema(table, rows);
+    const ext::BitVector late = table.where(&Reading::id, ext::CompareOp::GreaterEqual, 60);
+    EXPECT_EQ(late.count(), 5000);
+    EXPECT_EQ(table.where(&Reading::weight, ext::CompareOp::Equal, 2.0).count(), 4096);
+
+    // Appends extend the zone map, assign widens a block and erase summarizes the rows again
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        rows.push_back(Reading{static_cast<int32_t>(80 + i / 300), dist(rng), 5.0});
+    }
+    table.append(rows.data() + 20000, 5000);
+    rows.push_back(Reading{-4, -1.0f, 6.0});
+    table.push_back(rows.back());
+    table.storage(&Reading::id).assign(100, 99);
+    table.storage(&Reading::value).assign(9000, 5.0f);
+    rows[100].id = 99;
+    rows[9000].value = 5.0f;
+    table.storage(&Reading::id).erase(5);
+    table.storage(&Reading::value).erase(5);
+    table.storage(&Reading::weight).erase(5);
+    rows.erase(rows.begin() + 5);
+    ASSERT_NE(table.storage(&Reading::id).zoneMap(), nullptr);
+    EXPECT_EQ(table.storage(&Reading::id).zoneMap()->size(), rows.size());
+    EXPECT_EQ(table.storage(&Reading::id).zoneMap()->max(0), 99);
+    checkFilters(table, rows);
+    checkExtrema(table, rows);
+
+    // Writes through data() drop the zone map until it is built again
+    table.access(&Reading::id, 0) = 60;
+    rows[0].id = 60;
+    EXPECT_EQ(table.storage(&Reading::id).zoneMap(), nullptr);
+    checkFilters(table, rows);
+    table.storage(&Reading::id).buildZoneMap();
+    checkFilters(table, rows);
+    checkExtrema(table, rows);
+
+    // So do writes through the non-const operator[], row reads keep it
+    const Reading row = table[10];
+    EXPECT_EQ(row.value, rows[10].value);
+    ASSERT_NE(table.storage(&Reading::value).zoneMap(), nullptr);
+    table.storage(&Reading::value)[5000] = -2.0f;
+    rows[5000].value = -2.0f;
+    EXPECT_EQ(table.storage(&Reading::value).zoneMap(), nullptr);
+    EXPECT_EQ(table.where(&Reading::value, ext::CompareOp::Less, -1.5f).count(), 1);
+    EXPECT_EQ(table.min(&Reading::value), -2.0f);
+    table.storage(&Reading::value).buildZoneMap();
+    checkFilters(table, rows);
+    checkExtrema(table, rows);
+}
+
+struct Track
+{
+    REFLECT_INTERNAL_BEGIN(Track)
+        REFLECT_INTERNAL_MEMBER(int32_t, id)
+        REFLECT_INTERNAL_MEMBER(float, speed)
+    REFLECT_INTERNAL_END;
+};
+
+struct TrackedReading
+{
+    REFLECT_INTERNAL_BEGIN(TrackedReading)
+        REFLECT_INTERNAL_MEMBER(int32_t, id)
+        REFLECT_INTERNAL_MEMBER(float, value)
+        REFLECT_INTERNAL_MEMBER(float, speed)
+    REFLECT_INTERNAL_END;
+};
+
+template <class LEFT, class RIGHT>
+void checkJoin(const LEFT& left, const RIGHT& right, const std::vector<Reading>& readings,
+               const std::vector<Track>& tracks, ct::ext::JoinType type, size_t num_threads)
+{
+    // Tombstoned rows take no part in the join
+    std::multimap<int32_t, uint32_t> by_id;
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        if (!right.isTombstone(i))
+        {
+            by_id.emplace(tracks[i].id, static_cast<uint32_t>(i));
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (size_t i = 0; i < readings.size(); ++i)
+    {
+        if (left.isTombstone(i))
+        {
+            continue;
+        }
+        const auto matches = by_id.equal_range(readings[i].id);
+        if (matches.first == matches.second && type == ct::ext::JoinType::Left)
+        {
+            expected.emplace_back(static_cast<uint32_t>(i), ct::ext::JoinResult::NO_MATCH);
+        }
+        for (auto it = matches.first; it != matches.second; ++it)
+        {
+            expected.emplace_back(static_cast<uint32_t>(i), it->second);
+        }
+    }
+    const ct::ext::JoinResult result = left.join(&Reading::id, right, &Track::id, type, num_threads);
+    ASSERT_EQ(result.left.size(), result.right.size());
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        pairs.emplace_back(result.left[i], result.right[i]);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(pairs, expected);
+}
+
+TEST(datatable, join)
+{
+    std::mt19937 rng(23);
+    std::vector<Reading> readings;
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        readings.push_back(Reading{static_cast<int32_t>(rng() % 400), static_cast<float>(i), 0.0});
+    }
+    // Track ids 0, 2, 4, ... with every tenth id twice
+    std::vector<Track> tracks;
+    for (int32_t id = 0; id < 300; id += 2)
+    {
+        tracks.push_back(Track{id, static_cast<float>(id) * 0.5f});
+        if (id % 10 == 0)
+        {
+            tracks.push_back(Track{id, -1.0f});
+        }
+    }
+    ext::DataTable<Reading> left(readings);
+    ext::DataTable<Track> right(tracks);
+    for (size_t threads : {1, 3})
+    {
+        checkJoin(left, right, readings, tracks, ext::JoinType::Inner, threads);
+        checkJoin(left, right, readings, tracks, ext::JoinType::Left, threads);
+    }
+    // Pairs come out in left row order when the build side is small
+    const ext::JoinResult pairs = left.join(&Reading::id, right, &Track::id);
+    EXPECT_TRUE(std::is_sorted(pairs.left.begin(), pairs.left.end()));
+
+    ext::DataTable<TrackedReading> joined = left.join<TrackedReading>(
+        &Reading::id,
+        right,
+        &Track::id,
+        [](const Reading& reading, const Track* track) {
+            return TrackedReading{reading.id, reading.value, track ? track->speed : -2.0f};
+        },
+        ext::JoinType::Left);
+    ASSERT_EQ(joined.size(), left.join(&Reading::id, right, &Track::id, ext::JoinType::Left).size());
+    for (size_t i = 0; i < joined.size(); ++i)
+    {
+        const TrackedReading row = joined[i];
+        ASSERT_EQ(readings[static_cast<size_t>(row.value)].id, row.id);
+        if (row.id % 2 != 0 || row.id >= 300)
+        {
+            ASSERT_EQ(row.speed, -2.0f);
+        }
+        else if (row.speed != -1.0f)
+        {
+            ASSERT_EQ(row.speed, static_cast<float>(row.id) * 0.5f);
+        }
+    }
+
+    // A build side large enough to be radix partitioned, probed from a chunked table
+    for (int32_t id = 300; tracks.size() < 100000; ++id)
+    {
+        tracks.push_back(Track{id, 0.0f});
+    }
+    for (size_t i = 0; i < 50000; ++i)
+    {
+        readings.push_back(Reading{static_cast<int32_t>(rng() % 120000), 0.0f, 0.0});
+    }
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(readings);
+    ext::DataTable<Track> large(tracks);
+    checkJoin(chunked, large, readings, tracks, ext::JoinType::Inner, 1);
+    checkJoin(chunked, large, readings, tracks, ext::JoinType::Left, 4);
+
+    // Tombstoned rows on either side are skipped, a left row whose matches are all tombstoned is unmatched
+    for (size_t i = 0; i < readings.size(); i += 7)
+    {
+        chunked.tombstone(i);
+    }
+    for (size_t i = 0; i < 200; ++i)
+    {
+        large.tombstone(i);
+    }
+    checkJoin(chunked, large, readings, tracks, ext::JoinType::Inner, 1);
+    checkJoin(chunked, large, readings, tracks, ext::JoinType::Left, 4);
+}
+
+TEST(datatable, secondary_index)
+{
+    std::vector<Reading> rows;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        rows.push_back(Reading{i % 10, static_cast<float>(i), 0.0});
+    }
+    ext::DataTable<Reading> table(rows);
+    ext::HashIndex<int32_t> by_id;
+    ext::SortedIndex<float> by_value;
+    by_id.build(table.storage(&Reading::id));
+    by_value.build(table.storage(&Reading::value));
+    EXPECT_EQ(by_id.find(3), ext::SelectionVector({3, 13, 23, 33, 43, 53, 63, 73, 83, 93}));
+    EXPECT_TRUE(by_id.find(10).empty());
+    EXPECT_EQ(by_value.range(10.0f, 12.5f), ext::SelectionVector({10, 11, 12}));
+    EXPECT_EQ(table.sum(&Reading::value, by_id.find(3)), 480.0);
+
+    // Appended rows are picked up by sync
+    table.push_back(Reading{3, -5.0f, 0.0});
+    table.push_back(Reading{42, 7.5f, 0.0});
+    by_id.sync(table.storage(&Reading::id));
+    by_value.sync(table.storage(&Reading::value));
+    EXPECT_EQ(by_id.size(), 102);
+    EXPECT_EQ(by_id.find(3).back(), 100);
+    EXPECT_EQ(by_id.find(42), ext::SelectionVector({101}));
+    EXPECT_EQ(by_value.range(-10.0f, 0.0f), ext::SelectionVector({0, 100}));
+    EXPECT_EQ(by_value.range(7.0f, 7.5f), ext::SelectionVector({7, 101}));
+
+    // Assigned keys
+    table.access(&Reading::id, 13) = 42;
+    by_id.update(13, 42);
+    table.access(&Reading::value, 13) = 7.25f;
+    by_value.update(13, 7.25f);
+    EXPECT_EQ(by_id.find(42), ext::SelectionVector({13, 101}));
+    EXPECT_EQ(by_id.find(3).front(), 3);
+    EXPECT_EQ(by_id.find(3)[1], 23);
+    EXPECT_EQ(by_value.range(7.0f, 7.5f), ext::SelectionVector({7, 13, 101}));
+
+    // Erased rows shift the later row ids down
+    table.storage(&Reading::id).erase(0);
+    table.storage(&Reading::value).erase(0);
+    table.storage(&Reading::weight).erase(0);
+    by_id.erase(0);
+    by_value.erase(0);
+    EXPECT_EQ(by_id.find(42), ext::SelectionVector({12, 100}));
+    EXPECT_EQ(by_id.find(0).front(), 9);
+    EXPECT_EQ(by_value.range(-10.0f, 0.0f), ext::SelectionVector({99}));
+    EXPECT_EQ(by_value.find(7.25f), ext::SelectionVector({12}));
+    for (int32_t id = 0; id < 10; ++id)
+    {
+        for (uint32_t row : by_id.find(id))
+        {
+            EXPECT_EQ(table.access(&Reading::id, row), id);
+        }
+    }
+}
+
+TEST(datatable, declared_index)
+{
+    std::vector<Reading> rows;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        rows.push_back(Reading{i % 10, static_cast<float>(i), 0.0});
+    }
+    ext::DataTable<Reading> table(rows);
+    EXPECT_THROW(table.find(&Reading::id, 3), std::runtime_error);
+    table.createHashIndex(&Reading::id);
+    table.createSortedIndex(&Reading::value);
+    EXPECT_EQ(table.find(&Reading::id, 3), ext::SelectionVector({3, 13, 23, 33, 43, 53, 63, 73, 83, 93}));
+    EXPECT_EQ(table.range(&Reading::value, 10.0f, 12.5f), ext::SelectionVector({10, 11, 12}));
+    EXPECT_EQ(table.find(&Reading::value, 12.0f), ext::SelectionVector({12}));
+    EXPECT_THROW(table.range(&Reading::id, 0, 1), std::runtime_error);
+
+    // Every row operation of the table keeps the indexes current
+    table.push_back(Reading{42, -5.0f, 0.0});
+    const Reading more[] = {Reading{42, 7.5f, 0.0}, Reading{43, 1000.0f, 0.0}};
+    table.append(more, 2);
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({100, 101}));
+    EXPECT_EQ(table.range(&Reading::value, -10.0f, 0.0f), ext::SelectionVector({0, 100}));
+    table.assign(13, Reading{42, 7.25f, 0.0});
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({13, 100, 101}));
+    EXPECT_EQ(table.range(&Reading::value, 7.0f, 7.5f), ext::SelectionVector({7, 13, 101}));
+    table.erase(0);
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({12, 99, 100}));
+    EXPECT_EQ(table.range(&Reading::value, -10.0f, 0.0f), ext::SelectionVector({99}));
+    table.swapRemove(12);
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({99, 100}));
+    EXPECT_EQ(table.find(&Reading::id, 43), ext::SelectionVector({12}));
+    EXPECT_EQ(table.range(&Reading::value, 999.0f, 1000.0f), ext::SelectionVector({12}));
+    table.tombstone(99);
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({100}));
+    table.compact();
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({99}));
+    table.sortBy(&Reading::value);
+    EXPECT_EQ(table.find(&Reading::id, 42), ext::SelectionVector({7}));
+    EXPECT_EQ(table.range(&Reading::value, -1.0f, 2.5f), ext::SelectionVector({0, 1}));
+
+    // Copies get their own indexes, writes through access need reindex
+    ext::DataTable<Reading> copy = table;
+    copy.push_back(Reading{77, 0.5f, 0.0});
+    EXPECT_EQ(copy.find(&Reading::id, 77), ext::SelectionVector({static_cast<uint32_t>(copy.size() - 1)}));
+    EXPECT_TRUE(table.find(&Reading::id, 77).empty());
+    table.access(&Reading::id, 0) = 77;
+    table.reindex();
+    EXPECT_EQ(table.find(&Reading::id, 77), ext::SelectionVector({0}));
+    for (int32_t id = 0; id < 10; ++id)
+    {
+        for (uint32_t row : table.find(&Reading::id, id))
+        {
+            EXPECT_EQ(table.access(&Reading::id, row), id);
+        }
+    }
+    table.dropIndex(&Reading::id);
+    EXPECT_THROW(table.find(&Reading::id, 77), std::runtime_error);
+}
+
+TEST(datatable, sort)
+{
+    std::vector<Reading> rows;
+    std::mt19937 rng(31);
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        const float value = i % 97 == 0 ? NAN : static_cast<float>(rng() % 50) - 25.0f;
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 20) - 10, value, static_cast<double>(i)});
+    }
+    ext::DataTable<Reading> table(rows);
+    table.sortBy(&Reading::id, &Reading::value);
+    // The weight is the original row, ties keep their order
+    std::vector<Reading> expected = rows;
+    std::stable_sort(expected.begin(), expected.end(), [](const Reading& a, const Reading& b) {
+        if (a.id != b.id)
+        {
+            return a.id < b.id;
+        }
+        return !std::isnan(a.value) && (std::isnan(b.value) || a.value < b.value);
+    });
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_EQ(table.access(&Reading::weight, i), expected[i].weight);
+        ASSERT_EQ(table.access(&Reading::id, i), expected[i].id);
+    }
+    EXPECT_EQ(table.sortOrder(4, &Reading::weight), table.sortOrder(&Reading::weight));
+    // 32 + 64 key bits do not pack into one radix key and are sorted one key at a time
+    const std::vector<uint32_t> order = table.sortOrder(&Reading::value, &Reading::weight);
+    for (size_t i = 1; i < order.size(); ++i)
+    {
+        const Reading prev = table[order[i - 1]];
+        const Reading row = table[order[i]];
+        ASSERT_TRUE(prev.value < row.value || std::isnan(row.value) ||
+                    (prev.value == row.value && prev.weight < row.weight));
+    }
+
+    // Subarray columns move with their rows
+    std::vector<float> embeddings(40 * 4);
+    std::vector<DynStruct> dyn(40);
+    for (size_t i = 0; i < dyn.size(); ++i)
+    {
+        std::fill(embeddings.begin() + i * 4, embeddings.begin() + i * 4 + 4, static_cast<float>(i));
+        dyn[i] = DynStruct{static_cast<float>(i % 5), -static_cast<float>(i), 0.0f, 0.0f, {&embeddings[i * 4], 4}};
+    }
+    ext::DataTable<DynStruct> dyn_table(dyn);
+    dyn_table.sortBy(&DynStruct::x, &DynStruct::y);
+    for (size_t i = 0; i < dyn.size(); ++i)
+    {
+        const DynStruct row = dyn_table[i];
+        const float original = -row.y;
+        EXPECT_EQ(row.x, static_cast<float>(static_cast<size_t>(original) % 5));
+        EXPECT_EQ(row.embeddings[0], original);
+        EXPECT_EQ(row.embeddings[3], original);
+        if (i > 0 && dyn_table.access(&DynStruct::x, i - 1) == row.x)
+        {
+            EXPECT_LT(dyn_table.access(&DynStruct::y, i - 1), row.y);
+        }
+    }
+
+    // String keys are merge sorted, other string and bit columns are permuted through copyTo and append
+    ext::DataTable<Label> labels;
+    const char* classes[] = {"person", "car", "bicycle"};
+    for (int i = 0; i < 30; ++i)
+    {
+        labels.push_back(Label{i, std::string(1, char('a' + (29 - i) % 7)), classes[i % 3]});
+    }
+    labels.sortBy(&Label::cls, &Label::text);
+    for (size_t i = 0; i < labels.size(); ++i)
+    {
+        const Label row = labels[i];
+        EXPECT_EQ(row.cls, std::string(classes[row.id % 3]));
+        EXPECT_EQ(row.text, std::string(1, char('a' + (29 - row.id) % 7)));
+        if (i > 0)
+        {
+            const Label prev = labels[i - 1];
+            EXPECT_TRUE(prev.cls < row.cls || (prev.cls == row.cls && prev.text <= row.text));
+        }
+    }
+    ext::DataTable<Entity> entities;
+    for (int i = 0; i < 100; ++i)
+    {
+        entities.push_back(Entity{static_cast<float>(99 - i), i % 2 == 0, i % 3 == 0});
+    }
+    entities.sortBy(&Entity::x);
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        EXPECT_EQ(entities.access(&Entity::x, i), static_cast<float>(i));
+        EXPECT_EQ(entities.access(&Entity::active, i), (99 - i) % 2 == 0);
+        EXPECT_EQ(entities.access(&Entity::visible, i), (99 - i) % 3 == 0);
+    }
+}
+
+template <class T>
+std::vector<uint32_t> referenceTopN(const std::vector<T>& values, size_t n, ext::SortOrder order,
+                                    const ext::SelectionVector& rows)
+{
+    std::vector<uint32_t> out;
+    for (uint32_t row : rows)
+    {
+        if (values[row] == values[row])
+        {
+            out.push_back(row);
+        }
+    }
+    std::stable_sort(out.begin(), out.end(), [&](uint32_t a, uint32_t b) {
+        return order == ext::SortOrder::Ascending ? values[a] < values[b] : values[a] > values[b];
+    });
+    out.resize(std::min(n, out.size()));
+    return out;
+}
+
+TEST(datatable, top_n)
+{
+    const size_t num_rows = 50000;
+    std::vector<Reading> rows;
+    std::vector<float> values;
+    std::vector<int32_t> ids;
+    ext::SelectionVector all(num_rows);
+    std::mt19937 rng(41);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        // Coarse values so that ties cross the threshold
+        const float value = i % 101 == 0 ? NAN : static_cast<float>(rng() % 2000) * 0.5f;
+        rows.push_back(Reading{static_cast<int32_t>(rng() % 300), value, 0.0});
+        values.push_back(value);
+        ids.push_back(rows.back().id);
+        all[i] = static_cast<uint32_t>(i);
+    }
+    ext::DataTable<Reading> table(rows);
+    ext::SelectionVector odd;
+    for (uint32_t row = 1; row < num_rows; row += 2)
+    {
+        odd.push_back(row);
+    }
+    for (bool zones : {false, true})
+    {
+        if (zones)
+        {
+            table.storage(&Reading::value).buildZoneMap();
+        }
+        for (size_t n : {1, 10, 100, 5000, 60000})
+        {
+            for (ext::SortOrder order : {ext::SortOrder::Descending, ext::SortOrder::Ascending})
+            {
+                const std::vector<uint32_t> expected = referenceTopN(values, n, order, all);
+                EXPECT_EQ(table.topN(&Reading::value, n, order), expected);
+                EXPECT_EQ(table.topN(&Reading::value, n, order, ext::RowSelection(), 3), expected);
+                EXPECT_EQ(table.topN(&Reading::value, n, order, odd), referenceTopN(values, n, order, odd));
+                EXPECT_EQ(table.topN(&Reading::id, n, order, ext::RowSelection(), 2), referenceTopN(ids, n, order, all));
+            }
+        }
+    }
+    EXPECT_TRUE(table.topN(&Reading::value, 0).empty());
+
+    // The key column picks the rows, the other columns are only read for the rows returned
+    const std::vector<uint32_t> best = table.topN(&Reading::value, 3);
+    for (uint32_t row : best)
+    {
+        const Reading reading = table[row];
+        EXPECT_EQ(reading.value, 999.5f);
+        EXPECT_EQ(reading.id, rows[row].id);
+    }
+}
+
+TEST(datatable, gather_scatter)
+{
+    std::vector<Reading> rows;
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        rows.push_back(Reading{i, static_cast<float>(i % 37), i * 0.5});
+    }
+    ext::DataTable<Reading> table(rows);
+    table.storage(&Reading::value).buildZoneMap();
+    const std::vector<uint32_t> idx = {999, 3, 3, 500, 0, 1, 2, 998};
+    std::vector<Reading> out(idx.size());
+    table.gather(idx.data(), idx.size(), out.data());
+    for (size_t i = 0; i < idx.size(); ++i)
+    {
+        EXPECT_EQ(out[i].id, rows[idx[i]].id);
+        EXPECT_EQ(out[i].value, rows[idx[i]].value);
+        EXPECT_EQ(out[i].weight, rows[idx[i]].weight);
+    }
+
+    // A selection materialized as a new table
+    const ext::SelectionVector selected =
+        ext::toSelection(table.where(&Reading::value, ext::CompareOp::Equal, 5.0f));
+    ext::DataTable<Reading> subset = table.gather(selected);
+    ASSERT_EQ(subset.size(), selected.size());
+    for (size_t i = 0; i < subset.size(); ++i)
+    {
+        EXPECT_EQ(subset.access(&Reading::id, i), static_cast<int32_t>(selected[i]));
+        EXPECT_EQ(subset.access(&Reading::value, i), 5.0f);
+    }
+    EXPECT_EQ(table.gather(nullptr, 0).size(), 0);
+
+    // Updates keep the zone map current
+    for (Reading& row : out)
+    {
+        row.value = 100.0f + static_cast<float>(row.id);
+    }
+    table.scatter(idx.data(), idx.size(), out.data());
+    ASSERT_NE(table.storage(&Reading::value).zoneMap(), nullptr);
+    EXPECT_EQ(table.max(&Reading::value), 1099.0f);
+    EXPECT_EQ(table.access(&Reading::value, 500), 600.0f);
+    EXPECT_EQ(table.access(&Reading::value, 4), 4.0f);
+
+    // Array columns are copied into the new table
+    std::vector<float> embeddings(10 * 3);
+    std::vector<DynStruct> dyn(10);
+    for (size_t i = 0; i < dyn.size(); ++i)
+    {
+        std::fill(embeddings.begin() + i * 3, embeddings.begin() + i * 3 + 3, static_cast<float>(i));
+        dyn[i] = DynStruct{static_cast<float>(i), 0.0f, 0.0f, 0.0f, {&embeddings[i * 3], 3}};
+    }
+    ext::DataTable<DynStruct> dyn_table(dyn);
+    const std::vector<uint32_t> odd = {1, 3, 5, 7, 9};
+    ext::DataTable<DynStruct> dyn_subset = dyn_table.gather(odd);
+    ASSERT_EQ(dyn_subset.size(), odd.size());
+    for (size_t i = 0; i < odd.size(); ++i)
+    {
+        const DynStruct row = dyn_subset[i];
+        EXPECT_EQ(row.x, static_cast<float>(odd[i]));
+        ASSERT_EQ(row.embeddings.size(), 3);
+        EXPECT_EQ(row.embeddings[2], static_cast<float>(odd[i]));
+        EXPECT_NE(row.embeddings.data(), dyn_table.access(&DynStruct::embeddings, odd[i]).data());
+    }
+    std::vector<float> replacement(3, -1.0f);
+    DynStruct update{-1.0f, 0.0f, 0.0f, 0.0f, {replacement.data(), 3}};
+    dyn_table.scatter(&odd[2], 1, &update);
+    EXPECT_EQ(dyn_table.access(&DynStruct::x, 5), -1.0f);
+    EXPECT_EQ(dyn_table.access(&DynStruct::embeddings, 5)[1], -1.0f);
+
+    // Storages without gather members go through copyTo, append and assign
+    ext::DataTable<Entity> entities;
+    for (int i = 0; i < 100; ++i)
+    {
+        entities.push_back(Entity{static_cast<float>(i), i % 2 == 0, i % 3 == 0});
+    }
+    const std::vector<uint32_t> entity_rows = {10, 11, 12, 13, 50, 99};
+    ext::DataTable<Entity> entity_subset = entities.gather(entity_rows);
+    for (size_t i = 0; i < entity_rows.size(); ++i)
+    {
+        EXPECT_EQ(entity_subset.access(&Entity::active, i), entity_rows[i] % 2 == 0);
+        EXPECT_EQ(entity_subset.access(&Entity::visible, i), entity_rows[i] % 3 == 0);
+    }
+    const Entity flipped[2] = {Entity{-1.0f, false, false}, Entity{-2.0f, true, true}};
+    const uint32_t flipped_rows[2] = {0, 1};
+    entities.scatter(flipped_rows, 2, flipped);
+    EXPECT_FALSE(entities.access(&Entity::active, 0));
+    EXPECT_TRUE(entities.access(&Entity::visible, 1));
+    ext::DataTable<Label> labels;
+    for (int i = 0; i < 20; ++i)
+    {
+        labels.push_back(Label{i, std::string(size_t(i), 'x'), i % 2 == 0 ? "even" : "odd"});
+    }
+    ext::DataTable<Label> label_subset = labels.gather(std::vector<uint32_t>{19, 4, 5});
+    const Label last = label_subset[0];
+    EXPECT_EQ(last.text, std::string(19, 'x'));
+    EXPECT_EQ(last.cls, std::string("odd"));
+    EXPECT_EQ(label_subset.access(&Label::id, 2), 5);
+
+    // Strings of a different length move the later strings
+    const Label relabeled[2] = {Label{-1, std::string(30, 'y'), "odd"}, Label{-2, std::string(), "even"}};
+    const uint32_t relabeled_rows[2] = {3, 10};
+    labels.scatter(relabeled_rows, 2, relabeled);
+    EXPECT_EQ(labels.storage(&Label::text).strings().numBytes(), 190 - 3 - 10 + 30);
+    for (int i = 0; i < 20; ++i)
+    {
+        const Label row = labels[static_cast<size_t>(i)];
+        const size_t expected = i == 3 ? 30 : i == 10 ? 0 : static_cast<size_t>(i);
+        EXPECT_EQ(row.text, std::string(expected, i == 3 ? 'y' : 'x'));
+        EXPECT_EQ(row.cls, std::string(i == 3 || i % 2 == 1 ? "odd" : "even"));
+    }
+
+    // Ragged rows of a different length
+    std::vector<float> points(20);
+    std::iota(points.begin(), points.end(), 0.0f);
+    ext::DataTable<Keypoints> keypoints;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        keypoints.push_back(Keypoints{float(i), {points.data() + i, 3}});
+    }
+    const Keypoints moved[2] = {Keypoints{-1.0f, {points.data() + 10, 6}}, Keypoints{-2.0f, {points.data(), 1}}};
+    const uint32_t moved_rows[2] = {1, 3};
+    keypoints.scatter(moved_rows, 2, moved);
+    EXPECT_EQ(keypoints.storage(&Keypoints::points).numValues(), 3 * 3 + 6 + 1);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 1).size(), 6);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 1)[5], 15.0f);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 3).size(), 1);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 3)[0], 0.0f);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 4)[2], 6.0f);
+    EXPECT_EQ(keypoints.access(&Keypoints::score, 3), -2.0f);
+
+    // Chunked rows are overwritten in place
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(rows);
+    const float* before = &chunked.access(&Reading::value, 500);
+    chunked.scatter(idx.data(), idx.size(), out.data());
+    EXPECT_EQ(&chunked.access(&Reading::value, 500), before);
+    EXPECT_EQ(chunked.access(&Reading::value, 500), 600.0f);
+    EXPECT_EQ(chunked.access(&Reading::value, 999), 1099.0f);
+    EXPECT_EQ(chunked.access(&Reading::value, 4), 4.0f);
+    chunked.assign(4, Reading{4, -4.0f, 0.0});
+    EXPECT_EQ(chunked.access(&Reading::value, 4), -4.0f);
+}
+
+TEST(datatable, row_removal)
+{
+    std::vector<Reading> rows;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        rows.push_back(Reading{i, static_cast<float>(i), 0.0});
+    }
+    ext::DataTable<Reading> table(rows);
+    table.storage(&Reading::value).buildZoneMap();
+    // Rows are read by value, access hands out a mutable reference and drops the zone map
+    table.swapRemove(10);
+    ASSERT_EQ(table.size(), 99);
+    EXPECT_EQ(table[10].id, 99);
+    EXPECT_EQ(table[10].value, 99.0f);
+    table.swapRemove(98);
+    ASSERT_EQ(table.size(), 98);
+    ASSERT_NE(table.storage(&Reading::value).zoneMap(), nullptr);
+    EXPECT_EQ(table.max(&Reading::value), 99.0f);
+    EXPECT_EQ(table.sum(&Reading::id), 99 * 100 / 2 - 10 - 98);
+
+    // Array columns move whole rows, bit columns go through copyTo, assign and erase
+    std::vector<float> embeddings(4 * 2);
+    std::vector<DynStruct> dyn(4);
+    for (size_t i = 0; i < dyn.size(); ++i)
+    {
+        embeddings[i * 2] = embeddings[i * 2 + 1] = static_cast<float>(i);
+        dyn[i] = DynStruct{static_cast<float>(i), 0.0f, 0.0f, 0.0f, {&embeddings[i * 2], 2}};
+    }
+    ext::DataTable<DynStruct> dyn_table(dyn);
+    dyn_table.swapRemove(0);
+    ASSERT_EQ(dyn_table.size(), 3);
+    EXPECT_EQ(dyn_table.access(&DynStruct::x, 0), 3.0f);
+    EXPECT_EQ(dyn_table.access(&DynStruct::embeddings, 0)[1], 3.0f);
+    ext::DataTable<Entity> entities;
+    for (int i = 0; i < 5; ++i)
+    {
+        entities.push_back(Entity{static_cast<float>(i), i == 4, i % 2 == 0});
+    }
+    entities.swapRemove(1);
+    EXPECT_EQ(entities.access(&Entity::x, 1), 4.0f);
+    EXPECT_TRUE(entities.access(&Entity::active, 1));
+    EXPECT_TRUE(entities.access(&Entity::visible, 1));
+    EXPECT_EQ(entities.size(), 4);
+
+    // Chunked pages move the last row, ragged and string columns shift the later values
+    ext::DataTable<Reading, ext::ChunkedStoragePolicy> chunked(rows);
+    chunked.swapRemove(10);
+    ASSERT_EQ(chunked.size(), 99);
+    EXPECT_EQ(chunked.access(&Reading::id, 10), 99);
+    EXPECT_EQ(chunked.access(&Reading::value, 10), 99.0f);
+    chunked.swapRemove(98);
+    ASSERT_EQ(chunked.size(), 98);
+    EXPECT_EQ(chunked.sum(&Reading::id), 99 * 100 / 2 - 10 - 98);
+    std::vector<float> points(10);
+    std::iota(points.begin(), points.end(), 0.0f);
+    ext::DataTable<Keypoints> keypoints;
+    ext::DataTable<Label> labels;
+    for (int i = 0; i < 4; ++i)
+    {
+        keypoints.push_back(Keypoints{float(i), {points.data(), size_t(i + 1)}});
+        labels.push_back(Label{i, std::string(size_t(i), 'x'), i % 2 == 0 ? "even" : "odd"});
+    }
+    keypoints.swapRemove(0);
+    labels.swapRemove(0);
+    ASSERT_EQ(keypoints.size(), 3);
+    EXPECT_EQ(keypoints.access(&Keypoints::score, 0), 3.0f);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 0).size(), 4);
+    EXPECT_EQ(keypoints.access(&Keypoints::points, 2).size(), 3);
+    EXPECT_EQ(keypoints.storage(&Keypoints::points).numValues(), 4 + 2 + 3);
+    ASSERT_EQ(labels.size(), 3);
+    const Label moved = labels[0];
+    EXPECT_EQ(moved.id, 3);
+    EXPECT_EQ(moved.text, std::string(3, 'x'));
+    EXPECT_EQ(moved.cls, std::string("odd"));
+    EXPECT_EQ(labels[2].text, std::string(2, 'x'));
+
+    // Tombstones are skipped by scans until compact reclaims them
+    ext::DataTable<Reading> churn(rows);
+    churn.storage(&Reading::value).buildZoneMap();
+    int64_t live_sum = 0;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        if (i % 3 == 0)
+        {
+            churn.tombstone(static_cast<size_t>(i));
+        }
+        else
+        {
+            live_sum += i;
+        }
+    }
+    churn.tombstone(3);
+    EXPECT_EQ(churn.numTombstones(), 34);
+    EXPECT_TRUE(churn.isTombstone(99));
+    EXPECT_FALSE(churn.isTombstone(98));
+    EXPECT_EQ(churn.size(), 100);
+    EXPECT_EQ(churn.sum(&Reading::id), live_sum);
+    EXPECT_EQ(churn.max(&Reading::value), 98.0f);
+    EXPECT_EQ(churn.where(&Reading::value, ext::CompareOp::Less, 4.0f).count(), 2);
+    const ext::SelectionVector first_ten = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(churn.sum(&Reading::id, first_ten), 1 + 2 + 4 + 5 + 7 + 8);
+    EXPECT_EQ(churn.topN(&Reading::value, 2), std::vector<uint32_t>({98, 97}));
+    EXPECT_EQ(churn.liveRows().count(), 66);
+
+    // Rows appended later have no tombstone, swapRemove carries the last row's tombstone
+    churn.push_back(Reading{100, 100.0f, 0.0});
+    EXPECT_FALSE(churn.isTombstone(100));
+    churn.swapRemove(1);
+    EXPECT_EQ(churn[1].id, 100);
+    EXPECT_FALSE(churn.isTombstone(1));
+    churn.swapRemove(0);
+    EXPECT_EQ(churn[0].id, 99);
+    EXPECT_TRUE(churn.isTombstone(0));
+    EXPECT_EQ(churn.numTombstones(), 33);
+
+    // The table is only touched by the compacting thread meanwhile
+    std::thread compaction([&churn]() { churn.compact(); });
+    compaction.join();
+    EXPECT_EQ(churn.numTombstones(), 0);
+    ASSERT_EQ(churn.size(), 66);
+    EXPECT_EQ(churn[0].id, 100);
+    EXPECT_EQ(churn[1].id, 2);
+    for (size_t i = 2; i < churn.size(); ++i)
+    {
+        EXPECT_NE(churn[i].id % 3, 0);
+        EXPECT_GT(churn[i].id, churn[i - 1].id);
+    }
+    ASSERT_NE(churn.storage(&Reading::value).zoneMap(), nullptr);
+    EXPECT_EQ(churn.max(&Reading::value), 100.0f);
+    EXPECT_EQ(churn.min(&Reading::value), 2.0f);
+}
+
+TEST(DataTablePerformance, filter)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(11);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(rng() % 1000), static_cast<float>(rng() % 1000) / 1000.0f, 0.0};
+    }
+    ext::DataTable<Reading> table(rows);
+    double float_time = 0;
+    double int_time = 0;
+    double row_time = 0;
+    size_t vectorized = 0;
+    {
+        TimeIt timer(float_time);
+        vectorized = table.where(&Reading::value, ext::CompareOp::Less, 0.25f).count();
+    }
+    {
+        TimeIt timer(int_time);
+        table.where(&Reading::id, ext::CompareOp::GreaterEqual, 750).count();
+    }
+    ext::BitVector bits(num_rows);
+    {
+        TimeIt timer(row_time);
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            bits.set(i, table.access(&Reading::value, i) < 0.25f);
+        }
+    }
+    EXPECT_EQ(bits.count(), vectorized);
+    std::cout << "filter float " << float_time << " ms, int32 " << int_time << " ms, row by row " << row_time
+              << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, aggregate)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(13);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(rng() % 1000), static_cast<float>(rng() % 1000) / 1000.0f, 0.0};
+    }
+    ext::DataTable<Reading> table(rows);
+    double loop_sum = 0;
+    double loop_time = 0;
+    {
+        TimeIt timer(loop_time);
+        for (const float* it = table.begin(&Reading::value); it != table.end(&Reading::value); ++it)
+        {
+            loop_sum += *it;
+        }
+    }
+    double sum = 0;
+    double sum_time = 0;
+    {
+        TimeIt timer(sum_time);
+        sum = table.sum(&Reading::value);
+    }
+    double threaded_time = 0;
+    {
+        TimeIt timer(threaded_time);
+        table.sum(&Reading::value, {}, 4);
+    }
+    double min_time = 0;
+    {
+        TimeIt timer(min_time);
+        table.argmin(&Reading::value);
+    }
+    EXPECT_NEAR(sum, loop_sum, 1e-3);
+    std::cout << "sum loop " << loop_time << " ms, sum " << sum_time << " ms, 4 threads " << threaded_time
+              << " ms, argmin " << min_time << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, group_by)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(19);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(rng() % 1000000), static_cast<float>(rng() % 1000) / 1000.0f, 1.0};
+    }
+    ext::DataTable<Reading> table(rows);
+    double map_time = 0;
+    size_t map_groups = 0;
+    {
+        TimeIt timer(map_time);
+        std::unordered_map<int32_t, std::pair<double, uint64_t>> groups;
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            auto& group = groups[table.access(&Reading::id, i)];
+            group.first += table.access(&Reading::value, i);
+            ++group.second;
+        }
+        map_groups = groups.size();
+    }
+    for (size_t threads : {1, 4})
+    {
+        double time = 0;
+        size_t num_groups = 0;
+        {
+            TimeIt timer(time);
+            num_groups = table.groupBy(&Reading::id, threads)
+                             .aggregate<ReadingStats>(ext::agg::sum(&Reading::value),
+                                                      ext::agg::count(),
+                                                      ext::agg::mean(&Reading::weight),
+                                                      ext::agg::min(&Reading::value),
+                                                      ext::agg::max(&Reading::value))
+                             .size();
+        }
+        EXPECT_EQ(num_groups, map_groups);
+        std::cout << "group by " << threads << " threads " << time << " ms, unordered_map " << map_time << " ms"
+                  << std::endl;
+    }
+}
+
+TEST(DataTablePerformance, zone_map)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(37);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(i / 64), static_cast<float>(rng() % 1000) / 1000.0f, 0.0};
+    }
+    ext::DataTable<Reading> plain(rows);
+    ext::DataTable<Reading> zoned(rows);
+    double build_time = 0;
+    {
+        TimeIt timer(build_time);
+        zoned.storage(&Reading::id).buildZoneMap();
+        zoned.storage(&Reading::value).buildZoneMap();
+    }
+    // A window of 1% of an append ordered column
+    const int32_t lo = static_cast<int32_t>(num_rows / 64 / 2);
+    const int32_t hi = lo + static_cast<int32_t>(num_rows / 64 / 100);
+    double scan_time = 0;
+    double zoned_time = 0;
+    size_t scanned = 0;
+    size_t skipped = 0;
+    {
+        TimeIt timer(scan_time);
+        scanned = plain.whereBetween(&Reading::id, lo, hi).count();
+    }
+    {
+        TimeIt timer(zoned_time);
+        skipped = zoned.whereBetween(&Reading::id, lo, hi).count();
+    }
+    EXPECT_EQ(scanned, skipped);
+    double min_time = 0;
+    double zoned_min_time = 0;
+    size_t row = 0;
+    {
+        TimeIt timer(min_time);
+        row = plain.argmin(&Reading::value);
+    }
+    {
+        TimeIt timer(zoned_min_time);
+        EXPECT_EQ(zoned.argmin(&Reading::value), row);
+    }
+    std::cout << "zone map build " << build_time << " ms, window scan " << scan_time << " ms, zoned "
+              << zoned_time << " ms, argmin " << min_time << " ms, zoned " << zoned_min_time << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, join)
+{
+    const size_t num_rows = 1 << 22;
+    const int32_t num_tracks = 1 << 20;
+    std::vector<Reading> readings(num_rows);
+    std::mt19937 rng(29);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        readings[i] = Reading{static_cast<int32_t>(rng() % (2 * num_tracks)), 0.0f, 0.0};
+    }
+    std::vector<Track> tracks(num_tracks);
+    for (int32_t i = 0; i < num_tracks; ++i)
+    {
+        tracks[i] = Track{i * 2, 0.0f};
+    }
+    ext::DataTable<Reading> left(readings);
+    ext::DataTable<Track> right(tracks);
+    double map_time = 0;
+    size_t map_matches = 0;
+    {
+        TimeIt timer(map_time);
+        std::unordered_multimap<int32_t, uint32_t> build;
+        for (int32_t i = 0; i < num_tracks; ++i)
+        {
+            build.emplace(right.access(&Track::id, i), static_cast<uint32_t>(i));
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            const auto matches = build.equal_range(left.access(&Reading::id, i));
+            for (auto it = matches.first; it != matches.second; ++it)
+            {
+                pairs.emplace_back(static_cast<uint32_t>(i), it->second);
+            }
+        }
+        map_matches = pairs.size();
+    }
+    for (size_t threads : {1, 4})
+    {
+        double time = 0;
+        size_t matches = 0;
+        {
+            TimeIt timer(time);
+            matches = left.join(&Reading::id, right, &Track::id, ext::JoinType::Inner, threads).size();
+        }
+        EXPECT_EQ(matches, map_matches);
+        std::cout << "join " << threads << " threads " << time << " ms, unordered_multimap " << map_time << " ms"
+                  << std::endl;
+    }
+}
+
+TEST(DataTablePerformance, sort)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(37);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(rng() % 1000), static_cast<float>(rng() % 100000), 0.0};
+    }
+    double rows_time = 0;
+    std::vector<Reading> sorted = rows;
+    {
+        TimeIt timer(rows_time);
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Reading& a, const Reading& b) {
+            return a.id < b.id || (a.id == b.id && a.value < b.value);
+        });
+    }
+    ext::DataTable<Reading> table(rows);
+    double time = 0;
+    {
+        TimeIt timer(time);
+        table.sortBy(&Reading::id, &Reading::value);
+    }
+    for (size_t i = 0; i < num_rows; i += 997)
+    {
+        ASSERT_EQ(table.access(&Reading::id, i), sorted[i].id);
+        ASSERT_EQ(table.access(&Reading::value, i), sorted[i].value);
+    }
+    std::cout << "sortBy " << time << " ms, std::stable_sort of rows " << rows_time << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, top_n)
+{
+    const size_t num_rows = 1 << 23;
+    std::vector<Reading> rows(num_rows);
+    std::mt19937 rng(43);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(i), dist(rng), 0.0};
+    }
+    ext::DataTable<Reading> table(rows);
+    double sort_time = 0;
+    std::vector<Reading> sorted;
+    {
+        TimeIt timer(sort_time);
+        sorted = rows;
+        std::partial_sort(sorted.begin(), sorted.begin() + 100, sorted.end(), [](const Reading& a, const Reading& b) {
+            return a.value > b.value || (a.value == b.value && a.id < b.id);
+        });
+    }
+    double time = 0;
+    std::vector<uint32_t> best;
+    {
+        TimeIt timer(time);
+        best = table.topN(&Reading::value, 100);
+    }
+    ASSERT_EQ(best.size(), 100);
+    for (size_t i = 0; i < best.size(); ++i)
+    {
+        EXPECT_EQ(static_cast<int32_t>(best[i]), sorted[i].id);
+    }
+    std::cout << "topN 100 of " << num_rows << " rows " << time << " ms, partial_sort of row copies " << sort_time
+              << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, gather)
+{
+    const size_t num_rows = 1 << 22;
+    std::vector<Reading> rows(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(i), static_cast<float>(i), static_cast<double>(i)};
+    }
+    ext::DataTable<Reading> table(rows);
+    std::vector<uint32_t> idx(num_rows / 4);
+    std::mt19937 rng(47);
+    for (uint32_t& row : idx)
+    {
+        row = static_cast<uint32_t>(rng() % num_rows);
+    }
+    std::vector<Reading> out(idx.size());
+    double access_time = 0;
+    {
+        TimeIt timer(access_time);
+        for (size_t i = 0; i < idx.size(); ++i)
+        {
+            out[i] = table.access(idx[i]);
+        }
+    }
+    double gather_time = 0;
+    {
+        TimeIt timer(gather_time);
+        table.gather(idx.data(), idx.size(), out.data());
+    }
+    double table_time = 0;
+    size_t table_rows = 0;
+    {
+        TimeIt timer(table_time);
+        table_rows = table.gather(idx).size();
+    }
+    EXPECT_EQ(table_rows, idx.size());
+    EXPECT_EQ(out.back().id, static_cast<int32_t>(idx.back()));
+    std::cout << "gather " << idx.size() << " rows " << gather_time << " ms, into a table " << table_time
+              << " ms, access per row " << access_time << " ms" << std::endl;
+}
+
+TEST(DataTablePerformance, row_removal)
+{
+    const size_t num_rows = 1 << 18;
+    const size_t num_removed = 2000;
+    std::vector<Reading> rows(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        rows[i] = Reading{static_cast<int32_t>(i), static_cast<float>(i), 0.0};
+    }
+    std::vector<uint32_t> victims(num_removed);
+    std::mt19937 rng(53);
+    for (size_t i = 0; i < num_removed; ++i)
+    {
+        victims[i] = static_cast<uint32_t>(rng() % (num_rows - num_removed));
+    }
+    double erase_time = 0;
+    {
+        ext::DataTable<Reading> table(rows);
+        TimeIt timer(erase_time);
+        for (uint32_t row : victims)
+        {
+            table.storage(&Reading::id).erase(row);
+            table.storage(&Reading::value).erase(row);
+            table.storage(&Reading::weight).erase(row);
+        }
+    }
+    double swap_time = 0;
+    {
+        ext::DataTable<Reading> table(rows);
+        TimeIt timer(swap_time);
+        for (uint32_t row : victims)
+        {
+            table.swapRemove(row);
+        }
+        EXPECT_EQ(table.size(), num_rows - num_removed);
+    }
+    double tombstone_time = 0;
+    {
+        ext::DataTable<Reading> table(rows);
+        TimeIt timer(tombstone_time);
+        for (uint32_t row : victims)
+        {
+            table.tombstone(row);
+        }
+        table.compact();
+    }
+    std::cout << "remove " << num_removed << " of " << num_rows << " rows: erase " << erase_time << " ms, swapRemove "
+              << swap_time << " ms, tombstone and compact " << tombstone_time << " ms" << std::endl;
+}
+
 struct Position : ct::ext::Component
 {
     REFLECT_INTERNAL_BEGIN(Position)